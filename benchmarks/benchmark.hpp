@@ -0,0 +1,79 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+
+namespace cimod_benchmark {
+
+  /**
+   * @brief keep a checksum of a benchmarked computation alive
+   */
+  inline void do_not_optimize( double value ) {
+#if defined( _MSC_VER )
+    static volatile double sink;
+    sink = value;
+    static_cast<void>( sink );
+#else
+    asm volatile( "" : : "g"( value ) : "memory" );
+#endif
+  }
+
+  /**
+   * @brief the best wall time of repeat runs of f in milliseconds
+   */
+  template<typename F>
+  inline double measure( F &&f, int repeat = 5 ) {
+    double best = std::numeric_limits<double>::max();
+    for ( int r = 0; r < repeat; r++ ) {
+      const auto start = std::chrono::steady_clock::now();
+      f();
+      const auto stop = std::chrono::steady_clock::now();
+      best = std::min( best, std::chrono::duration<double, std::milli>( stop - start ).count() );
+    }
+    return best;
+  }
+
+  inline void print_header( const char *title ) {
+    std::printf( "\n# %s\n%-28s %12s %12s %8s\n", title, "case", "baseline[ms]", "target[ms]", "speedup" );
+  }
+
+  inline void print_time( const std::string &name, double time ) {
+    std::printf( "%-28s %12.3f\n", name.c_str(), time );
+  }
+
+  inline void print_row( const std::string &name, double baseline, double target ) {
+    std::printf( "%-28s %12.3f %12.3f %7.2fx\n", name.c_str(), baseline, target, baseline / target );
+  }
+
+  /**
+   * @brief xorshift64 generator, so that every run uses the same inputs
+   */
+  struct XorShift {
+    uint64_t state = 88172645463325252ULL;
+
+    uint64_t operator()() {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      return state;
+    }
+  };
+} // namespace cimod_benchmark
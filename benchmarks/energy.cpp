@@ -0,0 +1,182 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+// Energy, energies and add_interaction of the Dict BQM: the former per-term validation and lookups (baseline)
+// vs the validated-once single-lookup paths (target).
+//
+// usage: cimod_bench_energy [num_variables] [degree] [num_samples]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "cimod/binary_quadratic_model_dict.hpp"
+
+using namespace cimod_benchmark;
+using namespace cimod;
+
+using DictBQM = BinaryQuadraticModel<int64_t, double, Dict>;
+
+// energy as computed before: the vartype check and the lookup of the sample are repeated for every term
+double legacy_energy( const DictBQM &bqm, const Sample<int64_t> &sample ) {
+  double en = bqm.get_offset();
+  for ( const auto &it : bqm.get_linear() ) {
+    if ( check_vartype( sample.at( it.first ), bqm.get_vartype() ) ) {
+      en += static_cast<double>( sample.at( it.first ) ) * it.second;
+    }
+  }
+  for ( const auto &it : bqm.get_quadratic() ) {
+    if ( check_vartype( sample.at( it.first.first ), bqm.get_vartype() )
+         && check_vartype( sample.at( it.first.second ), bqm.get_vartype() ) ) {
+      en += static_cast<double>( sample.at( it.first.first ) ) * static_cast<double>( sample.at( it.first.second ) )
+            * it.second;
+    }
+  }
+  return en;
+}
+
+// add_interaction as computed before: count, operator[] and a count-then-insert for the variables and the interaction
+void legacy_add_interaction(
+    Linear<int64_t, double> &linear,
+    Quadratic<int64_t, double> &quadratic,
+    int64_t u,
+    int64_t v,
+    double bias ) {
+  for ( const int64_t w : { u, v } ) {
+    if ( linear.count( w ) == 0 ) {
+      double value = 0;
+      if ( linear.count( w ) != 0 ) {
+        value = linear[ w ];
+      }
+      if ( linear.count( w ) == 0 ) {
+        linear.insert( { { w, value } } );
+      } else {
+        linear[ w ] = value;
+      }
+    }
+  }
+  const std::pair<int64_t, int64_t> p = std::make_pair( std::min( u, v ), std::max( u, v ) );
+  double value = 0;
+  if ( quadratic.count( p ) != 0 ) {
+    value = quadratic[ p ];
+  }
+  if ( quadratic.count( p ) == 0 ) {
+    quadratic.insert( { { p, value + bias } } );
+  } else {
+    quadratic[ p ] = value + bias;
+  }
+}
+
+int main( int argc, char **argv ) {
+  const int64_t num_variables = argc > 1 ? std::strtol( argv[ 1 ], nullptr, 10 ) : 100000;
+  const int64_t degree = argc > 2 ? std::strtol( argv[ 2 ], nullptr, 10 ) : 10;
+  const int64_t num_samples = argc > 3 ? std::strtol( argv[ 3 ], nullptr, 10 ) : 20;
+  XorShift rng;
+
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for ( int64_t i = 0; i < num_variables; i++ ) {
+    for ( int64_t d = 0; d < degree / 2; d++ ) {
+      const int64_t j = static_cast<int64_t>( rng() % num_variables );
+      if ( i != j ) {
+        edges.emplace_back( i, j );
+      }
+    }
+  }
+  Sample<int64_t> sample;
+  for ( int64_t i = 0; i < num_variables; i++ ) {
+    sample[ i ] = rng() % 2 == 0 ? -1 : 1;
+  }
+
+  print_header( "Dict BQM energy x10 (baseline: per-term check and lookups)" );
+  DictBQM bqm( Linear<int64_t, double>(), Quadratic<int64_t, double>(), 0.0, Vartype::SPIN );
+  for ( const auto &e : edges ) {
+    bqm.add_interaction( e.first, e.second, 1.0 );
+  }
+  const double baseline = measure( [ & ]() {
+    double sum = 0;
+    for ( int r = 0; r < 10; r++ ) {
+      sum += legacy_energy( bqm, sample );
+    }
+    do_not_optimize( sum );
+  } );
+  print_row( "validate", baseline, measure( [ & ]() {
+               double sum = 0;
+               for ( int r = 0; r < 10; r++ ) {
+                 sum += bqm.energy( sample );
+               }
+               do_not_optimize( sum );
+             } ) );
+  print_row( "no validation", baseline, measure( [ & ]() {
+               double sum = 0;
+               for ( int r = 0; r < 10; r++ ) {
+                 sum += bqm.energy( sample, false );
+               }
+               do_not_optimize( sum );
+             } ) );
+
+  // the former energies: a serial push_back loop over energy
+  std::vector<Sample<int64_t>> samples( num_samples, sample );
+  for ( auto &s : samples ) {
+    for ( auto &it : s ) {
+      it.second = rng() % 2 == 0 ? -1 : 1;
+    }
+  }
+  print_header( "Dict BQM energies (baseline: serial loop of the former energy)" );
+  print_row(
+      "energies",
+      measure( [ & ]() {
+        std::vector<double> en_vec;
+        for ( const auto &s : samples ) {
+          en_vec.push_back( legacy_energy( bqm, s ) );
+        }
+        do_not_optimize( en_vec.back() );
+      } ),
+      measure( [ & ]() { do_not_optimize( bqm.energies( samples ).back() ); } ) );
+
+  print_header( "Dict BQM add_interaction (baseline: count + operator[] + insert_or_assign)" );
+  print_row(
+      "add_interaction",
+      measure( [ & ]() {
+        Linear<int64_t, double> linear;
+        Quadratic<int64_t, double> quadratic;
+        for ( const auto &e : edges ) {
+          legacy_add_interaction( linear, quadratic, e.first, e.second, 1.0 );
+        }
+        do_not_optimize( static_cast<double>( quadratic.size() ) );
+      } ),
+      measure( [ & ]() {
+        Linear<int64_t, double> linear;
+        Quadratic<int64_t, double> quadratic;
+        for ( const auto &e : edges ) {
+          linear.try_emplace( e.first, 0 );
+          linear.try_emplace( e.second, 0 );
+          quadratic.try_emplace( std::make_pair( std::min( e.first, e.second ), std::max( e.first, e.second ) ), 0 )
+              .first->second
+              += 1.0;
+        }
+        do_not_optimize( static_cast<double>( quadratic.size() ) );
+      } ) );
+  print_time( "DictBQM::add_interaction [ms]", measure( [ & ]() {
+                DictBQM model( Linear<int64_t, double>(), Quadratic<int64_t, double>(), 0.0, Vartype::SPIN );
+                for ( const auto &e : edges ) {
+                  model.add_interaction( e.first, e.second, 1.0 );
+                }
+                do_not_optimize( static_cast<double>( model.get_num_variables() ) );
+              } ) );
+  return 0;
+}
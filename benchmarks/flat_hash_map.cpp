@@ -0,0 +1,129 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+// Insert, lookup and iteration of the key types of Linear, Quadratic and Polynomial:
+// std::unordered_map (baseline) vs FlatHashMap (target).
+//
+// usage: cimod_bench_flat_hash_map [num_keys]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "cimod/flat_hash_map.hpp"
+#include "cimod/hash.hpp"
+
+using namespace cimod_benchmark;
+
+template<typename Map, typename Key>
+double bench_insert( const std::vector<Key> &keys ) {
+  return measure( [ &keys ]() {
+    Map map;
+    for ( size_t i = 0; i < keys.size(); i++ ) {
+      map[ keys[ i ] ] += 1.0;
+    }
+    do_not_optimize( static_cast<double>( map.size() ) );
+  } );
+}
+
+template<typename Map, typename Key>
+double bench_lookup( const std::vector<Key> &keys, const std::vector<Key> &queries ) {
+  Map map;
+  for ( const auto &key : keys ) {
+    map[ key ] = 1.0;
+  }
+  return measure( [ &map, &queries ]() {
+    double sum = 0;
+    for ( const auto &key : queries ) {
+      auto it = map.find( key );
+      if ( it != map.end() ) {
+        sum += it->second;
+      }
+    }
+    do_not_optimize( sum );
+  } );
+}
+
+template<typename Map, typename Key>
+double bench_iterate( const std::vector<Key> &keys ) {
+  Map map;
+  for ( const auto &key : keys ) {
+    map[ key ] = 1.0;
+  }
+  return measure( [ &map ]() {
+    double sum = 0;
+    for ( int r = 0; r < 10; r++ ) {
+      for ( const auto &it : map ) {
+        sum += it.second;
+      }
+    }
+    do_not_optimize( sum );
+  } );
+}
+
+template<typename Key, typename Hash>
+void run( const char *title, const std::vector<Key> &keys ) {
+  using Std = std::unordered_map<Key, double, Hash>;
+  using Flat = cimod::FlatHashMap<Key, double, Hash>;
+
+  // half of the queries hit
+  std::vector<Key> queries( keys.begin(), keys.begin() + keys.size() / 2 );
+  std::vector<Key> misses( keys.begin() + keys.size() / 2, keys.end() );
+  std::vector<Key> inserted( keys.begin(), keys.begin() + keys.size() / 2 );
+  queries.insert( queries.end(), misses.begin(), misses.end() );
+
+  print_header( title );
+  print_row( "insert", bench_insert<Std>( keys ), bench_insert<Flat>( keys ) );
+  print_row( "lookup (50% hit)", bench_lookup<Std>( inserted, queries ), bench_lookup<Flat>( inserted, queries ) );
+  print_row( "iterate x10", bench_iterate<Std>( keys ), bench_iterate<Flat>( keys ) );
+}
+
+int main( int argc, char **argv ) {
+  const size_t num_keys = argc > 1 ? std::strtoul( argv[ 1 ], nullptr, 10 ) : 1000000;
+  XorShift rng;
+
+  // Linear: variable labels
+  std::vector<int64_t> labels( num_keys );
+  for ( auto &label : labels ) {
+    label = static_cast<int64_t>( rng() % ( 16 * num_keys ) );
+  }
+  run<int64_t, std::hash<int64_t>>( "Linear (int64_t -> double)", labels );
+
+  // Quadratic: pairs of labels of a sparse graph
+  const int64_t num_variables = static_cast<int64_t>( num_keys / 8 + 1 );
+  std::vector<std::pair<int64_t, int64_t>> pairs( num_keys );
+  for ( auto &p : pairs ) {
+    const int64_t i = static_cast<int64_t>( rng() % num_variables );
+    const int64_t j = static_cast<int64_t>( rng() % num_variables );
+    p = std::make_pair( std::min( i, j ), std::max( i, j ) );
+  }
+  run<std::pair<int64_t, int64_t>, cimod::pair_hash>( "Quadratic (pair -> double)", pairs );
+
+  // Polynomial: sorted keys of degree 1 to 4
+  std::vector<std::vector<int64_t>> terms( num_keys / 4 );
+  for ( auto &term : terms ) {
+    term.resize( 1 + rng() % 4 );
+    for ( auto &index : term ) {
+      index = static_cast<int64_t>( rng() % num_variables );
+    }
+    std::sort( term.begin(), term.end() );
+  }
+  run<std::vector<int64_t>, cimod::vector_hash>( "Polynomial (vector -> double)", terms );
+  return 0;
+}
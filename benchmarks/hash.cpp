@@ -0,0 +1,196 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+// Bucket collisions and insert / lookup time of std::unordered_map on grid-like label sets:
+// the former boost-style hash_combine (baseline) vs the mixer of hash.hpp (target).
+//
+// usage: cimod_bench_hash [grid_size]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "cimod/hash.hpp"
+
+using namespace cimod_benchmark;
+
+using Label2 = std::tuple<int64_t, int64_t>;
+using Label3 = std::tuple<int64_t, int64_t, int64_t>;
+
+// the hash functions before the mixer (0x9e3779b9 combine over the identity std::hash of integers)
+struct LegacyHash {
+  static std::size_t combine( std::size_t seed, std::size_t h ) {
+    return seed ^ ( h + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 ) );
+  }
+
+  std::size_t operator()( int64_t v ) const {
+    return std::hash<int64_t>()( v );
+  }
+
+  template<typename... Args>
+  std::size_t operator()( const std::tuple<Args...> &t ) const {
+    std::size_t seed = 0;
+    std::apply( [ & ]( const auto &...args ) { ( ( seed = combine( seed, ( *this )( args ) ) ), ... ); }, t );
+    return seed;
+  }
+
+  template<typename T1, typename T2>
+  std::size_t operator()( const std::pair<T1, T2> &p ) const {
+    const std::size_t lhs = ( *this )( p.first ), rhs = ( *this )( p.second );
+    return lhs ^ ( rhs + 0x9e3779b9 + ( lhs << 6 ) + ( lhs >> 2 ) );
+  }
+
+  template<typename T>
+  std::size_t operator()( const std::vector<T> &V ) const {
+    std::size_t hash = V.size();
+    for ( const auto &i : V ) {
+      hash ^= ( *this )( i ) + 0x9e3779b9 + ( hash << 6 ) + ( hash >> 2 );
+    }
+    return hash;
+  }
+};
+
+// the hash functions of hash.hpp, as used by Linear, Quadratic, Polynomial and the label indices
+struct CurrentHash {
+  template<typename T>
+  std::size_t operator()( const T &v ) const {
+    return std::hash<T>()( v );
+  }
+
+  template<typename T1, typename T2>
+  std::size_t operator()( const std::pair<T1, T2> &p ) const {
+    return cimod::pair_hash()( p );
+  }
+
+  template<typename T>
+  std::size_t operator()( const std::vector<T> &V ) const {
+    return cimod::vector_hash()( V );
+  }
+};
+
+struct Stats {
+  std::size_t distinct_hashes;
+  std::size_t max_bucket;
+  double mean_bucket; // mean size of the bucket of an entry (1 + the expected number of other entries)
+  double insert_time;
+  double lookup_time;
+};
+
+template<typename Key, typename Hash>
+Stats evaluate( const std::vector<Key> &keys ) {
+  Stats stats;
+  std::unordered_set<std::size_t> hashes;
+  hashes.reserve( keys.size() );
+  for ( const auto &key : keys ) {
+    hashes.insert( Hash()( key ) );
+  }
+  stats.distinct_hashes = hashes.size();
+
+  std::unordered_map<Key, double, Hash> map;
+  for ( const auto &key : keys ) {
+    map[ key ] = 1.0;
+  }
+  stats.max_bucket = 0;
+  double sum = 0;
+  for ( const auto &key : keys ) {
+    const std::size_t size = map.bucket_size( map.bucket( key ) );
+    stats.max_bucket = std::max( stats.max_bucket, size );
+    sum += static_cast<double>( size );
+  }
+  stats.mean_bucket = sum / static_cast<double>( keys.size() );
+
+  // keys are inserted in the lattice order and looked up in a random order (e.g. the iteration order of another map)
+  stats.insert_time = measure( [ &keys ]() {
+    std::unordered_map<Key, double, Hash> m;
+    for ( const auto &key : keys ) {
+      m[ key ] += 1.0;
+    }
+    do_not_optimize( static_cast<double>( m.size() ) );
+  } );
+  std::vector<Key> queries = keys;
+  XorShift rng;
+  for ( std::size_t i = queries.size(); i > 1; i-- ) {
+    std::swap( queries[ i - 1 ], queries[ rng() % i ] );
+  }
+  stats.lookup_time = measure( [ &map, &queries ]() {
+    double s = 0;
+    for ( const auto &key : queries ) {
+      s += map.find( key )->second;
+    }
+    do_not_optimize( s );
+  } );
+  return stats;
+}
+
+template<typename Key>
+void run( const char *title, const std::vector<Key> &keys ) {
+  const Stats legacy = evaluate<Key, LegacyHash>( keys );
+  const Stats current = evaluate<Key, CurrentHash>( keys );
+  std::printf( "\n# %s (%zu keys)\n", title, keys.size() );
+  std::printf( "%-28s %12s %12s\n", "", "baseline", "target" );
+  std::printf( "%-28s %12zu %12zu\n", "distinct hash values", legacy.distinct_hashes, current.distinct_hashes );
+  std::printf( "%-28s %12zu %12zu\n", "max bucket size", legacy.max_bucket, current.max_bucket );
+  std::printf( "%-28s %12.2f %12.2f\n", "mean bucket size per key", legacy.mean_bucket, current.mean_bucket );
+  print_row( "insert (lattice order) [ms]", legacy.insert_time, current.insert_time );
+  print_row( "lookup (random order) [ms]", legacy.lookup_time, current.lookup_time );
+}
+
+int main( int argc, char **argv ) {
+  const int64_t L = argc > 1 ? std::strtol( argv[ 1 ], nullptr, 10 ) : 512;
+  const int64_t L3 = std::max<int64_t>( 2, static_cast<int64_t>( std::cbrt( static_cast<double>( L * L ) ) ) );
+
+  std::vector<Label2> grid2;
+  std::vector<std::pair<Label2, Label2>> edges2;
+  std::vector<std::pair<int64_t, int64_t>> edges_int;
+  std::vector<std::vector<int64_t>> plaquettes;
+  for ( int64_t x = 0; x < L; x++ ) {
+    for ( int64_t y = 0; y < L; y++ ) {
+      grid2.emplace_back( x, y );
+      if ( x + 1 < L ) {
+        edges2.emplace_back( Label2( x, y ), Label2( x + 1, y ) );
+        edges_int.emplace_back( x * L + y, ( x + 1 ) * L + y );
+      }
+      if ( y + 1 < L ) {
+        edges2.emplace_back( Label2( x, y ), Label2( x, y + 1 ) );
+        edges_int.emplace_back( x * L + y, x * L + y + 1 );
+      }
+      if ( x + 1 < L && y + 1 < L ) {
+        plaquettes.push_back( { x * L + y, x * L + y + 1, ( x + 1 ) * L + y, ( x + 1 ) * L + y + 1 } );
+      }
+    }
+  }
+  std::vector<Label3> grid3;
+  for ( int64_t x = 0; x < L3; x++ ) {
+    for ( int64_t y = 0; y < L3; y++ ) {
+      for ( int64_t z = 0; z < L3; z++ ) {
+        grid3.emplace_back( x, y, z );
+      }
+    }
+  }
+
+  run( "tuple2 labels of a square grid", grid2 );
+  run( "tuple3 labels of a cubic grid", grid3 );
+  run( "nearest-neighbor pairs of tuple2", edges2 );
+  run( "nearest-neighbor pairs of int", edges_int );
+  run( "plaquette keys (vector)", plaquettes );
+  return 0;
+}
@@ -0,0 +1,104 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+// Construction and energy of the Dict BQM and the BPM with the containers selected at build time.
+// cimod_bench_models uses std::unordered_map and cimod_bench_models_flat uses FlatHashMap (CIMOD_USE_FLAT_HASH_MAP).
+//
+// usage: cimod_bench_models [num_variables] [degree]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "cimod/binary_polynomial_model.hpp"
+#include "cimod/binary_quadratic_model_dict.hpp"
+
+using namespace cimod_benchmark;
+using namespace cimod;
+
+int main( int argc, char **argv ) {
+  const int64_t num_variables = argc > 1 ? std::strtol( argv[ 1 ], nullptr, 10 ) : 100000;
+  const int64_t degree = argc > 2 ? std::strtol( argv[ 2 ], nullptr, 10 ) : 10;
+  XorShift rng;
+
+#ifdef CIMOD_USE_FLAT_HASH_MAP
+  std::printf( "containers: FlatHashMap\n" );
+#else
+  std::printf( "containers: std::unordered_map\n" );
+#endif
+
+  Linear<int64_t, double> linear;
+  Quadratic<int64_t, double> quadratic;
+  for ( int64_t i = 0; i < num_variables; i++ ) {
+    linear[ i ] = static_cast<double>( rng() % 1000 ) / 1000.0;
+    for ( int64_t d = 0; d < degree / 2; d++ ) {
+      const int64_t j = static_cast<int64_t>( rng() % num_variables );
+      if ( i != j ) {
+        quadratic[ std::make_pair( std::min( i, j ), std::max( i, j ) ) ] = static_cast<double>( rng() % 1000 ) / 1000.0;
+      }
+    }
+  }
+  Sample<int64_t> sample;
+  for ( int64_t i = 0; i < num_variables; i++ ) {
+    sample[ i ] = rng() % 2 == 0 ? -1 : 1;
+  }
+
+  std::printf(
+      "\n# Dict BQM (%lld variables, %zu interactions)\n", static_cast<long long>( num_variables ), quadratic.size() );
+  print_time( "construct [ms]", measure( [ & ]() {
+                BinaryQuadraticModel<int64_t, double, Dict> bqm( linear, quadratic, 0.0, Vartype::SPIN );
+                do_not_optimize( static_cast<double>( bqm.get_num_variables() ) );
+              } ) );
+  BinaryQuadraticModel<int64_t, double, Dict> bqm( linear, quadratic, 0.0, Vartype::SPIN );
+  print_time( "energy x10 [ms]", measure( [ & ]() {
+                double sum = 0;
+                for ( int r = 0; r < 10; r++ ) {
+                  sum += bqm.energy( sample );
+                }
+                do_not_optimize( sum );
+              } ) );
+  print_time( "get_quadratic lookups [ms]", measure( [ & ]() {
+                double sum = 0;
+                for ( const auto &it : quadratic ) {
+                  sum += bqm.get_quadratic( it.first.first, it.first.second );
+                }
+                do_not_optimize( sum );
+              } ) );
+
+  Polynomial<int64_t, double> polynomial;
+  for ( int64_t k = 0; k < num_variables * degree / 2; k++ ) {
+    std::vector<int64_t> key( 1 + rng() % 4 );
+    for ( auto &index : key ) {
+      index = static_cast<int64_t>( rng() % num_variables );
+    }
+    polynomial[ key ] += static_cast<double>( rng() % 1000 ) / 1000.0;
+  }
+  std::printf( "\n# BPM (%zu interactions)\n", polynomial.size() );
+  print_time( "construct [ms]", measure( [ & ]() {
+                BinaryPolynomialModel<int64_t, double> bpm( polynomial, Vartype::SPIN );
+                do_not_optimize( static_cast<double>( bpm.GetNumInteractions() ) );
+              } ) );
+  BinaryPolynomialModel<int64_t, double> bpm( polynomial, Vartype::SPIN );
+  print_time( "GetPolynomial lookups [ms]", measure( [ & ]() {
+                double sum = 0;
+                for ( const auto &it : polynomial ) {
+                  sum += bpm.GetPolynomial( it.first );
+                }
+                do_not_optimize( sum );
+              } ) );
+  return 0;
+}
@@ -52,9 +52,56 @@ PYBIND11_MODULE( cxxcimod, m ) {
   declare_BQM<std::tuple<size_t, size_t, size_t>, double, cimod::Dict>( m, "BinaryQuadraticModel_tuple3_Dict" );
   declare_BQM<std::tuple<size_t, size_t, size_t, size_t>, double, cimod::Dict>( m, "BinaryQuadraticModel_tuple4_Dict" );
 
+  declare_BQM<int64_t, double, cimod::PackedDense>( m, "BinaryQuadraticModel_PackedDense" );
+  declare_BQM<std::string, double, cimod::PackedDense>( m, "BinaryQuadraticModel_str_PackedDense" );
+  declare_BQM<std::tuple<size_t, size_t>, double, cimod::PackedDense>( m, "BinaryQuadraticModel_tuple2_PackedDense" );
+  declare_BQM<std::tuple<size_t, size_t, size_t>, double, cimod::PackedDense>( m, "BinaryQuadraticModel_tuple3_PackedDense" );
+  declare_BQM<std::tuple<size_t, size_t, size_t, size_t>, double, cimod::PackedDense>(
+      m, "BinaryQuadraticModel_tuple4_PackedDense" );
+
+  declare_BQM<int64_t, float, cimod::Dense>( m, "BinaryQuadraticModel_Dense_float32" );
+  declare_BQM<std::string, float, cimod::Dense>( m, "BinaryQuadraticModel_str_Dense_float32" );
+  declare_BQM<std::tuple<size_t, size_t>, float, cimod::Dense>( m, "BinaryQuadraticModel_tuple2_Dense_float32" );
+  declare_BQM<std::tuple<size_t, size_t, size_t>, float, cimod::Dense>( m, "BinaryQuadraticModel_tuple3_Dense_float32" );
+  declare_BQM<std::tuple<size_t, size_t, size_t, size_t>, float, cimod::Dense>(
+      m, "BinaryQuadraticModel_tuple4_Dense_float32" );
+
+  declare_BQM<int64_t, float, cimod::Sparse>( m, "BinaryQuadraticModel_Sparse_float32" );
+  declare_BQM<std::string, float, cimod::Sparse>( m, "BinaryQuadraticModel_str_Sparse_float32" );
+  declare_BQM<std::tuple<size_t, size_t>, float, cimod::Sparse>( m, "BinaryQuadraticModel_tuple2_Sparse_float32" );
+  declare_BQM<std::tuple<size_t, size_t, size_t>, float, cimod::Sparse>( m, "BinaryQuadraticModel_tuple3_Sparse_float32" );
+  declare_BQM<std::tuple<size_t, size_t, size_t, size_t>, float, cimod::Sparse>(
+      m, "BinaryQuadraticModel_tuple4_Sparse_float32" );
+
+  declare_BQM<int64_t, float, cimod::Dict>( m, "BinaryQuadraticModel_Dict_float32" );
+  declare_BQM<std::string, float, cimod::Dict>( m, "BinaryQuadraticModel_str_Dict_float32" );
+  declare_BQM<std::tuple<size_t, size_t>, float, cimod::Dict>( m, "BinaryQuadraticModel_tuple2_Dict_float32" );
+  declare_BQM<std::tuple<size_t, size_t, size_t>, float, cimod::Dict>( m, "BinaryQuadraticModel_tuple3_Dict_float32" );
+  declare_BQM<std::tuple<size_t, size_t, size_t, size_t>, float, cimod::Dict>(
+      m, "BinaryQuadraticModel_tuple4_Dict_float32" );
+
+  declare_BQM<int64_t, float, cimod::PackedDense>( m, "BinaryQuadraticModel_PackedDense_float32" );
+  declare_BQM<std::string, float, cimod::PackedDense>( m, "BinaryQuadraticModel_str_PackedDense_float32" );
+  declare_BQM<std::tuple<size_t, size_t>, float, cimod::PackedDense>( m, "BinaryQuadraticModel_tuple2_PackedDense_float32" );
+  declare_BQM<std::tuple<size_t, size_t, size_t>, float, cimod::PackedDense>(
+      m, "BinaryQuadraticModel_tuple3_PackedDense_float32" );
+  declare_BQM<std::tuple<size_t, size_t, size_t, size_t>, float, cimod::PackedDense>(
+      m, "BinaryQuadraticModel_tuple4_PackedDense_float32" );
+
+  declare_MappedBQM<int64_t, double>( m, "MappedBinaryQuadraticModel" );
+  declare_MappedBQM<std::string, double>( m, "MappedBinaryQuadraticModel_str" );
+  declare_MappedBQM<int64_t, float>( m, "MappedBinaryQuadraticModel_float32" );
+  declare_MappedBQM<std::string, float>( m, "MappedBinaryQuadraticModel_str_float32" );
+
   declare_BPM<int64_t, double>( m, "BinaryPolynomialModel" );
   declare_BPM<std::string, double>( m, "BinaryPolynomialModel_str" );
   declare_BPM<std::tuple<int64_t, int64_t>, double>( m, "BinaryPolynomialModel_tuple2" );
   declare_BPM<std::tuple<int64_t, int64_t, int64_t>, double>( m, "BinaryPolynomialModel_tuple3" );
   declare_BPM<std::tuple<int64_t, int64_t, int64_t, int64_t>, double>( m, "BinaryPolynomialModel_tuple4" );
+
+  declare_BPM<int64_t, float>( m, "BinaryPolynomialModel_float32" );
+  declare_BPM<std::string, float>( m, "BinaryPolynomialModel_str_float32" );
+  declare_BPM<std::tuple<int64_t, int64_t>, float>( m, "BinaryPolynomialModel_tuple2_float32" );
+  declare_BPM<std::tuple<int64_t, int64_t, int64_t>, float>( m, "BinaryPolynomialModel_tuple3_float32" );
+  declare_BPM<std::tuple<int64_t, int64_t, int64_t, int64_t>, float>( m, "BinaryPolynomialModel_tuple4_float32" );
 }
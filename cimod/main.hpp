@@ -20,6 +20,7 @@
 #include <pybind11/stl.h>
 #include <pybind11/functional.h>
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 
 #include <pybind11_json/pybind11_json.hpp>
 
@@ -30,13 +31,65 @@
 #include <cimod/binary_polynomial_model.hpp>
 #include <cimod/binary_quadratic_model.hpp>
 #include <cimod/binary_quadratic_model_dict.hpp>
+#include <cimod/binary_quadratic_model_packed.hpp>
 #include <cimod/disable_eigen_warning.hpp>
+#include <cimod/io/bqpjson.hpp>
+#include <cimod/io/coo.hpp>
+#include <cimod/io/qubo.hpp>
+#include <cimod/mapped_binary_quadratic_model.hpp>
 
 namespace py = pybind11;
 
+// FlatHashMap (the containers with CIMOD_USE_FLAT_HASH_MAP) is converted from / to dict like std::unordered_map
+namespace pybind11 {
+  namespace detail {
+    template<typename Key, typename Value, typename Hash, typename KeyEqual>
+    struct type_caster<cimod::FlatHashMap<Key, Value, Hash, KeyEqual>>
+        : map_caster<cimod::FlatHashMap<Key, Value, Hash, KeyEqual>, Key, Value> { };
+  } // namespace detail
+} // namespace pybind11
+
 using namespace py::literals;
 using namespace cimod;
 
+// read-only NumPy array over the memory owned by base, which is kept alive by the array
+template<typename T>
+inline py::array readonly_array(
+    const std::vector<py::ssize_t>& shape,
+    const std::vector<py::ssize_t>& strides,
+    const T* data,
+    py::handle base ) {
+  py::array array( py::dtype::of<T>(), shape, strides, data, base );
+  py::detail::array_proxy( array.ptr() )->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+  return array;
+}
+
+// energies of C-contiguous 2-D int8 / int32 arrays of samples (rows are samples, columns follow the sorted variables).
+// kernel( self, samples, num_samples ) runs without the GIL. The overloads are registered before the sequence
+// overloads of energies, so that such arrays are never converted element by element.
+template<typename Model, typename FloatType, typename PyClass, typename NumVariables, typename Kernel>
+inline void def_array_energies( PyClass& pyclass, const char* arg, NumVariables num_variables, Kernel kernel ) {
+  auto def = [ & ]( auto sample_type ) {
+    using SampleType = decltype( sample_type );
+    pyclass.def(
+        "energies",
+        [ num_variables, kernel ]( const Model& self, const py::array_t<SampleType, py::array::c_style>& samples ) {
+          if ( samples.ndim() != 2 || static_cast<std::size_t>( samples.shape( 1 ) ) != num_variables( self ) ) {
+            throw std::runtime_error( "samples must be a 2-D array of shape (num_samples, num_variables)." );
+          }
+          std::vector<FloatType> en_vec;
+          {
+            py::gil_scoped_release release;
+            en_vec = kernel( self, samples.data(), static_cast<std::size_t>( samples.shape( 0 ) ) );
+          }
+          return py::array_t<FloatType>( en_vec.size(), en_vec.data() );
+        },
+        py::arg( arg ).noconvert() );
+  };
+  def( int8_t() );
+  def( int32_t() );
+}
+
 template<typename IndexType, typename FloatType, typename DataType>
 inline void declare_BQM( py::module& m, const std::string& name ) {
 
@@ -47,6 +100,14 @@ inline void declare_BQM( py::module& m, const std::string& name ) {
 
   auto pyclass_BQM = py::class_<BQM>( m, name.c_str() );
 
+  def_array_energies<BQM, FloatType>(
+      pyclass_BQM,
+      "samples_like",
+      []( const BQM& self ) { return self.get_num_variables(); },
+      []( const BQM& self, const auto* samples, std::size_t num_samples ) {
+        return self.energies( samples, num_samples );
+      } );
+
   pyclass_BQM
       .def(
           py::init<Linear<IndexType, FloatType>, Quadratic<IndexType, FloatType>, FloatType, Vartype>(),
@@ -127,8 +188,14 @@ inline void declare_BQM( py::module& m, const std::string& name ) {
       //.def("contract_variables", &BQM::contract_variables, "u"_a, "v"_a)
       .def( "change_vartype", py::overload_cast<const Vartype&>( &BQM::change_vartype ), "vartype"_a )
       .def( "change_vartype", py::overload_cast<const Vartype&, bool>( &BQM::change_vartype ), "vartype"_a, "inplace"_a )
-      .def( "energy", &BQM::energy, "sample"_a )
-      .def( "energies", &BQM::energies, "samples_like"_a )
+      .def(
+          "energy", []( const BQM& self, const Sample<IndexType>& sample ) { return self.energy( sample ); }, "sample"_a )
+      .def(
+          "energies",
+          []( const BQM& self, const std::vector<Sample<IndexType>>& samples_like ) {
+            return self.energies( samples_like );
+          },
+          "samples_like"_a )
       .def( "to_qubo", &BQM::to_qubo )
       .def( "to_ising", &BQM::to_ising )
       .def_static( "from_qubo", &BQM::from_qubo, "Q"_a, "offset"_a = 0.0 )
@@ -140,21 +207,181 @@ inline void declare_BQM( py::module& m, const std::string& name ) {
       .def_static(
           "from_serializable",
           []( const py::object& input ) { return BQM::from_serializable( static_cast<nlohmann::json>( input ) ); },
-          "input"_a );
+          "input"_a )
+      .def( "save", &BQM::save, "path"_a )
+      .def_static( "load", &BQM::load, "path"_a );
+
+  // view in the other vartype; the view keeps the model alive
+  using View = VartypeView<IndexType, FloatType, DataType>;
+  py::class_<View>( m, ( name + "_VartypeView" ).c_str() )
+      .def( "energy", &View::energy, "sample"_a )
+      .def( "energies", &View::energies, "samples_like"_a )
+      .def( "get_vartype", &View::get_vartype );
+  pyclass_BQM.def( "change_vartype_view", &BQM::change_vartype_view, "vartype"_a, py::keep_alive<0, 1>() );
+
+  // id-based accessors, neighbors and version for Dense and Sparse class
+  if constexpr ( std::is_same_v<DataType, cimod::Dense> || std::is_same_v<DataType, cimod::Sparse> )
+    pyclass_BQM.def( "get_id", &BQM::get_id, "v"_a )
+        .def( "get_label", &BQM::get_label, "id"_a )
+        .def( "get_linear_id", &BQM::get_linear_id, "id"_a )
+        .def( "get_quadratic_id", &BQM::get_quadratic_id, "id_i"_a, "id_j"_a )
+        .def( "add_variable_id", &BQM::add_variable_id, "id"_a, "bias"_a )
+        .def( "add_interaction_id", &BQM::add_interaction_id, "id_i"_a, "id_j"_a, "bias"_a )
+        .def( "energy_ids", &BQM::energy_ids, "state"_a )
+        .def(
+            "neighbors",
+            []( const BQM& self, const IndexType& v ) {
+              Linear<IndexType, FloatType> adjacent;
+              for ( const auto& it : self.neighbors( v ) ) {
+                adjacent.emplace( it.first, it.second );
+              }
+              return adjacent;
+            },
+            "v"_a )
+        .def( "degree", &BQM::degree, "v"_a )
+        .def( "get_adjacency", &BQM::get_adjacency )
+        .def( "get_version", &BQM::get_version );
 
-  // interaction_matrix for Dict (legacy BQM) class
+  // zero-copy views of the interaction matrix; the views keep the model alive, but any change of the model may
+  // reallocate the matrix. The Python wrapper checks get_version() and refuses stale views.
+  if constexpr ( std::is_same_v<DataType, cimod::Dense> )
+    pyclass_BQM.def(
+        "interaction_matrix_view",
+        []( py::object self ) {
+          const DenseMatrix& mat = self.cast<BQM&>().interaction_matrix_ref();
+          const py::ssize_t itemsize = sizeof( FloatType );
+          return readonly_array<FloatType>(
+              { mat.rows(), mat.cols() }, { mat.cols() * itemsize, itemsize }, mat.data(), self );
+        },
+        "Read-only view of the interaction matrix without copying. "
+        "The view is invalidated by any change of the model." );
+  if constexpr ( std::is_same_v<DataType, cimod::Sparse> )
+    pyclass_BQM.def(
+        "interaction_matrix_view",
+        []( py::object self ) {
+          using StorageIndex = typename SparseMatrix::StorageIndex;
+          const SparseMatrix& mat = self.cast<BQM&>().interaction_matrix_ref();
+          const py::ssize_t nnz = mat.nonZeros();
+          py::array data = readonly_array<FloatType>( { nnz }, { sizeof( FloatType ) }, mat.valuePtr(), self );
+          py::array indices
+              = readonly_array<StorageIndex>( { nnz }, { sizeof( StorageIndex ) }, mat.innerIndexPtr(), self );
+          py::array indptr = readonly_array<StorageIndex>(
+              { mat.outerSize() + 1 }, { sizeof( StorageIndex ) }, mat.outerIndexPtr(), self );
+          return py::module_::import( "scipy.sparse" )
+              .attr( "csr_matrix" )(
+                  py::make_tuple( data, indices, indptr ),
+                  "shape"_a = py::make_tuple( mat.rows(), mat.cols() ),
+                  "copy"_a = false );
+        },
+        "Read-only CSR view of the interaction matrix without copying. "
+        "The view is invalidated by any change of the model." );
+
+  // text formats for integer labels; files are parsed without the GIL
+  if constexpr ( std::is_same_v<IndexType, int64_t> )
+    pyclass_BQM
+        .def_static(
+            "read_qubo",
+            []( const std::string& path ) {
+              return io::read_qubo<IndexType, FloatType>( path ).template to_bqm<DataType>();
+            },
+            "path"_a,
+            py::call_guard<py::gil_scoped_release>() )
+        .def_static(
+            "read_coo",
+            []( const std::string& path, Vartype vartype ) {
+              return io::read_coo<IndexType, FloatType>( path, vartype ).template to_bqm<DataType>();
+            },
+            "path"_a,
+            "vartype"_a = Vartype::NONE,
+            py::call_guard<py::gil_scoped_release>() )
+        .def_static(
+            "read_bqpjson",
+            []( const std::string& path ) {
+              return io::read_bqpjson<IndexType, FloatType>( path ).template to_bqm<DataType>();
+            },
+            "path"_a,
+            py::call_guard<py::gil_scoped_release>() )
+        .def( "write_qubo", []( const BQM& self, const std::string& path ) { io::write_qubo( path, self ); }, "path"_a )
+        .def( "write_coo", []( const BQM& self, const std::string& path ) { io::write_coo( path, self ); }, "path"_a )
+        .def(
+            "write_bqpjson", []( const BQM& self, const std::string& path ) { io::write_bqpjson( path, self ); }, "path"_a );
+
+  // from_coo for Dense, Sparse and PackedDense class
+  if constexpr ( !std::is_same_v<DataType, cimod::Dict> )
+    pyclass_BQM.def_static( "from_coo", &BQM::from_coo, "row"_a, "col"_a, "bias"_a, "offset"_a, "vartype"_a );
+
+  // interaction_matrix and adjacency for Dict (legacy BQM) class
   if constexpr ( std::is_same_v<DataType, cimod::Dict> )
     pyclass_BQM.def( "_generate_indices", &BQM::_generate_indices )
+        .def( "degree", &BQM::degree, "v"_a )
+        .def( "get_adjacency", &BQM::get_adjacency )
+        .def( "energy", &BQM::energy, "sample"_a, "validate"_a )
+        .def(
+            "energies",
+            py::overload_cast<const std::vector<Sample<IndexType>>&, bool>( &BQM::energies, py::const_ ),
+            "samples_like"_a,
+            "validate"_a )
         .def(
             "interaction_matrix", py::overload_cast<const std::vector<IndexType>&>( &BQM::interaction_matrix, py::const_ ) );
 }
 
+template<typename IndexType, typename FloatType>
+inline void declare_MappedBQM( py::module& m, const std::string& name ) {
+  using MBQM = MappedBinaryQuadraticModel<IndexType, FloatType>;
+
+  py::class_<MBQM>( m, name.c_str() )
+      .def( py::init<const std::string&>(), "path"_a )
+      .def( "get_num_variables", &MBQM::get_num_variables )
+      .def( "get_num_interactions", &MBQM::get_num_interactions )
+      .def( "contains", &MBQM::contains, "v"_a )
+      .def( "get_variables", &MBQM::get_variables )
+      .def( "get_offset", &MBQM::get_offset )
+      .def( "get_vartype", &MBQM::get_vartype )
+      .def( "get_linear", py::overload_cast<const IndexType&>( &MBQM::get_linear, py::const_ ), "label_i"_a )
+      .def( "get_linear", py::overload_cast<>( &MBQM::get_linear, py::const_ ) )
+      .def(
+          "get_quadratic",
+          py::overload_cast<const IndexType&, const IndexType&>( &MBQM::get_quadratic, py::const_ ),
+          "label_i"_a,
+          "label_j"_a )
+      .def( "get_quadratic", py::overload_cast<>( &MBQM::get_quadratic, py::const_ ) )
+      .def( "degree", &MBQM::degree, "v"_a )
+      .def(
+          "neighbors",
+          []( const MBQM& self, const IndexType& v ) {
+            std::vector<std::pair<IndexType, FloatType>> neighbors;
+            self.for_each_neighbor( v, [ &neighbors ]( const IndexType& u, FloatType bias ) {
+              neighbors.emplace_back( u, bias );
+            } );
+            return neighbors;
+          },
+          "v"_a )
+      .def( "energy", &MBQM::energy, "sample"_a )
+      .def(
+          "energies",
+          py::overload_cast<const std::vector<Sample<IndexType>>&>( &MBQM::energies, py::const_ ),
+          "samples_like"_a,
+          py::call_guard<py::gil_scoped_release>() )
+      .def( "to_qubo", &MBQM::to_qubo )
+      .def( "to_ising", &MBQM::to_ising );
+}
+
 template<typename IndexType, typename FloatType>
 inline void declare_BPM( py::module& m, const std::string& name ) {
 
   using BPM = BinaryPolynomialModel<IndexType, FloatType>;
 
-  py::class_<BPM>( m, name.c_str() )
+  auto pyclass_BPM = py::class_<BPM>( m, name.c_str() );
+
+  def_array_energies<BPM, FloatType>(
+      pyclass_BPM,
+      "samples",
+      []( const BPM& self ) { return self.GetNumVariables(); },
+      []( const BPM& self, const auto* samples, std::size_t num_samples ) {
+        return self.Energies( samples, num_samples );
+      } );
+
+  pyclass_BPM
       .def( py::init<Polynomial<IndexType, FloatType>&, const Vartype>(), "polynomial"_a, "vartype"_a )
       .def(
           py::init<PolynomialKeyList<IndexType>&, PolynomialValueList<FloatType>&, const Vartype>(),
@@ -281,6 +508,8 @@ inline void declare_BPM( py::module& m, const std::string& name ) {
           "from_serializable",
           []( const py::object& input ) { return BPM::FromSerializable( static_cast<nlohmann::json>( input ) ); },
           "input"_a )
+      .def( "save", &BPM::Save, "path"_a )
+      .def_static( "load", &BPM::Load, "path"_a )
       .def_static(
           "from_hubo", py::overload_cast<const Polynomial<IndexType, FloatType>&>( &BPM::FromHubo ), "polynomial"_a )
       .def_static(
@@ -325,4 +554,17 @@ inline void declare_BPM( py::module& m, const std::string& name ) {
         }
         return out.str();
       } );
+
+  // text format for integer labels; files are parsed without the GIL
+  if constexpr ( std::is_same_v<IndexType, int64_t> )
+    pyclass_BPM
+        .def_static(
+            "read_coo",
+            []( const std::string& path, Vartype vartype ) {
+              return io::read_coo_polynomial<IndexType, FloatType>( path, vartype ).to_bpm();
+            },
+            "path"_a,
+            "vartype"_a = Vartype::NONE,
+            py::call_guard<py::gil_scoped_release>() )
+        .def( "write_coo", []( const BPM& self, const std::string& path ) { io::write_coo( path, self ); }, "path"_a );
 }
@@ -15,9 +15,11 @@
 from __future__ import annotations
 
 import cimod.cxxcimod as cxxcimod
+import numpy as np
 import dimod
 
 from cimod.vartype import to_cxxcimod
+from cimod.model.binary_quadratic_model import get_dtype_suffix
 
 
 class Polynomial:
@@ -70,11 +72,14 @@ class IndexType(Enum):
     """
 
 
-def make_BinaryPolynomialModel(polynomial, index_type=None, tuple_size=0):
+def make_BinaryPolynomialModel(
+    polynomial, index_type=None, tuple_size=0, dtype=np.float64
+):
     """BinaryPolynomialModel factory.
        Generate BinaryPolynomialModel class with the base class specified by the arguments linear and quadratic
     Args:
         polynomial (dict): polynomial bias including linear bias
+        dtype (numpy.dtype): type of the biases, numpy.float64 (default) or numpy.float32
     Returns:
         generated BinaryPolynomialModel class
     """
@@ -120,6 +125,10 @@ def make_BinaryPolynomialModel(polynomial, index_type=None, tuple_size=0):
             index_type, [1 for _ in range(min(tuple_size, 4))]
         )
 
+    suffix = get_dtype_suffix(dtype)
+    if suffix != "":
+        base = getattr(cxxcimod, base.__name__ + suffix)
+
     # now define class
     class BinaryPolynomialModel(base):
         """Represents Binary polynomial model.
@@ -473,12 +482,15 @@ def make_BinaryPolynomialModel_from_JSON(obj):
 
 
 def BinaryPolynomialModel(*args, **kwargs):
+    dtype_option = kwargs.pop("dtype", np.float64)
     if kwargs == {}:
         if len(args) <= 1:
             raise TypeError("Invalid argument for this function")
         elif len(args) == 2:
             if isinstance(args[0], dict):
-                return _BinaryPolynomialModel_from_dict(args[0], to_cxxcimod(args[1]))
+                return _BinaryPolynomialModel_from_dict(
+                    args[0], to_cxxcimod(args[1]), dtype_option
+                )
             else:
                 raise TypeError("Invalid argument for this function")
         elif len(args) == 3:
@@ -486,7 +498,7 @@ def BinaryPolynomialModel(*args, **kwargs):
             val_condition = isinstance(args[1], list) or isinstance(args[1], tuple)
             if key_condition and val_condition:
                 return _BinaryPolynomialModel_from_list(
-                    args[0], args[1], to_cxxcimod(args[2])
+                    args[0], args[1], to_cxxcimod(args[2]), dtype_option
                 )
             else:
                 raise TypeError("Invalid argument for this function")
@@ -502,14 +514,17 @@ def BinaryPolynomialModel(*args, **kwargs):
             )
             if key_condition and val_condition:
                 return _BinaryPolynomialModel_from_list(
-                    kwargs["keys"], kwargs["values"], to_cxxcimod(kwargs["vartype"])
+                    kwargs["keys"],
+                    kwargs["values"],
+                    to_cxxcimod(kwargs["vartype"]),
+                    dtype_option,
                 )
             else:
                 raise TypeError("Invalid argument for this function")
         elif "polynomial" in kwargs and "vartype" in kwargs:
             if isinstance(kwargs["polynomial"], dict):
                 return _BinaryPolynomialModel_from_dict(
-                    kwargs["polynomial"], to_cxxcimod(kwargs["vartype"])
+                    kwargs["polynomial"], to_cxxcimod(kwargs["vartype"]), dtype_option
                 )
             else:
                 raise TypeError("Invalid argument for this function")
@@ -522,7 +537,10 @@ def BinaryPolynomialModel(*args, **kwargs):
             )
             if key_condition and val_condition:
                 return _BinaryPolynomialModel_from_list(
-                    args[0], kwargs["values"], to_cxxcimod(kwargs["vartype"])
+                    args[0],
+                    kwargs["values"],
+                    to_cxxcimod(kwargs["vartype"]),
+                    dtype_option,
                 )
             else:
                 raise TypeError("Invalid argument for this function")
@@ -530,7 +548,7 @@ def BinaryPolynomialModel(*args, **kwargs):
             if len(args) == 1:
                 if isinstance(args[0], dict):
                     return _BinaryPolynomialModel_from_dict(
-                        args[0], to_cxxcimod(kwargs["vartype"])
+                        args[0], to_cxxcimod(kwargs["vartype"]), dtype_option
                     )
                 else:
                     raise TypeError("Invalid argument for this function")
@@ -539,7 +557,7 @@ def BinaryPolynomialModel(*args, **kwargs):
                 val_condition = isinstance(args[1], list) or isinstance(args[1], tuple)
                 if key_condition and val_condition:
                     return _BinaryPolynomialModel_from_list(
-                        args[0], args[1], to_cxxcimod(kwargs["vartype"])
+                        args[0], args[1], to_cxxcimod(kwargs["vartype"]), dtype_option
                     )
                 else:
                     raise TypeError("Invalid argument for this function")
@@ -549,14 +567,16 @@ def BinaryPolynomialModel(*args, **kwargs):
             raise TypeError("Invalid argument for this function")
 
 
-def _BinaryPolynomialModel_from_dict(polynomial: dict, vartype):
-    Model = make_BinaryPolynomialModel(polynomial)
+def _BinaryPolynomialModel_from_dict(polynomial: dict, vartype, dtype=np.float64):
+    Model = make_BinaryPolynomialModel(polynomial, dtype=dtype)
     return Model(polynomial, to_cxxcimod(vartype))
 
 
-def _BinaryPolynomialModel_from_list(keys: list, values: list, vartype):
+def _BinaryPolynomialModel_from_list(
+    keys: list, values: list, vartype, dtype=np.float64
+):
     if len(keys) == 0:
-        Model = make_BinaryPolynomialModel({})
+        Model = make_BinaryPolynomialModel({}, dtype=dtype)
         return Model(keys, values, to_cxxcimod(vartype))
     i = 0
     label = None
@@ -566,13 +586,13 @@ def _BinaryPolynomialModel_from_list(keys: list, values: list, vartype):
             break
         i += 1
     if label is None:
-        Model = make_BinaryPolynomialModel({(): 1.0})
+        Model = make_BinaryPolynomialModel({(): 1.0}, dtype=dtype)
         return Model(keys, values, to_cxxcimod(vartype))
     else:
         if isinstance(label, list):
             label = tuple(label)
         mock_polynomial = {(label,): 1.0}
-        Model = make_BinaryPolynomialModel(mock_polynomial)
+        Model = make_BinaryPolynomialModel(mock_polynomial, dtype=dtype)
         return Model(keys, values, to_cxxcimod(vartype))
 
 
@@ -26,9 +26,156 @@ from scipy.sparse import dok_matrix, csr_matrix
 
 from typing import Tuple, Union
 from collections import defaultdict
+from collections.abc import Mapping
 
 
-def get_cxxcimod_class(linear, quadratic, sparse):
+class LinearView(Mapping):
+    """Read-only mapping of the nonzero linear biases of a model.
+       Lookups are answered by the model directly. Iteration uses a snapshot of get_linear(),
+       which is regenerated only after the model has changed.
+    """
+
+    __slots__ = ("_bqm",)
+
+    def __init__(self, bqm):
+        self._bqm = bqm
+
+    def __getitem__(self, v):
+        try:
+            found = self._bqm.contains(v)
+        except TypeError:
+            found = False
+        if found:
+            bias = self._bqm.get_linear(v)
+            if bias != 0:
+                return bias
+        raise KeyError(v)
+
+    def __iter__(self):
+        return iter(self._bqm._snapshot("linear"))
+
+    def __len__(self):
+        return len(self._bqm._snapshot("linear"))
+
+    def __repr__(self):
+        return repr(self._bqm._snapshot("linear"))
+
+
+class QuadraticView(Mapping):
+    """Read-only mapping of the nonzero quadratic biases of a model.
+       Lookups are answered by the interaction matrix directly and accept both (u, v) and (v, u).
+       Iteration uses a snapshot of get_quadratic(), which is regenerated only after the model has changed.
+    """
+
+    __slots__ = ("_bqm",)
+
+    def __init__(self, bqm):
+        self._bqm = bqm
+
+    def __getitem__(self, key):
+        try:
+            u, v = key
+            found = u != v and self._bqm.contains(u) and self._bqm.contains(v)
+        except (TypeError, ValueError):
+            found = False
+        if found:
+            bias = self._bqm.get_quadratic(u, v)
+            if bias != 0:
+                return bias
+        raise KeyError(key)
+
+    def __iter__(self):
+        return iter(self._bqm._snapshot("quadratic"))
+
+    def __len__(self):
+        return len(self._bqm._snapshot("quadratic"))
+
+    def __repr__(self):
+        return repr(self._bqm._snapshot("quadratic"))
+
+
+class _VersionCheck:
+    # raise if the model has changed since the view was created
+    def _check(self):
+        bqm = getattr(self, "_bqm", None)
+        if bqm is not None and bqm.get_version() != self._version:
+            raise RuntimeError(
+                "the model has been modified since the view was created; "
+                "call interaction_matrix_view() again."
+            )
+
+
+class InteractionMatrixView(_VersionCheck, np.ndarray):
+    """Read-only view of the interaction matrix of a dense model without copying.
+       The view aliases the storage of the model, which may be reallocated by any change of the model
+       (e.g. add_variable, change_vartype). Reading the view after the model has changed raises RuntimeError.
+       Slices keep the check, while the results of computations own their data and are not checked.
+    """
+
+    def __array_finalize__(self, obj):
+        if self.base is not None and obj is not None:
+            self._bqm = getattr(obj, "_bqm", None)
+            self._version = getattr(obj, "_version", None)
+        else:
+            self._bqm = None
+            self._version = None
+
+    def __getitem__(self, key):
+        self._check()
+        return super().__getitem__(key)
+
+    def __array_ufunc__(self, ufunc, method, *inputs, **kwargs):
+        args = []
+        for x in inputs:
+            if isinstance(x, InteractionMatrixView):
+                x._check()
+                x = x.view(np.ndarray)
+            args.append(x)
+        return getattr(ufunc, method)(*args, **kwargs)
+
+    def __array_function__(self, func, types, args, kwargs):
+        self._check()
+        return super().__array_function__(func, types, args, kwargs)
+
+    def __repr__(self):
+        self._check()
+        return super().__repr__()
+
+
+class InteractionCSRView(_VersionCheck, csr_matrix):
+    """Read-only CSR view of the interaction matrix of a sparse model without copying.
+       data, indices and indptr alias the storage of the model, which may be reallocated by any change of the model.
+       Accessing them after the model has changed raises RuntimeError.
+    """
+
+    def _array(name):
+        def getter(self):
+            self._check()
+            return self.__dict__["_" + name]
+
+        def setter(self, value):
+            self.__dict__["_" + name] = value
+
+        return property(getter, setter)
+
+    data = _array("data")
+    indices = _array("indices")
+    indptr = _array("indptr")
+    del _array
+
+
+def get_dtype_suffix(dtype):
+    # suffix of the cxxcimod class for the bias type
+    dtype = np.dtype(dtype)
+    if dtype == np.float64:
+        return ""
+    elif dtype == np.float32:
+        return "_float32"
+    else:
+        raise TypeError("dtype must be float32 or float64")
+
+
+def get_cxxcimod_class(linear, quadratic, sparse, dtype=np.float64):
     # select base class
     index = set()
     base = None
@@ -78,6 +225,10 @@ def get_cxxcimod_class(linear, quadratic, sparse):
         else:
             raise TypeError("invalid types of linear and quadratic")
 
+    suffix = get_dtype_suffix(dtype)
+    if suffix != "":
+        base = getattr(cxxcimod, base.__name__ + suffix)
+
     return base
 
 
@@ -125,18 +276,20 @@ def extract_offset_and_vartype(*args, **kwargs):
     return offset, vartype
 
 
-def make_BinaryQuadraticModel(linear, quadratic, sparse):
+def make_BinaryQuadraticModel(linear, quadratic, sparse, dtype=np.float64):
     """BinaryQuadraticModel factory.
        Generate BinaryQuadraticModel class with the base class specified by the arguments linear and quadratic
     Args:
         linear (dict): linear bias
         quadratic (dict): quadratic bias
         sparse (bool): if true, the inner data will be a sparse matrix, otherwise the data will be a dense matrix
+        dtype (numpy.dtype): type of the biases, numpy.float64 (default) or numpy.float32
     Returns:
         generated BinaryQuadraticModel class
     """
 
-    Base = get_cxxcimod_class(linear, quadratic, sparse)
+    dtype = np.dtype(dtype)
+    Base = get_cxxcimod_class(linear, quadratic, sparse, dtype)
 
     # now define class
     class BinaryQuadraticModel(Base):
@@ -146,8 +299,8 @@ def make_BinaryQuadraticModel(linear, quadratic, sparse):
            Indices are listed in self._indices.
         Attributes:
             vartype (cimod.VariableType): variable type SPIN or BINARY
-            linear (dict): represents linear term
-            quadratic (dict): represents quadratic term
+            linear (LinearView): read-only mapping of linear term
+            quadratic (QuadraticView): read-only mapping of quadratic term
             offset (float): represents constant energy term when convert to SPIN from BINARY
             num_variables (int): represents constant energy term when convert to SPIN from BINARY
             variables (list): represents constant energy term when convert to SPIN from BINARY
@@ -234,7 +387,7 @@ def make_BinaryQuadraticModel(linear, quadratic, sparse):
 
             # generate matrix (dense or sparse)
             if sparse is False:
-                mat = np.zeros(shape=(mat_size, mat_size))
+                mat = np.zeros(shape=(mat_size, mat_size), dtype=dtype)
             else:
                 # first defines dict and use `_update` function to make `dok_matrix`
                 # then convert to `csr_matrix`
@@ -256,7 +409,7 @@ def make_BinaryQuadraticModel(linear, quadratic, sparse):
             if sparse is False:
                 return mat, idx_to_label
             else:
-                dok_mat = dok_matrix((mat_size, mat_size))
+                dok_mat = dok_matrix((mat_size, mat_size), dtype=dtype)
                 # SciPy dok_matrix update compatibility layer
                 # See: https://github.com/scipy/scipy/issues/8338
                 try:
@@ -284,13 +437,23 @@ def make_BinaryQuadraticModel(linear, quadratic, sparse):
                 # BINARY
                 return dimod.BINARY
 
+        def _snapshot(self, name):
+            # dict of get_linear() or get_quadratic(), kept until the version of the model changes
+            snapshots = self.__dict__.setdefault("_snapshots", {})
+            version = self.get_version()
+            cached = snapshots.get(name)
+            if cached is None or cached[0] != version:
+                cached = (version, getattr(self, "get_" + name)())
+                snapshots[name] = cached
+            return cached[1]
+
         @property
         def linear(self):
-            return self.get_linear()
+            return LinearView(self)
 
         @property
         def quadratic(self):
-            return self.get_quadratic()
+            return QuadraticView(self)
 
         @property
         def offset(self):
@@ -308,6 +471,10 @@ def make_BinaryQuadraticModel(linear, quadratic, sparse):
         def sparse(self):
             return sparse
 
+        @property
+        def dtype(self):
+            return dtype
+
         def empty(self, vartype):
             return self.__class__(super().empty(to_cxxcimod(vartype)))
 
@@ -325,6 +492,19 @@ def make_BinaryQuadraticModel(linear, quadratic, sparse):
         def __repr__(self):
             return f"BinaryQuadraticModel({self.linear}, {self.quadratic}, {self.offset}, {self.vartype}, sparse={self.sparse})"
 
+        def interaction_matrix_view(self):
+            # the view refuses to be read once the model has changed (see InteractionMatrixView)
+            view = super().interaction_matrix_view()
+            if sparse:
+                view = InteractionCSRView(
+                    (view.data, view.indices, view.indptr), shape=view.shape, copy=False
+                )
+            else:
+                view = view.view(InteractionMatrixView)
+            view._bqm = self
+            view._version = self.get_version()
+            return view
+
         def energy(self, sample):
             if isinstance(sample, list):
                 sample = {self.variables[k]: elem for k, elem in enumerate(sample)}
@@ -332,11 +512,18 @@ def make_BinaryQuadraticModel(linear, quadratic, sparse):
             return super().energy(sample)
 
         def energies(self, samples_like):
-            if isinstance(samples_like[0], list):
-                samples_like = [
-                    {self.variables[k]: elem for k, elem in enumerate(inner_array)}
-                    for inner_array in samples_like
-                ]
+            # arrays of samples (columns follow self.variables) are evaluated in C++
+            # as int8 / int32 arrays without building a dict per sample
+            if isinstance(samples_like, np.ndarray) or isinstance(
+                samples_like[0], list
+            ):
+                samples = np.asarray(samples_like)
+                if samples.dtype != np.int8:
+                    samples = samples.astype(np.int32, copy=False)
+                en_vec = super().energies(np.ascontiguousarray(samples))
+                if isinstance(samples_like, np.ndarray):
+                    return en_vec
+                return en_vec.tolist()
 
             return super().energies(samples_like)
 
@@ -354,6 +541,10 @@ def make_BinaryQuadraticModel(linear, quadratic, sparse):
             if not (len(shape) == 2 and shape[0] == shape[1]):
                 raise TypeError("numpy matrix has to be a square matrix")
 
+            if isinstance(mat, np.ndarray):
+                # a C-contiguous array of the bias type is read in place by the constructor
+                mat = np.ascontiguousarray(mat, dtype=dtype)
+
             return cls(mat, variables, offset, vartype, fix_format, **kwargs)
 
         @classmethod
@@ -379,6 +570,29 @@ def make_BinaryQuadraticModel(linear, quadratic, sparse):
             cxxbqm = Base.from_serializable(obj)
             return cls(cxxbqm, **kwargs)
 
+        @classmethod
+        def load(cls, path, **kwargs):
+            cxxbqm = Base.load(path)
+            return cls(cxxbqm, **kwargs)
+
+        @classmethod
+        def read_qubo(cls, path, **kwargs):
+            cxxbqm = Base.read_qubo(path)
+            return cls(cxxbqm, **kwargs)
+
+        @classmethod
+        def read_coo(cls, path, vartype=None, **kwargs):
+            cxxvartype = (
+                cxxcimod.Vartype.NONE if vartype is None else to_cxxcimod(vartype)
+            )
+            cxxbqm = Base.read_coo(path, cxxvartype)
+            return cls(cxxbqm, **kwargs)
+
+        @classmethod
+        def read_bqpjson(cls, path, **kwargs):
+            cxxbqm = Base.read_bqpjson(path)
+            return cls(cxxbqm, **kwargs)
+
     return BinaryQuadraticModel
 
 
@@ -400,12 +614,15 @@ def make_BinaryQuadraticModel_from_JSON(obj):
     else:
         raise TypeError("Invalid bqm_schema")
 
-    return make_BinaryQuadraticModel(mock_linear, {}, sparse)
+    dtype = np.float32 if obj.get("bias_type") == "float32" else np.float64
+
+    return make_BinaryQuadraticModel(mock_linear, {}, sparse, dtype)
 
 
 def BinaryQuadraticModel(linear, quadratic, *args, **kwargs):
     sparse_option = kwargs.pop("sparse", False)
-    Model = make_BinaryQuadraticModel(linear, quadratic, sparse_option)
+    dtype_option = kwargs.pop("dtype", np.float64)
+    Model = make_BinaryQuadraticModel(linear, quadratic, sparse_option, dtype_option)
 
     # offset and vartype
     offset, vartype = extract_offset_and_vartype(*args, **kwargs)
@@ -422,9 +639,10 @@ def bqm_from_numpy_matrix(
         variables = list(range(num_variables))
 
     sparse_option = kwargs.pop("sparse", False)
+    dtype_option = kwargs.pop("dtype", np.float64)
 
     return make_BinaryQuadraticModel(
-        {variables[0]: 1.0}, {}, sparse_option
+        {variables[0]: 1.0}, {}, sparse_option, dtype_option
     ).from_numpy_matrix(mat, variables, offset, vartype, True, **kwargs)
 
 
@@ -433,8 +651,9 @@ BinaryQuadraticModel.from_numpy_matrix = bqm_from_numpy_matrix
 
 def bqm_from_qubo(Q, offset=0.0, **kwargs):
     sparse_option = kwargs.pop("sparse", False)
+    dtype_option = kwargs.pop("dtype", np.float64)
 
-    return make_BinaryQuadraticModel({}, Q, sparse_option).from_qubo(
+    return make_BinaryQuadraticModel({}, Q, sparse_option, dtype_option).from_qubo(
         Q, offset, **kwargs
     )
 
@@ -444,10 +663,11 @@ BinaryQuadraticModel.from_qubo = bqm_from_qubo
 
 def bqm_from_ising(linear, quadratic, offset=0.0, **kwargs):
     sparse_option = kwargs.pop("sparse", False)
+    dtype_option = kwargs.pop("dtype", np.float64)
 
-    return make_BinaryQuadraticModel(linear, quadratic, sparse_option).from_ising(
-        linear, quadratic, offset, **kwargs
-    )
+    return make_BinaryQuadraticModel(
+        linear, quadratic, sparse_option, dtype_option
+    ).from_ising(linear, quadratic, offset, **kwargs)
 
 
 BinaryQuadraticModel.from_ising = bqm_from_ising
@@ -458,3 +678,21 @@ BinaryQuadraticModel.from_serializable = (
         obj, **kwargs
     )
 )
+
+
+# text formats (integer labels)
+
+
+def bqm_read_text(reader):
+    def read(path, *args, **kwargs):
+        sparse_option = kwargs.pop("sparse", False)
+        dtype_option = kwargs.pop("dtype", np.float64)
+        Model = make_BinaryQuadraticModel({0: 1.0}, {}, sparse_option, dtype_option)
+        return getattr(Model, reader)(path, *args, **kwargs)
+
+    return read
+
+
+BinaryQuadraticModel.read_qubo = bqm_read_text("read_qubo")
+BinaryQuadraticModel.read_coo = bqm_read_text("read_coo")
+BinaryQuadraticModel.read_bqpjson = bqm_read_text("read_bqpjson")
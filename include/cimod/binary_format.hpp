@@ -0,0 +1,824 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+/**
+ * @file binary_format.hpp
+ * @brief Compact binary file format of binary quadratic and polynomial models.
+ *
+ * All values are stored in little-endian byte order. A file consists of
+ *
+ * - a fixed-size header (BinaryHeader),
+ * - the labels in the order of the variable indices used by the payload,
+ * - the payload; every array starts at an offset aligned to 8 bytes.
+ *
+ * Payloads:
+ *
+ * - PACKED: linear biases (N) and the strictly upper triangle of the interaction matrix in column-major order
+ *   (J_ij for i < j is at j(j-1)/2 + i).
+ * - CSR: linear biases (N), row pointers (uint64, N+1), column indices (uint32, nnz) and quadratic biases (nnz) of the
+ *   strictly upper triangle.
+ * - POLYNOMIAL: key pointers (uint64, M+1), variable indices of the keys (uint32) and polynomial biases (M).
+ *
+ * On little-endian hosts BinaryReader maps the file into memory, so arrays of matching type are used in place without
+ * copying.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined( _WIN32 )
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "cimod/vartypes.hpp"
+
+namespace cimod {
+
+  /**
+   * @brief Kind of the payload of a binary file
+   */
+  enum class BinaryPayload : uint32_t {
+    PACKED = 0,
+    CSR = 1,
+    POLYNOMIAL = 2,
+  };
+
+  /**
+   * @brief Header of a binary file
+   */
+  struct BinaryHeader {
+    /**
+     * @brief magic string of the format
+     */
+    static constexpr char magic[ 8 ] = { 'C', 'I', 'M', 'O', 'D', 'B', 'I', 'N' };
+
+    /**
+     * @brief current version of the format
+     */
+    static constexpr uint32_t current_version = 1;
+
+    uint32_t version = current_version;
+    BinaryPayload payload = BinaryPayload::PACKED;
+    /**
+     * @brief size of the floating point type of the biases (4 or 8)
+     */
+    uint32_t float_size = 8;
+    Vartype vartype = Vartype::NONE;
+    /**
+     * @brief 0: integer, 1: string, 2: tuple of integers
+     */
+    uint32_t label_kind = 0;
+    /**
+     * @brief number of integers of a tuple label
+     */
+    uint32_t label_arity = 1;
+    uint64_t num_variables = 0;
+    /**
+     * @brief number of stored interactions (CSR, POLYNOMIAL) or length of the upper triangle (PACKED)
+     */
+    uint64_t num_interactions = 0;
+    double offset = 0.0;
+  };
+
+  /**
+   * @brief Arrays of a quadratic payload. The pointers are valid while the BinaryReader is alive.
+   *
+   * @tparam FloatType
+   */
+  template<typename FloatType>
+  struct BinaryQuadraticPayload {
+    BinaryPayload kind = BinaryPayload::PACKED;
+    size_t num_variables = 0;
+    size_t num_interactions = 0;
+    const FloatType *linear = nullptr;
+    /**
+     * @brief packed upper triangle (PACKED)
+     */
+    const FloatType *upper = nullptr;
+    /**
+     * @brief row pointers (CSR)
+     */
+    const uint64_t *row_ptr = nullptr;
+    /**
+     * @brief column indices (CSR)
+     */
+    const uint32_t *col_idx = nullptr;
+    /**
+     * @brief quadratic biases (CSR)
+     */
+    const FloatType *values = nullptr;
+
+    /**
+     * @brief call f(i, j, bias) for each non-zero interaction with i < j
+     *
+     * @tparam F
+     * @param f
+     */
+    template<typename F>
+    void for_each_interaction( F &&f ) const {
+      if ( kind == BinaryPayload::PACKED ) {
+        for ( size_t j = 1; j < num_variables; j++ ) {
+          const FloatType *column = upper + j * ( j - 1 ) / 2;
+          for ( size_t i = 0; i < j; i++ ) {
+            if ( column[ i ] != 0 ) {
+              f( i, j, column[ i ] );
+            }
+          }
+        }
+      } else {
+        for ( size_t i = 0; i < num_variables; i++ ) {
+          for ( uint64_t p = row_ptr[ i ]; p < row_ptr[ i + 1 ]; p++ ) {
+            f( i, static_cast<size_t>( col_idx[ p ] ), values[ p ] );
+          }
+        }
+      }
+    }
+  };
+
+  /**
+   * @brief Arrays of a polynomial payload. The pointers are valid while the BinaryReader is alive.
+   *
+   * @tparam FloatType
+   */
+  template<typename FloatType>
+  struct BinaryPolynomialPayload {
+    size_t num_variables = 0;
+    size_t num_interactions = 0;
+    /**
+     * @brief the key of interaction k is key_idx[key_ptr[k]:key_ptr[k+1]]
+     */
+    const uint64_t *key_ptr = nullptr;
+    /**
+     * @brief variable indices of the keys
+     */
+    const uint32_t *key_idx = nullptr;
+    /**
+     * @brief polynomial biases
+     */
+    const FloatType *values = nullptr;
+  };
+
+  namespace binary_format_detail {
+    inline bool is_little_endian() {
+      const uint16_t one = 1;
+      unsigned char byte;
+      std::memcpy( &byte, &one, 1 );
+      return byte == 1;
+    }
+
+    template<typename T>
+    inline T byte_swap( T value ) {
+      unsigned char bytes[ sizeof( T ) ];
+      std::memcpy( bytes, &value, sizeof( T ) );
+      for ( size_t k = 0; k < sizeof( T ) / 2; k++ ) {
+        std::swap( bytes[ k ], bytes[ sizeof( T ) - 1 - k ] );
+      }
+      std::memcpy( &value, bytes, sizeof( T ) );
+      return value;
+    }
+
+    template<typename T>
+    struct is_integer_tuple : std::false_type { };
+
+    template<typename... Ts>
+    struct is_integer_tuple<std::tuple<Ts...>> : std::conjunction<std::is_integral<Ts>...> { };
+
+    /**
+     * @brief kind and arity of the label type in BinaryHeader
+     */
+    template<typename IndexType>
+    inline std::pair<uint32_t, uint32_t> label_kind() {
+      if constexpr ( std::is_integral_v<IndexType> ) {
+        return { 0, 1 };
+      } else if constexpr ( std::is_same_v<IndexType, std::string> ) {
+        return { 1, 1 };
+      } else if constexpr ( is_integer_tuple<IndexType>::value ) {
+        return { 2, std::tuple_size_v<IndexType> };
+      } else {
+        static_assert( is_integer_tuple<IndexType>::value, "label type is not supported by the binary format." );
+        return { 0, 0 };
+      }
+    }
+  } // namespace binary_format_detail
+
+  /**
+   * @brief Writer of the binary format
+   */
+  class BinaryWriter {
+  private:
+    std::ofstream m_ofs;
+    uint64_t m_position = 0;
+
+    template<typename T>
+    void _write_value( T value ) {
+      if ( !binary_format_detail::is_little_endian() ) {
+        value = binary_format_detail::byte_swap( value );
+      }
+      m_ofs.write( reinterpret_cast<const char *>( &value ), sizeof( T ) );
+      m_position += sizeof( T );
+    }
+
+  public:
+    /**
+     * @brief BinaryWriter constructor.
+     *
+     * @param path
+     */
+    explicit BinaryWriter( const std::string &path ) : m_ofs( path, std::ios::binary | std::ios::trunc ) {
+      if ( !m_ofs ) {
+        throw std::runtime_error( "cannot open " + path + " for writing." );
+      }
+    }
+
+    /**
+     * @brief write the header
+     *
+     * @param header
+     */
+    void write_header( const BinaryHeader &header ) {
+      m_ofs.write( BinaryHeader::magic, sizeof( BinaryHeader::magic ) );
+      m_position += sizeof( BinaryHeader::magic );
+      _write_value( header.version );
+      _write_value( static_cast<uint32_t>( header.payload ) );
+      _write_value( header.float_size );
+      _write_value( static_cast<int32_t>( header.vartype ) );
+      _write_value( header.label_kind );
+      _write_value( header.label_arity );
+      _write_value( header.num_variables );
+      _write_value( header.num_interactions );
+      _write_value( header.offset );
+    }
+
+    /**
+     * @brief write an array of arithmetic values
+     *
+     * @tparam T
+     * @param data
+     * @param size
+     */
+    template<typename T>
+    void write_array( const T *data, size_t size ) {
+      static_assert( std::is_arithmetic_v<T>, "T must be an arithmetic type." );
+      if ( binary_format_detail::is_little_endian() ) {
+        m_ofs.write( reinterpret_cast<const char *>( data ), sizeof( T ) * size );
+        m_position += sizeof( T ) * size;
+      } else {
+        for ( size_t k = 0; k < size; k++ ) {
+          _write_value( data[ k ] );
+        }
+      }
+    }
+
+    /**
+     * @brief pad the stream with zeros to a multiple of 8 bytes
+     */
+    void align() {
+      const char zeros[ 8 ] = {};
+      const size_t padding = ( 8 - m_position % 8 ) % 8;
+      m_ofs.write( zeros, padding );
+      m_position += padding;
+    }
+
+    /**
+     * @brief write labels
+     *
+     * @tparam IndexType
+     * @param labels
+     */
+    template<typename IndexType>
+    void write_labels( const std::vector<IndexType> &labels ) {
+      if constexpr ( std::is_integral_v<IndexType> ) {
+        for ( const auto &it : labels ) {
+          _write_value( static_cast<int64_t>( it ) );
+        }
+      } else if constexpr ( std::is_same_v<IndexType, std::string> ) {
+        uint64_t position = 0;
+        _write_value( position );
+        for ( const auto &it : labels ) {
+          position += it.size();
+          _write_value( position );
+        }
+        for ( const auto &it : labels ) {
+          m_ofs.write( it.data(), it.size() );
+          m_position += it.size();
+        }
+      } else {
+        binary_format_detail::label_kind<IndexType>();
+        for ( const auto &it : labels ) {
+          std::apply( [ this ]( const auto &...args ) { ( _write_value( static_cast<int64_t>( args ) ), ... ); }, it );
+        }
+      }
+      align();
+    }
+
+    /**
+     * @brief flush the stream and check errors
+     */
+    void close() {
+      m_ofs.close();
+      if ( !m_ofs ) {
+        throw std::runtime_error( "failed to write the binary file." );
+      }
+    }
+  };
+
+  /**
+   * @brief Reader of the binary format.
+   * The file is mapped into memory (read into a buffer on Windows); arrays are returned as pointers into the mapping if
+   * their stored type matches the requested type, and converted into buffers owned by the reader otherwise.
+   */
+  class BinaryReader {
+  private:
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_position = 0;
+    BinaryHeader m_header;
+    std::vector<std::vector<char>> m_buffers;
+#if defined( _WIN32 )
+    std::vector<char> m_file;
+#else
+    void *m_map = nullptr;
+#endif
+
+    const char *_take( size_t size ) {
+      if ( size > m_size - m_position ) {
+        throw std::runtime_error( "unexpected end of the binary file." );
+      }
+      const char *ptr = m_data + m_position;
+      m_position += size;
+      return ptr;
+    }
+
+    /**
+     * @brief check that count elements of element_size bytes fit in the rest of the file, without overflow
+     */
+    void _check_count( uint64_t count, size_t element_size ) const {
+      if ( count > ( m_size - m_position ) / element_size ) {
+        throw std::runtime_error( "unexpected end of the binary file." );
+      }
+    }
+
+    template<typename T>
+    T _read_value() {
+      T value;
+      std::memcpy( &value, _take( sizeof( T ) ), sizeof( T ) );
+      if ( !binary_format_detail::is_little_endian() ) {
+        value = binary_format_detail::byte_swap( value );
+      }
+      return value;
+    }
+
+    template<typename T>
+    T *_new_buffer( size_t size ) {
+      m_buffers.emplace_back( sizeof( T ) * size );
+      return reinterpret_cast<T *>( m_buffers.back().data() );
+    }
+
+    template<typename T, typename Stored>
+    const T *_read_converted( size_t size ) {
+      _check_count( size, sizeof( Stored ) );
+      const char *src = _take( sizeof( Stored ) * size );
+      T *dst = _new_buffer<T>( size );
+      for ( size_t k = 0; k < size; k++ ) {
+        Stored value;
+        std::memcpy( &value, src + sizeof( Stored ) * k, sizeof( Stored ) );
+        if ( !binary_format_detail::is_little_endian() ) {
+          value = binary_format_detail::byte_swap( value );
+        }
+        dst[ k ] = static_cast<T>( value );
+      }
+      return dst;
+    }
+
+    void _read_header() {
+      if ( std::memcmp( _take( sizeof( BinaryHeader::magic ) ), BinaryHeader::magic, sizeof( BinaryHeader::magic ) ) != 0 ) {
+        throw std::runtime_error( "the file is not a cimod binary file." );
+      }
+      m_header.version = _read_value<uint32_t>();
+      if ( m_header.version > BinaryHeader::current_version ) {
+        throw std::runtime_error( "unsupported version of the binary file." );
+      }
+      m_header.payload = static_cast<BinaryPayload>( _read_value<uint32_t>() );
+      m_header.float_size = _read_value<uint32_t>();
+      if ( m_header.float_size != 4 && m_header.float_size != 8 ) {
+        throw std::runtime_error( "unsupported bias type of the binary file." );
+      }
+      m_header.vartype = static_cast<Vartype>( _read_value<int32_t>() );
+      if ( m_header.vartype != Vartype::SPIN && m_header.vartype != Vartype::BINARY ) {
+        throw std::runtime_error( "Variable type must be SPIN or BINARY." );
+      }
+      m_header.label_kind = _read_value<uint32_t>();
+      m_header.label_arity = _read_value<uint32_t>();
+      m_header.num_variables = _read_value<uint64_t>();
+      m_header.num_interactions = _read_value<uint64_t>();
+      m_header.offset = _read_value<double>();
+      // every variable and interaction has a bias stored in the rest of the file
+      _check_count( m_header.num_variables, m_header.float_size );
+      _check_count( m_header.num_interactions, m_header.float_size );
+    }
+
+  public:
+    /**
+     * @brief BinaryReader constructor.
+     *
+     * @param path
+     */
+    explicit BinaryReader( const std::string &path ) {
+#if defined( _WIN32 )
+      std::ifstream ifs( path, std::ios::binary );
+      if ( !ifs ) {
+        throw std::runtime_error( "cannot open " + path + "." );
+      }
+      m_file.assign( std::istreambuf_iterator<char>( ifs ), std::istreambuf_iterator<char>() );
+      m_data = m_file.data();
+      m_size = m_file.size();
+#else
+      int fd = ::open( path.c_str(), O_RDONLY );
+      if ( fd < 0 ) {
+        throw std::runtime_error( "cannot open " + path + "." );
+      }
+      struct stat st;
+      if ( ::fstat( fd, &st ) != 0 ) {
+        ::close( fd );
+        throw std::runtime_error( "cannot stat " + path + "." );
+      }
+      m_size = static_cast<size_t>( st.st_size );
+      if ( m_size > 0 ) {
+        m_map = ::mmap( nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      }
+      ::close( fd );
+      if ( m_map == MAP_FAILED ) {
+        m_map = nullptr;
+        throw std::runtime_error( "cannot map " + path + " into memory." );
+      }
+      m_data = static_cast<const char *>( m_map );
+#endif
+      _read_header();
+    }
+
+    BinaryReader( const BinaryReader & ) = delete;
+    BinaryReader &operator=( const BinaryReader & ) = delete;
+
+    ~BinaryReader() {
+#if !defined( _WIN32 )
+      if ( m_map != nullptr ) {
+        ::munmap( m_map, m_size );
+      }
+#endif
+    }
+
+    /**
+     * @brief Get the header
+     *
+     * @return header
+     */
+    const BinaryHeader &header() const {
+      return m_header;
+    }
+
+    /**
+     * @brief skip to the next offset aligned to 8 bytes
+     */
+    void align() {
+      _take( ( 8 - m_position % 8 ) % 8 );
+    }
+
+    /**
+     * @brief read an array of integers stored as Stored
+     *
+     * @tparam T requested type
+     * @tparam Stored stored type
+     * @param size
+     *
+     * @return pointer to the array
+     */
+    template<typename T, typename Stored = T>
+    const T *read_array( size_t size ) {
+      _check_count( size, sizeof( Stored ) );
+      if constexpr ( std::is_same_v<T, Stored> ) {
+        if ( binary_format_detail::is_little_endian() && m_position % alignof( T ) == 0 ) {
+          return reinterpret_cast<const T *>( _take( sizeof( T ) * size ) );
+        }
+      }
+      return _read_converted<T, Stored>( size );
+    }
+
+    /**
+     * @brief read an array of biases stored with the bias type of the file
+     *
+     * @tparam FloatType requested type
+     * @param size
+     *
+     * @return pointer to the array
+     */
+    template<typename FloatType>
+    const FloatType *read_biases( size_t size ) {
+      if ( m_header.float_size == 4 ) {
+        return read_array<FloatType, float>( size );
+      }
+      return read_array<FloatType, double>( size );
+    }
+
+    /**
+     * @brief read labels
+     *
+     * @tparam IndexType
+     *
+     * @return labels
+     */
+    template<typename IndexType>
+    std::vector<IndexType> read_labels() {
+      const auto kind = binary_format_detail::label_kind<IndexType>();
+      if ( kind.first != m_header.label_kind || kind.second != m_header.label_arity ) {
+        throw std::runtime_error( "the label type of the binary file does not match." );
+      }
+      const size_t num_variables = m_header.num_variables;
+      // every label takes at least 8 bytes
+      _check_count( num_variables, sizeof( int64_t ) );
+      std::vector<IndexType> labels;
+      labels.reserve( num_variables );
+      if constexpr ( std::is_integral_v<IndexType> ) {
+        for ( size_t i = 0; i < num_variables; i++ ) {
+          labels.push_back( static_cast<IndexType>( _read_value<int64_t>() ) );
+        }
+      } else if constexpr ( std::is_same_v<IndexType, std::string> ) {
+        std::vector<uint64_t> positions( num_variables + 1 );
+        for ( auto &it : positions ) {
+          it = _read_value<uint64_t>();
+        }
+        const char *chars = _take( positions.back() );
+        for ( size_t i = 0; i < num_variables; i++ ) {
+          if ( positions[ i ] > positions[ i + 1 ] ) {
+            throw std::runtime_error( "broken labels in the binary file." );
+          }
+          labels.emplace_back( chars + positions[ i ], positions[ i + 1 ] - positions[ i ] );
+        }
+      } else {
+        for ( size_t i = 0; i < num_variables; i++ ) {
+          IndexType label;
+          std::apply(
+              [ this ]( auto &...args ) {
+                ( ( args = static_cast<std::decay_t<decltype( args )>>( _read_value<int64_t>() ) ), ... );
+              },
+              label );
+          labels.push_back( label );
+        }
+      }
+      align();
+      return labels;
+    }
+
+    /**
+     * @brief read a quadratic payload (PACKED or CSR)
+     *
+     * @tparam FloatType
+     *
+     * @return payload
+     */
+    template<typename FloatType>
+    BinaryQuadraticPayload<FloatType> read_quadratic_payload() {
+      BinaryQuadraticPayload<FloatType> payload;
+      payload.kind = m_header.payload;
+      payload.num_variables = m_header.num_variables;
+      payload.num_interactions = m_header.num_interactions;
+      const size_t N = payload.num_variables;
+      payload.linear = read_biases<FloatType>( N );
+      align();
+      if ( payload.kind == BinaryPayload::PACKED ) {
+        // N * ( N - 1 ) / 2 cannot overflow, since num_interactions is bounded by the file size
+        if ( N > ( uint64_t( 1 ) << 32 ) || payload.num_interactions != N * ( N - 1 ) / 2 ) {
+          throw std::runtime_error( "broken payload in the binary file." );
+        }
+        payload.upper = read_biases<FloatType>( payload.num_interactions );
+      } else if ( payload.kind == BinaryPayload::CSR ) {
+        payload.row_ptr = read_array<uint64_t>( N + 1 );
+        payload.col_idx = read_array<uint32_t>( payload.num_interactions );
+        align();
+        payload.values = read_biases<FloatType>( payload.num_interactions );
+        if ( payload.row_ptr[ 0 ] != 0 || payload.row_ptr[ N ] != payload.num_interactions ) {
+          throw std::runtime_error( "broken payload in the binary file." );
+        }
+        for ( size_t i = 0; i < N; i++ ) {
+          if ( payload.row_ptr[ i ] > payload.row_ptr[ i + 1 ] ) {
+            throw std::runtime_error( "broken payload in the binary file." );
+          }
+          for ( uint64_t p = payload.row_ptr[ i ]; p < payload.row_ptr[ i + 1 ]; p++ ) {
+            // the columns of a row are strictly increasing, so that an interaction is stored only once
+            if ( payload.col_idx[ p ] <= i || payload.col_idx[ p ] >= N
+                 || ( p > payload.row_ptr[ i ] && payload.col_idx[ p ] <= payload.col_idx[ p - 1 ] ) ) {
+              throw std::runtime_error( "broken payload in the binary file." );
+            }
+          }
+        }
+      } else {
+        throw std::runtime_error( "the binary file does not contain a binary quadratic model." );
+      }
+      return payload;
+    }
+
+    /**
+     * @brief read a polynomial payload
+     *
+     * @tparam FloatType
+     *
+     * @return payload
+     */
+    template<typename FloatType>
+    BinaryPolynomialPayload<FloatType> read_polynomial_payload() {
+      if ( m_header.payload != BinaryPayload::POLYNOMIAL ) {
+        throw std::runtime_error( "the binary file does not contain a binary polynomial model." );
+      }
+      BinaryPolynomialPayload<FloatType> payload;
+      payload.num_variables = m_header.num_variables;
+      payload.num_interactions = m_header.num_interactions;
+      const size_t M = payload.num_interactions;
+      payload.key_ptr = read_array<uint64_t>( M + 1 );
+      if ( payload.key_ptr[ 0 ] != 0 ) {
+        throw std::runtime_error( "broken payload in the binary file." );
+      }
+      for ( size_t k = 0; k < M; k++ ) {
+        if ( payload.key_ptr[ k ] > payload.key_ptr[ k + 1 ] ) {
+          throw std::runtime_error( "broken payload in the binary file." );
+        }
+      }
+      _check_count( payload.key_ptr[ M ], sizeof( uint32_t ) );
+      payload.key_idx = read_array<uint32_t>( payload.key_ptr[ M ] );
+      for ( uint64_t p = 0; p < payload.key_ptr[ M ]; p++ ) {
+        if ( payload.key_idx[ p ] >= payload.num_variables ) {
+          throw std::runtime_error( "broken payload in the binary file." );
+        }
+      }
+      align();
+      payload.values = read_biases<FloatType>( M );
+      return payload;
+    }
+  };
+
+  /**
+   * @brief Create the header of a binary file
+   *
+   * @tparam IndexType
+   * @tparam FloatType
+   * @param payload
+   * @param vartype
+   * @param num_variables
+   * @param num_interactions
+   * @param offset
+   *
+   * @return header
+   */
+  template<typename IndexType, typename FloatType>
+  inline BinaryHeader make_binary_header(
+      BinaryPayload payload,
+      Vartype vartype,
+      size_t num_variables,
+      size_t num_interactions,
+      double offset ) {
+    static_assert( sizeof( FloatType ) == 4 || sizeof( FloatType ) == 8, "FloatType must be float or double." );
+    BinaryHeader header;
+    header.payload = payload;
+    header.float_size = sizeof( FloatType );
+    header.vartype = vartype;
+    std::tie( header.label_kind, header.label_arity ) = binary_format_detail::label_kind<IndexType>();
+    header.num_variables = num_variables;
+    header.num_interactions = num_interactions;
+    header.offset = offset;
+    return header;
+  }
+
+  /**
+   * @brief Write a binary quadratic model in the CSR payload.
+   * The rows of the strictly upper triangle are given as (column, bias) pairs sorted by column.
+   *
+   * @tparam IndexType
+   * @tparam FloatType
+   * @param path
+   * @param labels
+   * @param linear
+   * @param rows
+   * @param offset
+   * @param vartype
+   */
+  template<typename IndexType, typename FloatType>
+  inline void write_binary_csr(
+      const std::string &path,
+      const std::vector<IndexType> &labels,
+      const std::vector<FloatType> &linear,
+      const std::vector<std::vector<std::pair<uint32_t, FloatType>>> &rows,
+      double offset,
+      Vartype vartype ) {
+    const size_t N = labels.size();
+    std::vector<uint64_t> row_ptr( N + 1, 0 );
+    for ( size_t i = 0; i < N; i++ ) {
+      row_ptr[ i + 1 ] = row_ptr[ i ] + rows[ i ].size();
+    }
+    std::vector<uint32_t> col_idx;
+    std::vector<FloatType> values;
+    col_idx.reserve( row_ptr[ N ] );
+    values.reserve( row_ptr[ N ] );
+    for ( const auto &row : rows ) {
+      for ( const auto &it : row ) {
+        col_idx.push_back( it.first );
+        values.push_back( it.second );
+      }
+    }
+
+    BinaryWriter writer( path );
+    writer.write_header( make_binary_header<IndexType, FloatType>( BinaryPayload::CSR, vartype, N, row_ptr[ N ], offset ) );
+    writer.write_labels( labels );
+    writer.write_array( linear.data(), N );
+    writer.align();
+    writer.write_array( row_ptr.data(), N + 1 );
+    writer.write_array( col_idx.data(), col_idx.size() );
+    writer.align();
+    writer.write_array( values.data(), values.size() );
+    writer.close();
+  }
+
+  /**
+   * @brief Write a binary quadratic model in the PACKED payload.
+   *
+   * @tparam IndexType
+   * @tparam FloatType
+   * @param path
+   * @param labels
+   * @param linear
+   * @param upper strictly upper triangle in column-major order (N(N-1)/2 elements)
+   * @param offset
+   * @param vartype
+   */
+  template<typename IndexType, typename FloatType>
+  inline void write_binary_packed(
+      const std::string &path,
+      const std::vector<IndexType> &labels,
+      const FloatType *linear,
+      const FloatType *upper,
+      double offset,
+      Vartype vartype ) {
+    const size_t N = labels.size();
+    const size_t num_upper = N * ( N - 1 ) / 2;
+    BinaryWriter writer( path );
+    writer.write_header( make_binary_header<IndexType, FloatType>( BinaryPayload::PACKED, vartype, N, num_upper, offset ) );
+    writer.write_labels( labels );
+    writer.write_array( linear, N );
+    writer.align();
+    writer.write_array( upper, num_upper );
+    writer.close();
+  }
+
+  /**
+   * @brief Write a binary polynomial model in the POLYNOMIAL payload.
+   *
+   * @tparam IndexType
+   * @tparam FloatType
+   * @param path
+   * @param labels
+   * @param key_ptr the key of interaction k is key_idx[key_ptr[k]:key_ptr[k+1]]
+   * @param key_idx
+   * @param values
+   * @param vartype
+   */
+  template<typename IndexType, typename FloatType>
+  inline void write_binary_polynomial(
+      const std::string &path,
+      const std::vector<IndexType> &labels,
+      const std::vector<uint64_t> &key_ptr,
+      const std::vector<uint32_t> &key_idx,
+      const std::vector<FloatType> &values,
+      Vartype vartype ) {
+    BinaryWriter writer( path );
+    writer.write_header(
+        make_binary_header<IndexType, FloatType>( BinaryPayload::POLYNOMIAL, vartype, labels.size(), values.size(), 0.0 ) );
+    writer.write_labels( labels );
+    writer.write_array( key_ptr.data(), key_ptr.size() );
+    writer.write_array( key_idx.data(), key_idx.size() );
+    writer.align();
+    writer.write_array( values.data(), values.size() );
+    writer.close();
+  }
+} // namespace cimod
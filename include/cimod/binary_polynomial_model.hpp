@@ -123,6 +123,7 @@
 #include <set>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <typeinfo>
 #include <unordered_map>
 #include <unordered_set>
@@ -131,6 +132,8 @@
 
 #include <nlohmann/json.hpp>
 
+#include "cimod/binary_format.hpp"
+#include "cimod/flat_hash_map.hpp"
 #include "cimod/hash.hpp"
 #include "cimod/utilities.hpp"
 #include "cimod/vartypes.hpp"
@@ -138,11 +141,12 @@
 
 namespace cimod {
 
-  //! @brief Type alias for the polynomial interactions as std::unordered_map.
+  //! @brief Type alias for the polynomial interactions as std::unordered_map
+  //! (FlatHashMap if CIMOD_USE_FLAT_HASH_MAP is defined).
   //! @tparam IndexType
   //! @tparam FloatType
   template<typename IndexType, typename FloatType>
-  using Polynomial = std::unordered_map<std::vector<IndexType>, FloatType, vector_hash>;
+  using Polynomial = HashMap<std::vector<IndexType>, FloatType, vector_hash>;
 
   //! @brief Type alias for the indices of the polynomial interactions (namely, the list of keys of the polynomial
   //! interactions as std::unordered_map) as std::vector<std::vector>>.
@@ -360,7 +364,7 @@ namespace cimod {
 
     //! @brief Get The inverse key list, which indicates the index of the poly_key_list_ and poly_value_list_.
     //! @return The inverse key list.
-    const std::unordered_map<std::vector<IndexType>, std::size_t, vector_hash> &GetKeysInv() const {
+    const HashMap<std::vector<IndexType>, std::size_t, vector_hash> &GetKeysInv() const {
       return poly_key_inv_;
     }
 
@@ -628,7 +632,7 @@ namespace cimod {
       }
 
       std::size_t num_interactions = GetNumInteractions();
-      FloatType val = 0.0;
+      AccumulateType<FloatType> val = 0.0;
 
       if ( omp_flag ) {
 #pragma omp parallel for reduction( + : val )
@@ -654,7 +658,7 @@ namespace cimod {
           val += spin_multiple * poly_value_list_[ i ];
         }
       }
-      return val;
+      return static_cast<FloatType>( val );
     }
 
     //! @brief Determine the energy of the specified sample_vec (as std::vector) of the BinaryPolynomialModel.
@@ -676,7 +680,7 @@ namespace cimod {
       }
 
       std::size_t num_interactions = GetNumInteractions();
-      FloatType val = 0.0;
+      AccumulateType<FloatType> val = 0.0;
 
       if ( omp_flag ) {
 #pragma omp parallel for reduction( + : val )
@@ -702,7 +706,7 @@ namespace cimod {
           val += spin_multiple * poly_value_list_[ i ];
         }
       }
-      return val;
+      return static_cast<FloatType>( val );
     }
 
     //! @brief Determine the energies of the given samples.
@@ -729,6 +733,49 @@ namespace cimod {
       return val_list;
     }
 
+    //! @brief Determine the energies of the samples stored in a contiguous array.
+    //! @details The array is a row-major (num_samples x num_variables) matrix whose columns follow the order of the
+    //! sorted variables. The keys are converted into column indices once, and the samples are evaluated in parallel.
+    //! @tparam SampleType integer type of the samples (e.g. int8_t, int32_t)
+    //! @param samples pointer to the first element of the array
+    //! @param num_samples
+    //! @return Energies with respect to the samples as std::vector
+    template<typename SampleType>
+    PolynomialValueList<FloatType> Energies( const SampleType *samples, std::size_t num_samples ) const {
+      static_assert( std::is_integral_v<SampleType>, "SampleType must be an integer type." );
+      const std::unordered_map<IndexType, int64_t> variables_to_integers = GenerateVariablesToIntegers();
+      const std::size_t num_variables = variables_to_integers.size();
+      const std::size_t num_interactions = GetNumInteractions();
+
+      std::vector<std::size_t> key_ptr( num_interactions + 1, 0 );
+      std::vector<int64_t> key_col;
+      for ( std::size_t i = 0; i < num_interactions; ++i ) {
+        for ( const auto &index : poly_key_list_[ i ] ) {
+          key_col.push_back( variables_to_integers.at( index ) );
+        }
+        key_ptr[ i + 1 ] = key_col.size();
+      }
+
+      PolynomialValueList<FloatType> val_list( num_samples );
+#pragma omp parallel for
+      for ( int64_t k = 0; k < ( int64_t )num_samples; ++k ) {
+        const SampleType *row = samples + k * num_variables;
+        AccumulateType<FloatType> val = 0.0;
+        for ( std::size_t i = 0; i < num_interactions; ++i ) {
+          int32_t spin_multiple = 1;
+          for ( std::size_t p = key_ptr[ i ]; p < key_ptr[ i + 1 ]; ++p ) {
+            spin_multiple *= row[ key_col[ p ] ];
+            if ( spin_multiple == 0 ) {
+              break;
+            }
+          }
+          val += spin_multiple * poly_value_list_[ i ];
+        }
+        val_list[ k ] = static_cast<FloatType>( val );
+      }
+      return val_list;
+    }
+
     //! @brief Multiply by the specified scalar all the values of the interactions of the BinaryPolynomialModel.
     //! @param scalar
     //! @param ignored_interactions
@@ -843,7 +890,7 @@ namespace cimod {
       if ( vartype_ == Vartype::BINARY ) {
         return GetPolynomial();
       }
-      Polynomial<IndexType, FloatType> poly_map;
+      Polynomial<IndexType, AccumulateType<FloatType>> poly_map;
       std::size_t num_interactions = GetNumInteractions();
       for ( std::size_t i = 0; i < num_interactions; ++i ) {
         const std::vector<IndexType> &original_key = poly_key_list_[ i ];
@@ -854,14 +901,15 @@ namespace cimod {
         for ( std::size_t j = 0; j < changed_key_list_size; ++j ) {
           const auto changed_key = GenerateChangedKey( original_key, j );
           int sign = ( ( original_key_size - changed_key.size() ) % 2 == 0 ) ? 1.0 : -1.0;
-          FloatType changed_value = original_value * IntegerPower( 2, changed_key.size() ) * sign;
+          AccumulateType<FloatType> changed_value
+              = static_cast<AccumulateType<FloatType>>( original_value ) * IntegerPower( 2, changed_key.size() ) * sign;
           poly_map[ changed_key ] += changed_value;
           if ( poly_map[ changed_key ] == 0.0 ) {
             poly_map.erase( changed_key );
           }
         }
       }
-      return poly_map;
+      return ToFloatPolynomial( std::move( poly_map ) );
     }
 
     //! @brief Generate the polynomial interactions corresponding to the vartype being SPIN from the BinaryPolynomialModel.
@@ -870,14 +918,15 @@ namespace cimod {
       if ( vartype_ == Vartype::SPIN ) {
         return GetPolynomial();
       }
-      Polynomial<IndexType, FloatType> poly_map;
+      Polynomial<IndexType, AccumulateType<FloatType>> poly_map;
       const std::size_t num_interactions = GetNumInteractions();
       for ( std::size_t i = 0; i < num_interactions; ++i ) {
         const std::vector<IndexType> &original_key = poly_key_list_[ i ];
         const FloatType original_value = poly_value_list_[ i ];
         const std::size_t original_key_size = original_key.size();
         const std::size_t changed_key_list_size = IntegerPower( 2, original_key_size );
-        const FloatType changed_value = original_value * ( 1.0 / changed_key_list_size );
+        const AccumulateType<FloatType> changed_value
+            = static_cast<AccumulateType<FloatType>>( original_value ) / changed_key_list_size;
 
         for ( std::size_t j = 0; j < changed_key_list_size; ++j ) {
           const auto changed_key = GenerateChangedKey( original_key, j );
@@ -887,7 +936,7 @@ namespace cimod {
           }
         }
       }
-      return poly_map;
+      return ToFloatPolynomial( std::move( poly_map ) );
     }
 
     //! @brief Convert the BinaryPolynomialModel to a serializable object
@@ -947,6 +996,48 @@ namespace cimod {
           input[ "variables" ], input[ "poly_key_distance_list" ], input[ "poly_value_list" ], vartype );
     }
 
+    //! @brief Save the BinaryPolynomialModel to a file in the binary format (see binary_format.hpp).
+    //! @param path
+    void Save( const std::string &path ) const {
+      const std::size_t num_interactions = GetNumInteractions();
+      const std::vector<IndexType> sorted_variables = GetSortedVariables();
+      std::unordered_map<IndexType, uint32_t> variable_to_index;
+      variable_to_index.reserve( sorted_variables.size() );
+      for ( std::size_t i = 0; i < sorted_variables.size(); ++i ) {
+        variable_to_index[ sorted_variables[ i ] ] = static_cast<uint32_t>( i );
+      }
+
+      std::vector<uint64_t> key_ptr( num_interactions + 1, 0 );
+      std::vector<uint32_t> key_idx;
+      for ( std::size_t i = 0; i < num_interactions; ++i ) {
+        for ( const auto &it : poly_key_list_[ i ] ) {
+          key_idx.push_back( variable_to_index.at( it ) );
+        }
+        key_ptr[ i + 1 ] = key_idx.size();
+      }
+      write_binary_polynomial( path, sorted_variables, key_ptr, key_idx, poly_value_list_, vartype_ );
+    }
+
+    //! @brief Load a BinaryPolynomialModel from a file in the binary format.
+    //! @param path
+    //! @return BinaryPolynomialModel instance
+    static BinaryPolynomialModel Load( const std::string &path ) {
+      BinaryReader reader( path );
+      const std::vector<IndexType> variables = reader.read_labels<IndexType>();
+      const BinaryPolynomialPayload<FloatType> payload = reader.read_polynomial_payload<FloatType>();
+
+      PolynomialKeyList<std::size_t> poly_key_distance_list( payload.num_interactions );
+      for ( std::size_t i = 0; i < payload.num_interactions; ++i ) {
+        poly_key_distance_list[ i ].assign(
+            payload.key_idx + payload.key_ptr[ i ], payload.key_idx + payload.key_ptr[ i + 1 ] );
+      }
+      return BinaryPolynomialModel<IndexType, FloatType>(
+          variables,
+          poly_key_distance_list,
+          PolynomialValueList<FloatType>( payload.values, payload.values + payload.num_interactions ),
+          reader.header().vartype );
+    }
+
     //! @brief Create a BinaryPolynomialModel from a Hubo model.
     //! @param poly_map
     //! @return BinaryPolynomialModel instance with the vartype being BINARY.
@@ -1022,7 +1113,7 @@ namespace cimod {
     PolynomialValueList<FloatType> poly_value_list_;
 
     //! @brief The inverse key list, which indicates the index of the poly_key_list_ and poly_value_list_
-    std::unordered_map<std::vector<IndexType>, std::size_t, vector_hash> poly_key_inv_;
+    HashMap<std::vector<IndexType>, std::size_t, vector_hash> poly_key_inv_;
 
     //! @brief The model's type. SPIN or BINARY
     Vartype vartype_ = Vartype::NONE;
@@ -1063,6 +1154,27 @@ namespace cimod {
       return val;
     }
 
+    //! @brief Convert the polynomial interactions accumulated in AccumulateType to FloatType.
+    //! @details The interactions whose values become zero are removed.
+    //! @param acc_poly_map
+    //! @return The polynomial interaction as std::unordered_map.
+    Polynomial<IndexType, FloatType>
+    ToFloatPolynomial( Polynomial<IndexType, AccumulateType<FloatType>> acc_poly_map ) const {
+      if constexpr ( std::is_same_v<AccumulateType<FloatType>, FloatType> ) {
+        return acc_poly_map;
+      } else {
+        Polynomial<IndexType, FloatType> poly_map;
+        poly_map.reserve( acc_poly_map.size() );
+        for ( const auto &it : acc_poly_map ) {
+          const FloatType value = static_cast<FloatType>( it.second );
+          if ( value != 0.0 ) {
+            poly_map.emplace( it.first, value );
+          }
+        }
+        return poly_map;
+      }
+    }
+
     //! @brief Generate the num_of_key-th the key when the vartype is changed.
     //! @param original_key
     //! @param num_of_key
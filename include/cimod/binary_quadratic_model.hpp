@@ -78,11 +78,16 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdint>
+#include <exception>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <numeric>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -95,28 +100,33 @@
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
+#include "cimod/binary_format.hpp"
 #include "cimod/disable_eigen_warning.hpp"
+#include "cimod/flat_hash_map.hpp"
 #include "cimod/hash.hpp"
 #include "cimod/json.hpp"
+#include "cimod/label_table.hpp"
 #include "cimod/utilities.hpp"
 #include "cimod/vartypes.hpp"
 
 namespace cimod {
   /**
    * @brief Type alias for linear bias
+   * (std::unordered_map, or FlatHashMap if CIMOD_USE_FLAT_HASH_MAP is defined)
    *
    * @tparam IndexType
    */
   template<typename IndexType, typename FloatType>
-  using Linear = std::unordered_map<IndexType, FloatType>;
+  using Linear = HashMap<IndexType, FloatType>;
 
   /**
    * @brief Type alias for quadratic bias
+   * (std::unordered_map, or FlatHashMap if CIMOD_USE_FLAT_HASH_MAP is defined)
    *
    * @tparam IndexType
    */
   template<typename IndexType, typename FloatType>
-  using Quadratic = std::unordered_map<std::pair<IndexType, IndexType>, FloatType, pair_hash>;
+  using Quadratic = HashMap<std::pair<IndexType, IndexType>, FloatType, pair_hash>;
 
   /**
    * @brief Type alias for adjacency list
@@ -137,6 +147,250 @@ namespace cimod {
   struct Dense { };
   struct Sparse { };
 
+  template<typename IndexType, typename FloatType, typename DataType>
+  class BinaryQuadraticModel;
+
+  /**
+   * @brief Read-only view of a binary quadratic model in another vartype.
+   * The model is not copied. Samples given in the vartype of the view are mapped to the vartype of the model
+   * (\f$s = 2x - 1\f$ or \f$x = (s + 1) / 2\f$) and evaluated by the model, since the vartype conversion does not
+   * change the energy. The model must outlive the view.
+   *
+   * @tparam IndexType
+   * @tparam FloatType
+   * @tparam DataType
+   */
+  template<typename IndexType, typename FloatType, typename DataType>
+  class VartypeView {
+  public:
+    using BQM = BinaryQuadraticModel<IndexType, FloatType, DataType>;
+
+  private:
+    /**
+     * @brief viewed model
+     */
+    const BQM &m_bqm;
+
+    /**
+     * @brief The vartype of the view.
+     */
+    Vartype m_vartype;
+
+    /**
+     * @brief map a sample in the vartype of the view to the vartype of the model
+     *
+     * @param sample
+     *
+     * @return mapped sample
+     */
+    Sample<IndexType> _to_model_sample( const Sample<IndexType> &sample ) const {
+      Sample<IndexType> mapped = sample;
+      if ( m_bqm.get_vartype() == Vartype::SPIN && m_vartype == Vartype::BINARY ) {
+        for ( auto &it : mapped ) {
+          it.second = 2 * it.second - 1;
+        }
+      } else if ( m_bqm.get_vartype() == Vartype::BINARY && m_vartype == Vartype::SPIN ) {
+        for ( auto &it : mapped ) {
+          it.second = ( it.second + 1 ) / 2;
+        }
+      }
+      return mapped;
+    }
+
+  public:
+    /**
+     * @brief VartypeView constructor.
+     *
+     * @param bqm
+     * @param vartype
+     */
+    VartypeView( const BQM &bqm, const Vartype &vartype ) : m_bqm( bqm ), m_vartype( vartype ) {
+      if ( vartype == Vartype::NONE ) {
+        throw std::runtime_error( "Unknown vartype detected" );
+      }
+    }
+
+    /**
+     * @brief Get the vartype of the view.
+     *
+     * @return vartype
+     */
+    const Vartype &get_vartype() const {
+      return m_vartype;
+    }
+
+    /**
+     * @brief Determine the energy of the specified sample given in the vartype of the view.
+     *
+     * @param sample
+     * @return An energy with respect to the sample.
+     */
+    FloatType energy( const Sample<IndexType> &sample ) const {
+      if ( m_bqm.get_vartype() == m_vartype ) {
+        return m_bqm.energy( sample );
+      }
+      return m_bqm.energy( _to_model_sample( sample ) );
+    }
+
+    /**
+     * @brief Determine the energies of the given samples in the vartype of the view.
+     *
+     * @param samples_like
+     * @return A vector including energies with respect to the samples.
+     */
+    std::vector<FloatType> energies( const std::vector<Sample<IndexType>> &samples_like ) const {
+      if ( m_bqm.get_vartype() == m_vartype ) {
+        return m_bqm.energies( samples_like );
+      }
+      std::vector<Sample<IndexType>> mapped;
+      mapped.reserve( samples_like.size() );
+      for ( const auto &sample : samples_like ) {
+        mapped.push_back( _to_model_sample( sample ) );
+      }
+      return m_bqm.energies( mapped );
+    }
+  };
+
+  /**
+   * @brief Range of the neighbors of a variable of a binary quadratic model.
+   * The range walks over two strided segments of the interaction matrix (the column and the row of the variable)
+   * without copying them, and dereferencing an iterator gives a pair of the label of a neighbor and the quadratic bias.
+   * Zero biases are skipped. The range is invalidated by any change of the model.
+   *
+   * @tparam IndexType
+   * @tparam FloatType
+   */
+  template<typename IndexType, typename FloatType>
+  class NeighborRange {
+  public:
+    using StorageIndex = typename Eigen::SparseMatrix<FloatType, Eigen::RowMajor>::StorageIndex;
+
+    /**
+     * @brief strided run of biases; the index of the k-th element is index[k], or base + k if index is null.
+     */
+    struct Segment {
+      const StorageIndex *index = nullptr;
+      const FloatType *value = nullptr;
+      int64_t stride = 1;
+      int64_t size = 0;
+      int64_t base = 0;
+    };
+
+    class iterator {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = std::pair<IndexType, FloatType>;
+      using difference_type = std::ptrdiff_t;
+      using reference = std::pair<const IndexType &, FloatType>;
+      using pointer = void;
+
+      iterator() = default;
+
+      iterator( const IndexType *labels, const Segment &column, const Segment &row ) :
+          m_labels( labels ), m_segments{ column, row }, m_segment( 0 ) {
+        _skip_zeros();
+      }
+
+      reference operator*() const {
+        return reference( m_labels[ id() ], bias() );
+      }
+
+      /**
+       * @brief internal index (id) of the neighbor
+       */
+      size_t id() const {
+        const Segment &s = m_segments[ m_segment ];
+        return s.index ? static_cast<size_t>( s.index[ m_k ] ) : static_cast<size_t>( s.base + m_k );
+      }
+
+      /**
+       * @brief quadratic bias with the neighbor
+       */
+      FloatType bias() const {
+        const Segment &s = m_segments[ m_segment ];
+        return s.value[ m_k * s.stride ];
+      }
+
+      iterator &operator++() {
+        m_k++;
+        _skip_zeros();
+        return *this;
+      }
+
+      iterator operator++( int ) {
+        iterator copy = *this;
+        ++*this;
+        return copy;
+      }
+
+      bool operator==( const iterator &other ) const {
+        return m_segment == other.m_segment && m_k == other.m_k;
+      }
+
+      bool operator!=( const iterator &other ) const {
+        return !( *this == other );
+      }
+
+    private:
+      const IndexType *m_labels = nullptr;
+      Segment m_segments[ 2 ];
+      int m_segment = 2;
+      int64_t m_k = 0;
+
+      /**
+       * @brief move to the next nonzero bias, or to the end
+       */
+      void _skip_zeros() {
+        while ( m_segment < 2 ) {
+          const Segment &s = m_segments[ m_segment ];
+          while ( m_k < s.size && s.value[ m_k * s.stride ] == 0 ) {
+            m_k++;
+          }
+          if ( m_k < s.size ) {
+            return;
+          }
+          m_segment++;
+          m_k = 0;
+        }
+      }
+    };
+
+    /**
+     * @brief NeighborRange constructor
+     *
+     * @param labels labels of the internal indices
+     * @param column interactions with the variables of smaller indices
+     * @param row interactions with the variables of larger indices
+     */
+    NeighborRange( const IndexType *labels, const Segment &column, const Segment &row ) :
+        m_labels( labels ), m_segments{ column, row } { }
+
+    iterator begin() const {
+      return iterator( m_labels, m_segments[ 0 ], m_segments[ 1 ] );
+    }
+
+    iterator end() const {
+      return iterator();
+    }
+
+    /**
+     * @brief Get the number of neighbors (nonzero biases) in the range.
+     *
+     * @return number of neighbors
+     */
+    size_t size() const {
+      return std::distance( begin(), end() );
+    }
+
+    bool empty() const {
+      return begin() == end();
+    }
+
+  private:
+    const IndexType *m_labels;
+    Segment m_segments[ 2 ];
+  };
+
   /**
    * @brief Class for dense binary quadratic model.
    * @tparam IndexType index type. type must be hashable and comparable.
@@ -167,11 +421,27 @@ namespace cimod {
     using DenseMatrix = Eigen::Matrix<FloatType, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
     using SparseMatrix = Eigen::SparseMatrix<FloatType, Eigen::RowMajor>;
     using SpIter = typename SparseMatrix::InnerIterator;
+    using StorageIndex = typename SparseMatrix::StorageIndex;
 
     using Matrix = std::conditional_t<std::is_same_v<DataType, Dense>, DenseMatrix, SparseMatrix>;
 
     using Vector = Eigen::Matrix<FloatType, Eigen::Dynamic, 1>;
 
+    /**
+     * @brief column-major matrix of samples (one sample per row)
+     */
+    using SampleMatrix = Eigen::Matrix<FloatType, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>;
+
+    /**
+     * @brief type used to accumulate the biases (double for float models)
+     */
+    using AccType = AccumulateType<FloatType>;
+
+    /**
+     * @brief Eigen vector of AccType
+     */
+    using AccVector = Eigen::Matrix<AccType, Eigen::Dynamic, 1>;
+
   protected:
     /**
      * @brief quadratic dense-type matrix
@@ -186,12 +456,16 @@ namespace cimod {
      * 0 & 0 & \cdots & 0 & 1 \\
      * \end{pmatrix}
      * \f]
+     *
+     * The matrix may hold spare rows and columns for variables added later (see _reserve_mat).
+     * Variables occupy the indices [0, N), the spare indices are filled with zeros,
+     * and the linear biases always live in the last column.
      */
     Matrix _quadmat;
 
     /**
      * @brief vector for converting index to label
-     * the list is asssumed to be sorted
+     * labels are stored in insertion order; use get_variables() for the sorted list.
      */
     std::vector<IndexType> _idx_to_label;
 
@@ -200,6 +474,48 @@ namespace cimod {
      */
     std::unordered_map<IndexType, size_t> _label_to_idx;
 
+    /**
+     * @brief true if _idx_to_label is sorted
+     */
+    bool _sorted = true;
+
+    /**
+     * @brief sorted labels, generated lazily when _idx_to_label is not sorted
+     */
+    mutable std::vector<IndexType> _sorted_labels;
+
+    /**
+     * @brief flag for generating _sorted_labels once; concurrent const methods generate it only once
+     */
+    mutable CacheOnceFlag _sorted_labels_flag;
+
+    /**
+     * @brief column index of the off-diagonal interactions for sparse matrix (CSC), generated lazily by neighbors
+     * the interactions of column j with the rows i < j are _col_row[k] and _col_value[k] for
+     * _col_ptr[j] <= k < _col_ptr[j + 1].
+     */
+    mutable std::vector<StorageIndex> _col_ptr;
+
+    /**
+     * @brief row indices of the column index
+     */
+    mutable std::vector<StorageIndex> _col_row;
+
+    /**
+     * @brief biases of the column index
+     */
+    mutable std::vector<FloatType> _col_value;
+
+    /**
+     * @brief flag for building the column index once; concurrent const methods build it only once
+     */
+    mutable CacheOnceFlag _col_flag;
+
+    /**
+     * @brief version of the model, advanced by every change of the model
+     */
+    uint64_t _version = 0;
+
     /**
      * @brief The energy offset associated with the model.
      *
@@ -224,6 +540,15 @@ namespace cimod {
       }
     }
 
+    /**
+     * @brief advance the version and drop the caches generated from _quadmat
+     * called by every method that changes the biases.
+     */
+    inline void _on_modified() {
+      _version++;
+      _col_flag.reset();
+    }
+
     /**
      * @brief access elements for dense matrix
      *
@@ -285,16 +610,14 @@ namespace cimod {
     }
 
     /**
-     * @brief get reference of _quadmat(i,j)
+     * @brief get reference of _quadmat(i,j) for internal indices
      *
-     * @param label_i
-     * @param label_j
+     * @param i
+     * @param j
      *
      * @return reference of _quadmat(i,j)
      */
-    inline FloatType &_mat( IndexType label_i, IndexType label_j ) {
-      size_t i = _label_to_idx.at( label_i );
-      size_t j = _label_to_idx.at( label_j );
+    inline FloatType &_mat_idx( size_t i, size_t j ) {
       if ( i != j )
         return _quadmat_get( std::min( i, j ), std::max( i, j ) );
       else
@@ -302,29 +625,25 @@ namespace cimod {
     }
 
     /**
-     * @brief get reference of _quadmat(i,i)
+     * @brief get reference of _quadmat(i,i) for an internal index
      *
-     * @param label_i
+     * @param i
      *
      * @return reference of _quadmat(i,i)
      */
-    inline FloatType &_mat( IndexType label_i ) {
-      size_t i = _label_to_idx.at( label_i );
+    inline FloatType &_mat_idx( size_t i ) {
       return _quadmat_get( i, _quadmat.rows() - 1 );
     }
 
     /**
-     * @brief get reference of _quadmat(i,j)
+     * @brief get _quadmat(i,j) for internal indices
      *
-     * @param label_i
-     * @param label_j
+     * @param i
+     * @param j
      *
-     * @return reference of _quadmat(i,j)
+     * @return _quadmat(i,j)
      */
-    inline FloatType _mat( IndexType label_i, IndexType label_j ) const {
-      size_t i = _label_to_idx.at( label_i );
-      size_t j = _label_to_idx.at( label_j );
-
+    inline FloatType _mat_idx( size_t i, size_t j ) const {
       if ( i != j )
         return _quadmat_get( std::min( i, j ), std::max( i, j ) );
       else
@@ -332,208 +651,205 @@ namespace cimod {
     }
 
     /**
-     * @brief get reference of _quadmat(i,i)
+     * @brief get _quadmat(i,i) for an internal index
      *
-     * @param label_i
+     * @param i
      *
-     * @return reference of _quadmat(i,i)
+     * @return _quadmat(i,i)
      */
-    inline FloatType _mat( IndexType label_i ) const {
-      size_t i = _label_to_idx.at( label_i );
+    inline FloatType _mat_idx( size_t i ) const {
       return _quadmat_get( i, _quadmat.rows() - 1 );
     }
 
     /**
-     * @brief calculate maximum element in linear term for dense graph
+     * @brief get reference of _quadmat(i,j)
      *
-     * @return
-     */
-    template<typename T = DataType>
-    inline FloatType _max_linear( dispatch_t<T, Dense> = nullptr ) const {
-      size_t N = _quadmat.rows();
-      return _quadmat.block( 0, N - 1, N - 1, 1 ).maxCoeff();
-    }
-
-    /**
-     * @brief calculate maximum element in quadratic term for dense graph
+     * @param label_i
+     * @param label_j
      *
-     * @return
+     * @return reference of _quadmat(i,j)
      */
-    template<typename T = DataType>
-    inline FloatType _max_quadratic( dispatch_t<T, Dense> = nullptr ) const {
-      size_t N = _quadmat.rows();
-      return _quadmat.block( 0, 0, N - 1, N - 1 ).maxCoeff();
+    inline FloatType &_mat( IndexType label_i, IndexType label_j ) {
+      return _mat_idx( _label_to_idx.at( label_i ), _label_to_idx.at( label_j ) );
     }
 
     /**
-     * @brief calculate minimum element in linear term for dense graph
+     * @brief get reference of _quadmat(i,i)
      *
-     * @return
+     * @param label_i
+     *
+     * @return reference of _quadmat(i,i)
      */
-    template<typename T = DataType>
-    inline FloatType _min_linear( dispatch_t<T, Dense> = nullptr ) const {
-      size_t N = _quadmat.rows();
-      return _quadmat.block( 0, N - 1, N - 1, 1 ).minCoeff();
+    inline FloatType &_mat( IndexType label_i ) {
+      return _mat_idx( _label_to_idx.at( label_i ) );
     }
 
     /**
-     * @brief calculate minimum element in quadratic term for dense graph
+     * @brief get reference of _quadmat(i,j)
      *
-     * @return
+     * @param label_i
+     * @param label_j
+     *
+     * @return reference of _quadmat(i,j)
      */
-    template<typename T = DataType>
-    inline FloatType _min_quadratic( dispatch_t<T, Dense> = nullptr ) const {
-      size_t N = _quadmat.rows();
-      return _quadmat.block( 0, 0, N - 1, N - 1 ).minCoeff();
+    inline FloatType _mat( IndexType label_i, IndexType label_j ) const {
+      return _mat_idx( _label_to_idx.at( label_i ), _label_to_idx.at( label_j ) );
     }
 
     /**
-     * @brief calculate maximum element in linear term for dense graph
+     * @brief get reference of _quadmat(i,i)
      *
-     * @return
+     * @param label_i
+     *
+     * @return reference of _quadmat(i,i)
      */
-    template<typename T = DataType>
-    inline FloatType _max_linear( dispatch_t<T, Sparse> = nullptr ) const {
-      size_t N = _quadmat.rows();
-      SparseMatrix mat( N - 1, 1 );
-      mat = _quadmat.block( 0, N - 1, N - 1, 1 );
-      return mat.coeffs().maxCoeff();
+    inline FloatType _mat( IndexType label_i ) const {
+      return _mat_idx( _label_to_idx.at( label_i ) );
     }
 
     /**
-     * @brief calculate maximum element in quadratic term for dense graph
+     * @brief check that id is a valid internal index
      *
-     * @return
+     * @param id
+     *
+     * @return id
      */
-    template<typename T = DataType>
-    inline FloatType _max_quadratic( dispatch_t<T, Sparse> = nullptr ) const {
-      size_t N = _quadmat.rows();
-      SparseMatrix mat( N - 1, N - 1 );
-      mat = _quadmat.block( 0, 0, N - 1, N - 1 );
-      return mat.coeffs().maxCoeff();
+    inline size_t _check_id( LabelId id ) const {
+      if ( id >= get_num_variables() ) {
+        throw std::out_of_range( "the id is not in the model." );
+      }
+      return id;
     }
 
     /**
-     * @brief calculate minimum element in linear term for dense graph
+     * @brief calculate the ranges (min, max) of the linear and the quadratic biases for dense graph
      *
-     * @return
+     * @return pair of the linear range and the quadratic range
      */
     template<typename T = DataType>
-    inline FloatType _min_linear( dispatch_t<T, Sparse> = nullptr ) const {
-      size_t N = _quadmat.rows();
-      SparseMatrix mat( N - 1, 1 );
-      mat = _quadmat.block( 0, N - 1, N - 1, 1 );
-      return mat.coeffs().minCoeff();
+    inline std::pair<std::pair<FloatType, FloatType>, std::pair<FloatType, FloatType>> _bias_ranges(
+        dispatch_t<T, Dense> = nullptr ) const {
+      size_t N = get_num_variables();
+      if ( N == 0 ) {
+        return { { 0, 0 }, { 0, 0 } };
+      }
+      const auto lin = _quadmat.block( 0, _quadmat.rows() - 1, N, 1 );
+      const auto quad = _quadmat.block( 0, 0, N, N );
+      return { { lin.minCoeff(), lin.maxCoeff() }, { quad.minCoeff(), quad.maxCoeff() } };
     }
 
     /**
-     * @brief calculate minimum element in quadratic term for dense graph
+     * @brief calculate the ranges (min, max) of the linear and the quadratic biases for sparse graph
+     * in a single scan over the stored elements. Only explicitly stored elements are taken into account and the range
+     * is (0, 0) if no element is stored.
      *
-     * @return
+     * @return pair of the linear range and the quadratic range
      */
     template<typename T = DataType>
-    inline FloatType _min_quadratic( dispatch_t<T, Sparse> = nullptr ) const {
-      size_t N = _quadmat.rows();
-      SparseMatrix mat( N - 1, N - 1 );
-      mat = _quadmat.block( 0, 0, N - 1, N - 1 );
-      return mat.coeffs().minCoeff();
+    inline std::pair<std::pair<FloatType, FloatType>, std::pair<FloatType, FloatType>> _bias_ranges(
+        dispatch_t<T, Sparse> = nullptr ) const {
+      const int64_t N = get_num_variables();
+      const int64_t last = _quadmat.cols() - 1;
+      constexpr FloatType inf = std::numeric_limits<FloatType>::infinity();
+      std::pair<FloatType, FloatType> l_range = { inf, -inf };
+      std::pair<FloatType, FloatType> q_range = { inf, -inf };
+
+      for ( int64_t i = 0; i < N; i++ ) {
+        for ( SpIter it( _quadmat, i ); it; ++it ) {
+          auto &range = ( it.index() == last ) ? l_range : q_range;
+          range.first = std::min( range.first, it.value() );
+          range.second = std::max( range.second, it.value() );
+        }
+      }
+
+      for ( auto *range : { &l_range, &q_range } ) {
+        if ( range->first > range->second ) {
+          *range = { 0, 0 };
+        }
+      }
+      return { l_range, q_range };
     }
 
     /**
-     * @brief insert row and column that corresponds to added label into _quadmat for dense matrix
+     * @brief reallocate _quadmat for dense matrix so that it can hold `capacity` variables
+     * the linear biases are moved to the new last column.
      *
-     * @param label_i
+     * @param capacity
      */
     template<typename T = DataType>
-    inline void _insert_label_into_mat( IndexType label_i, dispatch_t<T, Dense> = nullptr ) {
-      size_t i = _label_to_idx.at( label_i );
+    inline void _reserve_mat( size_t capacity, dispatch_t<T, Dense> = nullptr ) {
+      size_t N = get_num_variables();
+      size_t last = _quadmat.rows() - 1;
       // define temp mat
-      size_t N = _quadmat.rows() + 1;
-      Matrix tempmat = Matrix( N, N );
-      tempmat.setZero();
+      Matrix tempmat = Matrix::Zero( capacity + 1, capacity + 1 );
       // copy elements to new matrix
-      tempmat.block( 0, 0, i, i ) = _quadmat.block( 0, 0, i, i );
-      tempmat.block( 0, i + 1, i, N - i - 1 ) = _quadmat.block( 0, i, i, N - i - 1 );
-      tempmat.block( i + 1, i + 1, N - i - 1, N - i - 1 ) = _quadmat.block( i, i, N - i - 1, N - i - 1 );
+      tempmat.block( 0, 0, N, N ) = _quadmat.block( 0, 0, N, N );
+      tempmat.block( 0, capacity, N, 1 ) = _quadmat.block( 0, last, N, 1 );
+      tempmat( capacity, capacity ) = _quadmat( last, last );
 
-      _quadmat = tempmat;
+      _quadmat.swap( tempmat );
     }
 
     /**
-     * @brief insert row and column that corresponds to added label into _quadmat for sparse matrix
+     * @brief reallocate _quadmat for sparse matrix so that it can hold `capacity` variables
+     * the linear biases are moved to the new last column.
      *
-     * @param label_i
+     * @param capacity
      */
     template<typename T = DataType>
-    inline void _insert_label_into_mat( IndexType label_i, dispatch_t<T, Sparse> = nullptr ) {
-      size_t i = _label_to_idx.at( label_i );
-      // define temp mat
-      size_t N = _quadmat.rows() + 1;
-      // Matrix tempmat = Matrix(N, N);
-      // copy elements to new matrix
-      // tempmat.block(0,0,i,i)              = _quadmat.block(0,0,i,i);
-      // tempmat.block(0,i+1,i,N-i-1)        = _quadmat.block(0,i,i,N-i-1);
-      // tempmat.block(i+1,i+1,N-i-1,N-i-1)  = _quadmat.block(i,i,N-i-1,N-i-1);
+    inline void _reserve_mat( size_t capacity, dispatch_t<T, Sparse> = nullptr ) {
+      size_t last = _quadmat.rows() - 1;
 
       std::vector<Eigen::Triplet<FloatType>> triplets;
       triplets.reserve( _quadmat.nonZeros() );
 
       for ( int k = 0; k < _quadmat.outerSize(); k++ ) {
         for ( SpIter it( _quadmat, k ); it; ++it ) {
-          size_t r = it.row();
-          size_t c = it.col();
-          FloatType val = it.value();
-
-          if ( r >= i && c >= i ) {
-            triplets.emplace_back( r + 1, c + 1, val );
-          } else if ( r >= i ) {
-            triplets.emplace_back( r + 1, c, val );
-          } else if ( c >= i ) {
-            triplets.emplace_back( r, c + 1, val );
-          } else {
-            triplets.emplace_back( r, c, val );
-          }
+          size_t r = ( ( size_t )it.row() == last ) ? capacity : it.row();
+          size_t c = ( ( size_t )it.col() == last ) ? capacity : it.col();
+          triplets.emplace_back( r, c, it.value() );
         }
       }
 
-      _quadmat.resize( N, N );
+      _quadmat.resize( capacity + 1, capacity + 1 );
       _quadmat.setFromTriplets( triplets.begin(), triplets.end() );
     }
 
     /**
      * @brief delete row and column that corresponds to existing label from _quadmat for dense matrix
+     * the indices after label_i are shifted by one and the capacity of _quadmat is kept.
      *
      * @param label_i
      */
     template<typename T = DataType>
     inline void _delete_label_from_mat( IndexType label_i, dispatch_t<T, Dense> = nullptr ) {
       size_t i = _label_to_idx.at( label_i );
+      size_t N = get_num_variables();
+      size_t M = N - i - 1;
+      size_t last = _quadmat.rows() - 1;
       // define temp mat
-      size_t N = _quadmat.rows();
-      Matrix tempmat = Matrix( N - 1, N - 1 );
-      tempmat.setZero();
+      Matrix tempmat = Matrix::Zero( _quadmat.rows(), _quadmat.cols() );
       // copy elements to new matrix
       tempmat.block( 0, 0, i, i ) = _quadmat.block( 0, 0, i, i );
-      tempmat.block( 0, i, i, N - i - 1 ) = _quadmat.block( 0, i + 1, i, N - i - 1 );
-      tempmat.block( i, i, N - i - 1, N - i - 1 ) = _quadmat.block( i + 1, i + 1, N - i - 1, N - i - 1 );
+      tempmat.block( 0, i, i, M ) = _quadmat.block( 0, i + 1, i, M );
+      tempmat.block( i, i, M, M ) = _quadmat.block( i + 1, i + 1, M, M );
+      tempmat.block( 0, last, i, 1 ) = _quadmat.block( 0, last, i, 1 );
+      tempmat.block( i, last, M, 1 ) = _quadmat.block( i + 1, last, M, 1 );
+      tempmat( last, last ) = _quadmat( last, last );
 
-      _quadmat = tempmat;
+      _quadmat.swap( tempmat );
     }
 
     /**
      * @brief delete row and column that corresponds to existing label from _quadmat for sparse matrix
+     * the indices after label_i are shifted by one and the capacity of _quadmat is kept.
      *
      * @param label_i
      */
     template<typename T = DataType>
     inline void _delete_label_from_mat( IndexType label_i, dispatch_t<T, Sparse> = nullptr ) {
       size_t i = _label_to_idx.at( label_i );
-      // define temp mat
-      size_t N = _quadmat.rows();
-      // copy elements to new matrix
-      // tempmat.block(0,0,i,i)              = _quadmat.block(0,0,i,i);
-      // tempmat.block(0,i,i,N-i-1)          = _quadmat.block(0,i+1,i,N-i-1);
-      // tempmat.block(i,i,N-i-1,N-i-1)      = _quadmat.block(i+1,i+1,N-i-1,N-i-1);
+      size_t last = _quadmat.rows() - 1;
 
       std::vector<Eigen::Triplet<FloatType>> triplets;
       triplets.reserve( _quadmat.nonZeros() );
@@ -547,36 +863,37 @@ namespace cimod {
           if ( r == i || c == i )
             continue;
 
-          if ( r > i && c > i ) {
-            triplets.emplace_back( r - 1, c - 1, val );
-          } else if ( r > i ) {
-            triplets.emplace_back( r - 1, c, val );
-          } else if ( c > i ) {
-            triplets.emplace_back( r, c - 1, val );
-          } else {
-            triplets.emplace_back( r, c, val );
-          }
+          triplets.emplace_back( ( r > i && r != last ) ? r - 1 : r, ( c > i && c != last ) ? c - 1 : c, val );
         }
       }
 
-      _quadmat.resize( N - 1, N - 1 );
       _quadmat.setFromTriplets( triplets.begin(), triplets.end() );
     }
 
     /**
      * @brief add new label
      * if label_i already exists, this process is skipped.
+     * the label is appended to the end of _idx_to_label and _quadmat grows geometrically,
+     * so that the cost is amortized O(1) per new label.
      *
      * @param label_i
      */
     inline void _add_new_label( IndexType label_i ) {
       if ( _label_to_idx.find( label_i ) == _label_to_idx.end() ) {
+        size_t N = get_num_variables();
+        // no spare index left
+        if ( N + 1 >= ( size_t )_quadmat.rows() ) {
+          _reserve_mat( std::max<size_t>( 2 * N, 4 ) );
+        }
+
+        if ( N > 0 && !( _idx_to_label.back() < label_i ) ) {
+          _sorted = false;
+        }
+
         // add label_i
         _idx_to_label.push_back( label_i );
-        std::sort( _idx_to_label.begin(), _idx_to_label.end() );
-        _set_label_to_idx();
-
-        _insert_label_into_mat( label_i );
+        _label_to_idx[ label_i ] = N;
+        _sorted_labels_flag.reset();
       }
     }
 
@@ -589,11 +906,11 @@ namespace cimod {
      * otherwise, delete label only if there are no corresponding nonzero elements in the matrix.
      */
     inline void _delete_label( IndexType label_i, bool force_delete = true ) {
-      auto position = std::find( _idx_to_label.begin(), _idx_to_label.end(), label_i );
-      if ( position != _idx_to_label.end() ) {
+      auto position = _label_to_idx.find( label_i );
+      if ( position != _label_to_idx.end() ) {
+        size_t i = position->second;
         if ( force_delete == false ) {
           // check if there are corresponding nonzero elements
-          size_t i = std::distance( _idx_to_label.begin(), position );
           if ( _quadmat.col( i ).squaredNorm() > std::numeric_limits<FloatType>::epsilon()
                || _quadmat.row( i ).squaredNorm() > std::numeric_limits<FloatType>::epsilon() ) {
             // exists nonzero elements
@@ -602,19 +919,225 @@ namespace cimod {
         }
         // delete from matrix first
         _delete_label_from_mat( label_i );
-        // add label_i
-        _idx_to_label.erase( position );
-        // already sorted
-        // std::sort(_idx_to_label.begin(), _idx_to_label.end());
-        _set_label_to_idx();
+        // delete label_i and shift the following indices
+        _idx_to_label.erase( _idx_to_label.begin() + i );
+        _label_to_idx.erase( position );
+        for ( size_t j = i; j < _idx_to_label.size(); j++ ) {
+          _label_to_idx[ _idx_to_label[ j ] ] = j;
+        }
+        _sorted_labels_flag.reset();
       }
     }
 
     /**
-     * @brief initialize matrix with linear and quadratic dicts (for dense matrix)
+     * @brief check if _quadmat has the canonical form, i.e. it has no spare indices and its labels are sorted
      *
-     * @param linear
-     * @param quadratic
+     * @return true if _quadmat has the canonical form
+     */
+    inline bool _is_canonical() const {
+      return _sorted && ( size_t )_quadmat.rows() == get_num_variables() + 1;
+    }
+
+    /**
+     * @brief generate the indices of _idx_to_label in the order of sorted labels
+     *
+     * @return sorted indices
+     */
+    inline std::vector<size_t> _generate_sorted_indices() const {
+      std::vector<size_t> indices( _idx_to_label.size() );
+      std::iota( indices.begin(), indices.end(), 0 );
+      if ( !_sorted ) {
+        std::sort( indices.begin(), indices.end(), [ this ]( size_t a, size_t b ) {
+          return _idx_to_label[ a ] < _idx_to_label[ b ];
+        } );
+      }
+      return indices;
+    }
+
+    /**
+     * @brief generate the rank of each index of _idx_to_label in the sorted labels
+     *
+     * @return ranks
+     */
+    inline std::vector<size_t> _generate_sorted_ranks() const {
+      std::vector<size_t> indices = _generate_sorted_indices();
+      std::vector<size_t> ranks( indices.size() );
+      for ( size_t k = 0; k < indices.size(); k++ ) {
+        ranks[ indices[ k ] ] = k;
+      }
+      return ranks;
+    }
+
+    /**
+     * @brief compress _quadmat for dense matrix (nothing to do)
+     */
+    template<typename T = DataType>
+    inline void _compress_mat( dispatch_t<T, Dense> = nullptr ) {
+    }
+
+    /**
+     * @brief compress _quadmat for sparse matrix, so that the storage is in the plain CSR format
+     */
+    template<typename T = DataType>
+    inline void _compress_mat( dispatch_t<T, Sparse> = nullptr ) {
+      _quadmat.makeCompressed();
+    }
+
+    /**
+     * @brief generate _quadmat in the canonical form (sorted labels, no spare indices) for dense matrix
+     *
+     * @return canonical matrix
+     */
+    template<typename T = DataType>
+    inline Matrix _generate_sorted_quadmat( dispatch_t<T, Dense> = nullptr ) const {
+      size_t N = get_num_variables();
+      size_t last = _quadmat.rows() - 1;
+      std::vector<size_t> ranks = _generate_sorted_ranks();
+
+      Matrix mat = Matrix::Zero( N + 1, N + 1 );
+      for ( size_t i = 0; i < N; i++ ) {
+        for ( size_t j = i; j < N; j++ ) {
+          FloatType val = _quadmat( i, j );
+          if ( val != 0 )
+            mat( std::min( ranks[ i ], ranks[ j ] ), std::max( ranks[ i ], ranks[ j ] ) ) = val;
+        }
+        mat( ranks[ i ], N ) = _quadmat( i, last );
+      }
+      mat( N, N ) = _quadmat( last, last );
+
+      return mat;
+    }
+
+    /**
+     * @brief generate _quadmat in the canonical form (sorted labels, no spare indices) for sparse matrix
+     *
+     * @return canonical matrix
+     */
+    template<typename T = DataType>
+    inline Matrix _generate_sorted_quadmat( dispatch_t<T, Sparse> = nullptr ) const {
+      size_t N = get_num_variables();
+      size_t last = _quadmat.rows() - 1;
+      std::vector<size_t> ranks = _generate_sorted_ranks();
+
+      std::vector<Eigen::Triplet<FloatType>> triplets;
+      triplets.reserve( _quadmat.nonZeros() );
+
+      for ( int k = 0; k < _quadmat.outerSize(); k++ ) {
+        for ( SpIter it( _quadmat, k ); it; ++it ) {
+          size_t r = ( ( size_t )it.row() == last ) ? N : ranks[ it.row() ];
+          size_t c = ( ( size_t )it.col() == last ) ? N : ranks[ it.col() ];
+          triplets.emplace_back( std::min( r, c ), std::max( r, c ), it.value() );
+        }
+      }
+
+      Matrix mat( N + 1, N + 1 );
+      mat.setFromTriplets( triplets.begin(), triplets.end() );
+      return mat;
+    }
+
+    /**
+     * @brief generate the bias arrays of the serializable object (sparse schema) in the order of sorted labels.
+     * The size of each row is taken from the storage of _quadmat, so the arrays are allocated once and filled row by
+     * row in parallel. If the labels are not sorted, the interactions are scattered to the rows of the sorted order
+     * and each row is sorted afterwards.
+     *
+     * @param l_bias
+     * @param q_head
+     * @param q_tail
+     * @param q_bias
+     */
+    template<typename T = DataType>
+    inline void _generate_serializable_biases(
+        std::vector<FloatType> &l_bias,
+        std::vector<size_t> &q_head,
+        std::vector<size_t> &q_tail,
+        std::vector<FloatType> &q_bias,
+        dispatch_t<T, Sparse> = nullptr ) const {
+      using StorageIndex = typename SparseMatrix::StorageIndex;
+      const int64_t N = get_num_variables();
+      const StorageIndex last = _quadmat.rows() - 1;
+      const StorageIndex *outer = _quadmat.outerIndexPtr();
+      const StorageIndex *inner_nnz = _quadmat.innerNonZeroPtr();
+      const StorageIndex *inner = _quadmat.innerIndexPtr();
+      const FloatType *values = _quadmat.valuePtr();
+      const std::vector<size_t> ranks = _generate_sorted_ranks();
+
+      // [begin, quad_end) of a row are the interactions; the linear bias is the last element of a row
+      std::vector<int64_t> quad_end( N );
+      l_bias.assign( N, 0 );
+#pragma omp parallel for
+      for ( int64_t r = 0; r < N; r++ ) {
+        int64_t end = ( inner_nnz != nullptr ) ? outer[ r ] + inner_nnz[ r ] : outer[ r + 1 ];
+        if ( end > outer[ r ] && inner[ end - 1 ] == last ) {
+          l_bias[ ranks[ r ] ] = values[ end - 1 ];
+          end--;
+        }
+        quad_end[ r ] = end;
+      }
+
+      std::vector<size_t> row_ptr( N + 1, 0 );
+      if ( _sorted ) {
+        for ( int64_t r = 0; r < N; r++ ) {
+          row_ptr[ r + 1 ] = row_ptr[ r ] + ( quad_end[ r ] - outer[ r ] );
+        }
+      } else {
+        for ( int64_t r = 0; r < N; r++ ) {
+          for ( int64_t p = outer[ r ]; p < quad_end[ r ]; p++ ) {
+            row_ptr[ std::min( ranks[ r ], ranks[ inner[ p ] ] ) + 1 ]++;
+          }
+        }
+        std::partial_sum( row_ptr.begin(), row_ptr.end(), row_ptr.begin() );
+      }
+
+      const size_t num_interactions = row_ptr[ N ];
+      q_head.resize( num_interactions );
+      q_tail.resize( num_interactions );
+      q_bias.resize( num_interactions );
+      if ( _sorted ) {
+#pragma omp parallel for
+        for ( int64_t r = 0; r < N; r++ ) {
+          size_t k = row_ptr[ r ];
+          for ( int64_t p = outer[ r ]; p < quad_end[ r ]; p++, k++ ) {
+            q_head[ k ] = r;
+            q_tail[ k ] = inner[ p ];
+            q_bias[ k ] = values[ p ];
+          }
+        }
+      } else {
+        std::vector<size_t> cursor( row_ptr.begin(), row_ptr.end() - 1 );
+        for ( int64_t r = 0; r < N; r++ ) {
+          for ( int64_t p = outer[ r ]; p < quad_end[ r ]; p++ ) {
+            const size_t i = std::min( ranks[ r ], ranks[ inner[ p ] ] );
+            const size_t k = cursor[ i ]++;
+            q_head[ k ] = i;
+            q_tail[ k ] = std::max( ranks[ r ], ranks[ inner[ p ] ] );
+            q_bias[ k ] = values[ p ];
+          }
+        }
+#pragma omp parallel
+        {
+          std::vector<std::pair<size_t, FloatType>> row;
+#pragma omp for
+          for ( int64_t i = 0; i < N; i++ ) {
+            row.clear();
+            for ( size_t k = row_ptr[ i ]; k < row_ptr[ i + 1 ]; k++ ) {
+              row.emplace_back( q_tail[ k ], q_bias[ k ] );
+            }
+            std::sort( row.begin(), row.end() );
+            for ( size_t k = row_ptr[ i ]; k < row_ptr[ i + 1 ]; k++ ) {
+              q_tail[ k ] = row[ k - row_ptr[ i ] ].first;
+              q_bias[ k ] = row[ k - row_ptr[ i ] ].second;
+            }
+          }
+        }
+      }
+    }
+
+    /**
+     * @brief initialize matrix with linear and quadratic dicts (for dense matrix)
+     *
+     * @param linear
+     * @param quadratic
      */
     template<typename T = DataType>
     inline void _initialize_quadmat(
@@ -718,6 +1241,102 @@ namespace cimod {
       _quadmat.setFromTriplets( triplets.begin(), triplets.end() );
     }
 
+    /**
+     * @brief gather labels of COO triplets and initialize label <-> index conversion variables
+     *
+     * @param row
+     * @param col
+     * @param bias
+     */
+    inline void _initialize_labels_from_coo(
+        const std::vector<IndexType> &row,
+        const std::vector<IndexType> &col,
+        const std::vector<FloatType> &bias ) {
+      if ( row.size() != col.size() || row.size() != bias.size() ) {
+        throw std::runtime_error( "the sizes of row, col and bias do not match." );
+      }
+
+      // gather labels
+      std::unordered_set<IndexType> labels( row.begin(), row.end() );
+      labels.insert( col.begin(), col.end() );
+
+      // init label <-> index conversion variables
+      _idx_to_label = std::vector<IndexType>( labels.begin(), labels.end() );
+      std::sort( _idx_to_label.begin(), _idx_to_label.end() );
+      _set_label_to_idx();
+    }
+
+    /**
+     * @brief initialize matrix with COO triplets (for dense matrix)
+     * diagonal elements (row[k] == col[k]) are regarded as linear biases and duplicated elements are summed up.
+     *
+     * @param row
+     * @param col
+     * @param bias
+     */
+    template<typename T = DataType>
+    inline void _initialize_quadmat(
+        const std::vector<IndexType> &row,
+        const std::vector<IndexType> &col,
+        const std::vector<FloatType> &bias,
+        dispatch_t<T, Dense> = nullptr ) {
+      _initialize_labels_from_coo( row, col, bias );
+
+      // initialize _quadmat
+      size_t mat_size = _idx_to_label.size() + 1;
+      _quadmat = Matrix::Zero( mat_size, mat_size );
+      _quadmat( mat_size - 1, mat_size - 1 ) = 1;
+
+      for ( size_t k = 0; k < bias.size(); k++ ) {
+        size_t i = _label_to_idx.at( row[ k ] );
+        size_t j = _label_to_idx.at( col[ k ] );
+        if ( i == j ) {
+          _quadmat( i, mat_size - 1 ) += bias[ k ];
+        } else {
+          _quadmat( std::min( i, j ), std::max( i, j ) ) += bias[ k ];
+        }
+      }
+    }
+
+    /**
+     * @brief initialize matrix with COO triplets (for sparse matrix)
+     * diagonal elements (row[k] == col[k]) are regarded as linear biases and duplicated elements are summed up.
+     *
+     * @param row
+     * @param col
+     * @param bias
+     */
+    template<typename T = DataType>
+    inline void _initialize_quadmat(
+        const std::vector<IndexType> &row,
+        const std::vector<IndexType> &col,
+        const std::vector<FloatType> &bias,
+        dispatch_t<T, Sparse> = nullptr ) {
+      _initialize_labels_from_coo( row, col, bias );
+
+      // initialize _quadmat
+      size_t mat_size = _idx_to_label.size() + 1;
+      _quadmat = Matrix( mat_size, mat_size );
+
+      std::vector<Eigen::Triplet<FloatType>> triplets;
+      triplets.reserve( bias.size() + 1 );
+
+      for ( size_t k = 0; k < bias.size(); k++ ) {
+        size_t i = _label_to_idx.at( row[ k ] );
+        size_t j = _label_to_idx.at( col[ k ] );
+        if ( i == j ) {
+          triplets.emplace_back( i, mat_size - 1, bias[ k ] );
+        } else {
+          triplets.emplace_back( std::min( i, j ), std::max( i, j ), bias[ k ] );
+        }
+      }
+
+      triplets.emplace_back( mat_size - 1, mat_size - 1, 1 );
+
+      // NOTE: duplicated elements are summed up.
+      _quadmat.setFromTriplets( triplets.begin(), triplets.end() );
+    }
+
     /**
      * @brief add non-diagonal elements to upper triangular components for dense matrix
      *
@@ -726,7 +1345,10 @@ namespace cimod {
      * @param fix_format
      */
     template<typename T = DataType>
-    inline void _add_triangular_elements( const DenseMatrix &mat, bool fix_format, dispatch_t<T, Dense> = nullptr ) {
+    inline void _add_triangular_elements(
+        const Eigen::Ref<const DenseMatrix> &mat,
+        bool fix_format,
+        dispatch_t<T, Dense> = nullptr ) {
 
       size_t mat_size = _idx_to_label.size() + 1;
 
@@ -757,7 +1379,10 @@ namespace cimod {
      * @param fix_format
      */
     template<typename T = DataType>
-    inline void _add_triangular_elements( const DenseMatrix &mat, bool fix_format, dispatch_t<T, Sparse> = nullptr ) {
+    inline void _add_triangular_elements(
+        const Eigen::Ref<const DenseMatrix> &mat,
+        bool fix_format,
+        dispatch_t<T, Sparse> = nullptr ) {
 
       // generate sparse matrix
       SparseMatrix sparse_mat;
@@ -827,11 +1452,16 @@ namespace cimod {
      * \end{pmatrix}
      * \f]
      *
+     * mat is read in place, so a row-major buffer given through Eigen::Ref is copied only into _quadmat.
+     *
      * @param mat
      * @param labels
      * @param fix_format
      */
-    inline void _initialize_quadmat( const DenseMatrix &mat, const std::vector<IndexType> &labels_vec, bool fix_format ) {
+    inline void _initialize_quadmat(
+        const Eigen::Ref<const DenseMatrix> &mat,
+        const std::vector<IndexType> &labels_vec,
+        bool fix_format ) {
 
       // initlaize label <-> index dict
       std::unordered_set<IndexType> labels( labels_vec.begin(), labels_vec.end() );
@@ -850,10 +1480,25 @@ namespace cimod {
       _quadmat_get( mat_size - 1, mat_size - 1 ) = 1;
     }
 
+    /**
+     * @brief make a pair of labels of indices i and j in ascending order of labels
+     *
+     * @param i
+     * @param j
+     *
+     * @return pair of labels
+     */
+    inline std::pair<IndexType, IndexType> _make_label_pair( size_t i, size_t j ) const {
+      if ( _sorted || _idx_to_label[ i ] < _idx_to_label[ j ] ) {
+        return std::make_pair( _idx_to_label[ i ], _idx_to_label[ j ] );
+      }
+      return std::make_pair( _idx_to_label[ j ], _idx_to_label[ i ] );
+    }
+
     inline Linear<IndexType, FloatType> _generate_linear() const {
       Linear<IndexType, FloatType> ret_linear;
       for ( size_t i = 0; i < _idx_to_label.size(); i++ ) {
-        FloatType val = _quadmat_get( i, _idx_to_label.size() );
+        FloatType val = _quadmat_get( i, _quadmat.rows() - 1 );
         if ( val != 0 )
           ret_linear[ _idx_to_label[ i ] ] = val;
       }
@@ -868,7 +1513,7 @@ namespace cimod {
         for ( size_t j = i + 1; j < _idx_to_label.size(); j++ ) {
           FloatType val = _quadmat_get( i, j );
           if ( val != 0 )
-            ret_quadratic[ std::make_pair( _idx_to_label[ i ], _idx_to_label[ j ] ) ] = val;
+            ret_quadratic[ _make_label_pair( i, j ) ] = val;
         }
       }
 
@@ -887,7 +1532,7 @@ namespace cimod {
           FloatType val = it.value();
 
           if ( r < this->get_num_variables() && c < this->get_num_variables() && val != 0 )
-            ret_quadratic[ std::make_pair( _idx_to_label[ r ], _idx_to_label[ c ] ) ] = val;
+            ret_quadratic[ _make_label_pair( r, c ) ] = val;
         }
       }
 
@@ -913,12 +1558,107 @@ namespace cimod {
      */
     inline void _initialize_quadmat( const SparseMatrix &mat, const std::vector<IndexType> &labels_vec ) {
       this->_quadmat = mat;
+      _initialize_labels_from_vector( labels_vec );
+    }
+
+    /**
+     * @brief initialize matrix with a sparse matrix, taking over its storage
+     *
+     * @param mat
+     * @param labels_vec
+     */
+    inline void _initialize_quadmat( SparseMatrix &&mat, const std::vector<IndexType> &labels_vec ) {
+      this->_quadmat = std::move( mat );
+      _initialize_labels_from_vector( labels_vec );
+    }
+
+    /**
+     * @brief initialize the labels with the (sorted) labels of a matrix
+     *
+     * @param labels_vec
+     */
+    inline void _initialize_labels_from_vector( const std::vector<IndexType> &labels_vec ) {
       std::unordered_set<IndexType> labels( labels_vec.begin(), labels_vec.end() );
       _idx_to_label = std::vector<IndexType>( labels.begin(), labels.end() );
       std::sort( _idx_to_label.begin(), _idx_to_label.end() );
       _set_label_to_idx();
     }
 
+    /**
+     * @brief apply the affine vartype conversion to the sparse matrix in place:
+     *
+     * \f[
+     * Q'_{ij} = a Q_{ij},\quad
+     * h'_{i} = b h_{i} + c\left(\sum_{j}Q_{ji}+\sum_{j}Q_{ij}\right),\quad
+     * \mathrm{offset} += d \sum_{i<j} Q_{ij} + e \sum_{i} h_{i}
+     * \f]
+     *
+     * Since _quadmat is upper triangular, the column sum of row i is complete when row i is reached, so the matrix is
+     * scanned only once and the quadratic values are rewritten without touching the sparsity pattern.
+     * Linear biases missing in the pattern are inserted afterwards.
+     *
+     * @param a scale of the quadratic biases
+     * @param b scale of the linear biases
+     * @param c scale of the sum of the quadratic biases of each variable added to its linear bias
+     * @param d scale of the sum of all quadratic biases added to the offset
+     * @param e scale of the sum of all linear biases added to the offset
+     */
+    template<typename T = DataType>
+    inline void _convert_vartype_inplace(
+        AccType a,
+        AccType b,
+        AccType c,
+        AccType d,
+        AccType e,
+        dispatch_t<T, Sparse> = nullptr ) {
+      const int64_t num_variables = _idx_to_label.size();
+      const int64_t last = _quadmat.rows() - 1;
+
+      AccVector colwise_sum = AccVector::Zero( num_variables );
+      AccType quad_sum = 0;
+      AccType lin_sum = 0;
+      std::vector<std::pair<int64_t, FloatType>> missing;
+
+      for ( int64_t r = 0; r < num_variables; r++ ) {
+        AccType rowwise_sum = 0;
+        FloatType *linear = nullptr;
+        for ( SpIter it( _quadmat, r ); it; ++it ) {
+          const int64_t col = it.col();
+          if ( col < num_variables ) {
+            const AccType val = it.value();
+            colwise_sum( col ) += val;
+            rowwise_sum += val;
+            quad_sum += val;
+            it.valueRef() = static_cast<FloatType>( a * val );
+          } else if ( col == last ) {
+            linear = &it.valueRef();
+          }
+        }
+
+        const AccType h = ( linear != nullptr ) ? *linear : 0;
+        const FloatType new_h = static_cast<FloatType>( b * h + c * ( colwise_sum( r ) + rowwise_sum ) );
+        lin_sum += h;
+        if ( linear != nullptr ) {
+          *linear = new_h;
+        } else if ( new_h != 0 ) {
+          missing.emplace_back( r, new_h );
+        }
+      }
+
+      m_offset += static_cast<FloatType>( d * quad_sum + e * lin_sum );
+
+      if ( !missing.empty() ) {
+        Eigen::VectorXi reserve_size = Eigen::VectorXi::Zero( _quadmat.outerSize() );
+        for ( const auto &it : missing ) {
+          reserve_size( it.first ) = 1;
+        }
+        _quadmat.reserve( reserve_size );
+        for ( const auto &it : missing ) {
+          _quadmat.insert( it.first, last ) = it.second;
+        }
+      }
+    }
+
     /**
      * @brief change internal variable from Ising to QUBO ones for dense matrix
      * The following conversion is applied:
@@ -936,23 +1676,25 @@ namespace cimod {
     template<typename T = DataType>
     inline void _spin_to_binary( dispatch_t<T, Dense> = nullptr ) {
       size_t num_variables = _idx_to_label.size();
+      size_t last = _quadmat.rows() - 1;
       m_vartype = Vartype::BINARY;
       // calc col(row)wise-sum ((num_variables, 1))
       // Vector colwise_sum = _quadmat.block(0,0,num_variables,num_variables).colwise().sum();
-      Vector colwise_sum( num_variables );
+      AccVector colwise_sum( num_variables );
       for ( size_t i = 0; i < num_variables; i++ ) {
-        colwise_sum( i ) = _quadmat.block( 0, 0, i, num_variables ).col( i ).sum();
+        colwise_sum( i ) = _quadmat.block( 0, 0, i, num_variables ).col( i ).template cast<AccType>().sum();
       }
 
-      Vector rowwise_sum = _quadmat.block( 0, 0, num_variables, num_variables ).rowwise().sum();
+      AccVector rowwise_sum
+          = _quadmat.block( 0, 0, num_variables, num_variables ).template cast<AccType>().rowwise().sum();
 
-      Vector local_field = _quadmat.block( 0, num_variables, num_variables, 1 );
+      AccVector local_field = _quadmat.block( 0, last, num_variables, 1 ).template cast<AccType>();
 
       // offset
-      m_offset += colwise_sum.sum() - local_field.sum();
+      m_offset += static_cast<FloatType>( colwise_sum.sum() - local_field.sum() );
 
       // local field
-      _quadmat.block( 0, num_variables, num_variables, 1 ) = 2 * local_field - 2 * ( colwise_sum + rowwise_sum );
+      _quadmat.block( 0, last, num_variables, 1 ) = ( 2 * local_field - 2 * ( colwise_sum + rowwise_sum ) ).template cast<FloatType>();
 
       // quadratic
       _quadmat.block( 0, 0, num_variables, num_variables ) *= 4;
@@ -974,68 +1716,8 @@ namespace cimod {
      */
     template<typename T = DataType>
     inline void _spin_to_binary( dispatch_t<T, Sparse> = nullptr ) {
-      size_t num_variables = _idx_to_label.size();
       m_vartype = Vartype::BINARY;
-      // calc col(row)wise-sum ((num_variables, 1))
-      // Vector colwise_sum = _quadmat.block(0,0,num_variables,num_variables).colwise().sum();
-      // Vector rowwise_sum = _quadmat.block(0,0,num_variables,num_variables).rowwise().sum();
-
-      Vector colwise_sum( num_variables );
-      Vector rowwise_sum( num_variables );
-      colwise_sum.setZero();
-      rowwise_sum.setZero();
-
-      for ( int k = 0; k < _quadmat.outerSize(); k++ ) {
-        // k -> row index
-        for ( SpIter it( _quadmat, k ); it; ++it ) {
-          size_t r = it.row();
-          size_t c = it.col();
-          FloatType val = it.value();
-
-          if ( ( r < num_variables ) && ( c < num_variables ) ) {
-            colwise_sum( c ) += val;
-            rowwise_sum( r ) += val;
-          }
-        }
-      }
-
-      Vector local_field = _quadmat.block( 0, num_variables, num_variables, 1 );
-
-      // offset
-      m_offset += colwise_sum.sum() - local_field.sum();
-
-      // local field
-      //_quadmat.block(0,num_variables,num_variables,1)
-      //    = 2 * local_field - 2 * (colwise_sum + rowwise_sum);
-
-      // quadratic
-      //_quadmat.block(0,0,num_variables,num_variables) *= 4;
-
-      Vector new_local_field = 2 * local_field - 2 * ( colwise_sum + rowwise_sum );
-
-      std::vector<Eigen::Triplet<FloatType>> triplets;
-      triplets.reserve( _quadmat.nonZeros() );
-      for ( size_t r = 0; r < num_variables; r++ ) {
-        triplets.emplace_back( r, num_variables, new_local_field( r ) );
-      }
-
-      for ( int k = 0; k < _quadmat.outerSize(); k++ ) {
-        // k -> row index
-        for ( SpIter it( _quadmat, k ); it; ++it ) {
-          size_t r = it.row();
-          size_t c = it.col();
-          FloatType val = it.value();
-
-          if ( ( r < num_variables ) && ( c < num_variables ) ) {
-            triplets.emplace_back( r, c, 4 * val );
-          }
-        }
-      }
-
-      triplets.emplace_back( num_variables, num_variables, 1 );
-
-      _quadmat = SparseMatrix( num_variables + 1, num_variables + 1 );
-      _quadmat.setFromTriplets( triplets.begin(), triplets.end() );
+      _convert_vartype_inplace( 4.0, 2.0, -2.0, 1.0, -1.0 );
     }
 
     /**
@@ -1055,22 +1737,24 @@ namespace cimod {
     template<typename T = DataType>
     inline void _binary_to_spin( dispatch_t<T, Dense> = nullptr ) {
       size_t num_variables = _idx_to_label.size();
+      size_t last = _quadmat.rows() - 1;
       m_vartype = Vartype::SPIN;
       // calc col(row)wise-sum ((num_variables, 1))
       // Vector colwise_sum = _quadmat.block(0,0,num_variables,num_variables).colwise().sum();
-      Vector colwise_sum( num_variables );
+      AccVector colwise_sum( num_variables );
       for ( size_t i = 0; i < num_variables; i++ ) {
-        colwise_sum( i ) = _quadmat.block( 0, 0, i, num_variables ).col( i ).sum();
+        colwise_sum( i ) = _quadmat.block( 0, 0, i, num_variables ).col( i ).template cast<AccType>().sum();
       }
-      Vector rowwise_sum = _quadmat.block( 0, 0, num_variables, num_variables ).rowwise().sum();
+      AccVector rowwise_sum
+          = _quadmat.block( 0, 0, num_variables, num_variables ).template cast<AccType>().rowwise().sum();
 
-      Vector local_field = _quadmat.block( 0, num_variables, num_variables, 1 );
+      AccVector local_field = _quadmat.block( 0, last, num_variables, 1 ).template cast<AccType>();
 
       // offset
-      m_offset += 0.25 * colwise_sum.sum() + 0.5 * local_field.sum();
+      m_offset += static_cast<FloatType>( 0.25 * colwise_sum.sum() + 0.5 * local_field.sum() );
 
       // local field
-      _quadmat.block( 0, num_variables, num_variables, 1 ) = 0.5 * local_field + 0.25 * ( colwise_sum + rowwise_sum );
+      _quadmat.block( 0, last, num_variables, 1 ) = ( 0.5 * local_field + 0.25 * ( colwise_sum + rowwise_sum ) ).template cast<FloatType>();
 
       // quadratic
       _quadmat.block( 0, 0, num_variables, num_variables ) *= 0.25;
@@ -1091,68 +1775,571 @@ namespace cimod {
      * \f]
      */
     template<typename T = DataType>
-    inline void _binary_to_spin( dispatch_t<T, Sparse> = nullptr ) {
-      size_t num_variables = _idx_to_label.size();
-      m_vartype = Vartype::SPIN;
-      // calc col(row)wise-sum ((num_variables, 1))
-      // Vector colwise_sum = _quadmat.block(0,0,num_variables,num_variables).colwise().sum();
-      // Vector rowwise_sum = _quadmat.block(0,0,num_variables,num_variables).rowwise().sum();
-
-      Vector colwise_sum( num_variables );
-      Vector rowwise_sum( num_variables );
-      colwise_sum.setZero();
-      rowwise_sum.setZero();
-
-      for ( int k = 0; k < _quadmat.outerSize(); k++ ) {
-        // k -> row index
-        for ( SpIter it( _quadmat, k ); it; ++it ) {
-          size_t r = it.row();
-          size_t c = it.col();
-          FloatType val = it.value();
+    inline void _binary_to_spin( dispatch_t<T, Sparse> = nullptr ) {
+      m_vartype = Vartype::SPIN;
+      _convert_vartype_inplace( 0.25, 0.5, 0.25, 0.25, 0.5 );
+    }
+
+    /**
+     * @brief write the model in the PACKED payload of the binary format for dense matrix
+     *
+     * @param path
+     */
+    template<typename T = DataType>
+    inline void _save_binary( const std::string &path, dispatch_t<T, Dense> = nullptr ) const {
+      const size_t N = get_num_variables();
+      const std::vector<size_t> indices = _generate_sorted_indices();
+
+      std::vector<FloatType> linear( N );
+      std::vector<FloatType> upper( N * ( N - 1 ) / 2 );
+      for ( size_t j = 0; j < N; j++ ) {
+        linear[ j ] = _mat_idx( indices[ j ] );
+        FloatType *column = upper.data() + j * ( j - 1 ) / 2;
+        for ( size_t i = 0; i < j; i++ ) {
+          column[ i ] = _mat_idx( indices[ i ], indices[ j ] );
+        }
+      }
+      write_binary_packed( path, get_variables(), linear.data(), upper.data(), m_offset, m_vartype );
+    }
+
+    /**
+     * @brief write the model in the CSR payload of the binary format for sparse matrix
+     *
+     * @param path
+     */
+    template<typename T = DataType>
+    inline void _save_binary( const std::string &path, dispatch_t<T, Sparse> = nullptr ) const {
+      const size_t N = get_num_variables();
+      const size_t last = _quadmat.cols() - 1;
+      const std::vector<size_t> ranks = _generate_sorted_ranks();
+
+      std::vector<FloatType> linear( N, 0 );
+      std::vector<std::vector<std::pair<uint32_t, FloatType>>> rows( N );
+      for ( size_t r = 0; r < N; r++ ) {
+        for ( SpIter it( _quadmat, r ); it; ++it ) {
+          const size_t c = it.col();
+          if ( c == last ) {
+            linear[ ranks[ r ] ] = it.value();
+          } else if ( c < N && it.value() != 0 ) {
+            const size_t i = std::min( ranks[ r ], ranks[ c ] );
+            const size_t j = std::max( ranks[ r ], ranks[ c ] );
+            rows[ i ].emplace_back( static_cast<uint32_t>( j ), it.value() );
+          }
+        }
+      }
+      if ( !_sorted ) {
+        for ( auto &row : rows ) {
+          std::sort( row.begin(), row.end() );
+        }
+      }
+      write_binary_csr( path, get_variables(), linear, rows, m_offset, m_vartype );
+    }
+
+    /**
+     * @brief set labels read from a binary file
+     *
+     * @param labels
+     */
+    inline void _set_binary_labels( std::vector<IndexType> &&labels ) {
+      _idx_to_label = std::move( labels );
+      _set_label_to_idx();
+      if ( _label_to_idx.size() != _idx_to_label.size() ) {
+        throw std::runtime_error( "the binary file contains duplicated labels." );
+      }
+      _sorted = std::is_sorted( _idx_to_label.begin(), _idx_to_label.end() );
+      _sorted_labels_flag.reset();
+    }
+
+    /**
+     * @brief fill _quadmat from the payload of a binary file for dense matrix
+     *
+     * @param payload
+     */
+    template<typename T = DataType>
+    inline void _load_binary( const BinaryQuadraticPayload<FloatType> &payload, dispatch_t<T, Dense> = nullptr ) {
+      const size_t N = payload.num_variables;
+      _quadmat = Matrix::Zero( N + 1, N + 1 );
+      if ( payload.kind == BinaryPayload::PACKED ) {
+        for ( size_t j = 1; j < N; j++ ) {
+          _quadmat.col( j ).head( j ) = Eigen::Map<const Vector>( payload.upper + j * ( j - 1 ) / 2, j );
+        }
+      } else {
+        payload.for_each_interaction( [ this ]( size_t i, size_t j, FloatType bias ) { _quadmat( i, j ) = bias; } );
+      }
+      _quadmat.col( N ).head( N ) = Eigen::Map<const Vector>( payload.linear, N );
+      _quadmat( N, N ) = 1;
+    }
+
+    /**
+     * @brief fill _quadmat from the payload of a binary file for sparse matrix
+     * the elements are inserted row by row in increasing column order after reserving each row.
+     *
+     * @param payload
+     */
+    template<typename T = DataType>
+    inline void _load_binary( const BinaryQuadraticPayload<FloatType> &payload, dispatch_t<T, Sparse> = nullptr ) {
+      const size_t N = payload.num_variables;
+      Eigen::VectorXi row_size = Eigen::VectorXi::Ones( N + 1 );
+      payload.for_each_interaction( [ &row_size ]( size_t i, size_t, FloatType ) { row_size( i )++; } );
+
+      _quadmat = SparseMatrix( N + 1, N + 1 );
+      _quadmat.reserve( row_size );
+      payload.for_each_interaction(
+          [ this ]( size_t i, size_t j, FloatType bias ) { _quadmat.insert( i, j ) = bias; } );
+      for ( size_t i = 0; i < N; i++ ) {
+        if ( payload.linear[ i ] != 0 ) {
+          _quadmat.insert( i, N ) = payload.linear[ i ];
+        }
+      }
+      _quadmat.insert( N, N ) = 1;
+      _quadmat.makeCompressed();
+    }
+
+    /**
+     * @brief delete rows and columns of _quadmat marked as removed at once for dense matrix
+     * the remaining rows and columns are moved forward in place and the capacity of _quadmat is kept.
+     *
+     * @param removed
+     * @param linear_delta added to the linear biases of the remaining variables (ignored if empty)
+     */
+    template<typename T = DataType>
+    inline void _delete_indices_from_mat(
+        const std::vector<char> &removed,
+        const Vector &linear_delta,
+        dispatch_t<T, Dense> = nullptr ) {
+      size_t N = get_num_variables();
+      size_t last = _quadmat.rows() - 1;
+
+      // destination (ni, nj) never exceeds source (i, j), so rows and columns can be moved in place
+      size_t ni = 0;
+      for ( size_t i = 0; i < N; i++ ) {
+        if ( removed[ i ] )
+          continue;
+        size_t nj = ni;
+        for ( size_t j = i; j < N; j++ ) {
+          if ( removed[ j ] )
+            continue;
+          _quadmat( ni, nj ) = _quadmat( i, j );
+          nj++;
+        }
+        _quadmat( ni, last ) = _quadmat( i, last ) + ( linear_delta.size() > 0 ? linear_delta( i ) : 0 );
+        ni++;
+      }
+
+      // clear vacated rows and columns
+      _quadmat.block( ni, 0, N - ni, _quadmat.cols() ).setZero();
+      _quadmat.block( 0, ni, ni, N - ni ).setZero();
+    }
+
+    /**
+     * @brief delete rows and columns of _quadmat marked as removed at once for sparse matrix
+     * the capacity of _quadmat is kept.
+     *
+     * @param removed
+     * @param linear_delta added to the linear biases of the remaining variables (ignored if empty)
+     */
+    template<typename T = DataType>
+    inline void _delete_indices_from_mat(
+        const std::vector<char> &removed,
+        const Vector &linear_delta,
+        dispatch_t<T, Sparse> = nullptr ) {
+      size_t N = get_num_variables();
+      size_t last = _quadmat.rows() - 1;
+
+      // old index -> new index
+      std::vector<size_t> new_index( N );
+      size_t ni = 0;
+      for ( size_t i = 0; i < N; i++ ) {
+        new_index[ i ] = ni;
+        if ( !removed[ i ] )
+          ni++;
+      }
+
+      std::vector<Eigen::Triplet<FloatType>> triplets;
+      triplets.reserve( _quadmat.nonZeros() + linear_delta.size() );
+
+      for ( int k = 0; k < _quadmat.outerSize(); k++ ) {
+        for ( SpIter it( _quadmat, k ); it; ++it ) {
+          size_t r = it.row();
+          size_t c = it.col();
+
+          if ( ( r != last && removed[ r ] ) || ( c != last && removed[ c ] ) )
+            continue;
+
+          triplets.emplace_back( r == last ? last : new_index[ r ], c == last ? last : new_index[ c ], it.value() );
+        }
+      }
+
+      for ( Eigen::Index i = 0; i < linear_delta.size(); i++ ) {
+        if ( !removed[ i ] && linear_delta( i ) != 0 )
+          triplets.emplace_back( new_index[ i ], last, linear_delta( i ) );
+      }
+
+      // NOTE: duplicated elements are summed up.
+      _quadmat.setFromTriplets( triplets.begin(), triplets.end() );
+    }
+
+    /**
+     * @brief delete variables marked as removed at once
+     * the matrix is compacted in a single pass and the label index is rebuilt once.
+     *
+     * @param removed
+     * @param linear_delta added to the linear biases of the remaining variables (ignored if empty)
+     */
+    inline void _delete_indices( const std::vector<char> &removed, const Vector &linear_delta = Vector() ) {
+      if ( std::find( removed.begin(), removed.end(), true ) == removed.end() && linear_delta.size() == 0 ) {
+        return;
+      }
+
+      _delete_indices_from_mat( removed, linear_delta );
+
+      size_t n = 0;
+      for ( size_t i = 0; i < _idx_to_label.size(); i++ ) {
+        if ( !removed[ i ] ) {
+          _idx_to_label[ n++ ] = std::move( _idx_to_label[ i ] );
+        }
+      }
+      _idx_to_label.resize( n );
+      _set_label_to_idx();
+      _sorted_labels_flag.reset();
+    }
+
+    /**
+     * @brief build the column index of the off-diagonal interactions for sparse matrix (called through _col_flag)
+     * the interactions are counted per column and scattered row by row, so the rows are sorted in each column.
+     */
+    template<typename T = DataType>
+    inline void _build_columns( dispatch_t<T, Sparse> = nullptr ) const {
+      const size_t N = get_num_variables();
+      _col_ptr.assign( N + 1, 0 );
+      for ( size_t i = 0; i < N; i++ ) {
+        for ( SpIter it( _quadmat, i ); it; ++it ) {
+          size_t j = it.col();
+          if ( j > i && j < N )
+            _col_ptr[ j + 1 ]++;
+        }
+      }
+      std::partial_sum( _col_ptr.begin(), _col_ptr.end(), _col_ptr.begin() );
+
+      _col_row.resize( _col_ptr[ N ] );
+      _col_value.resize( _col_ptr[ N ] );
+      std::vector<StorageIndex> next( _col_ptr.begin(), _col_ptr.end() - 1 );
+      for ( size_t i = 0; i < N; i++ ) {
+        for ( SpIter it( _quadmat, i ); it; ++it ) {
+          size_t j = it.col();
+          if ( j > i && j < N ) {
+            StorageIndex k = next[ j ]++;
+            _col_row[ k ] = static_cast<StorageIndex>( i );
+            _col_value[ k ] = it.value();
+          }
+        }
+      }
+    }
+
+    /**
+     * @brief neighbors of the variable with index i for dense matrix
+     * column i above the diagonal and row i up to the last variable are viewed in place.
+     *
+     * @param i
+     *
+     * @return range of the neighbors
+     */
+    template<typename T = DataType>
+    inline NeighborRange<IndexType, FloatType> _neighbors( size_t i, dispatch_t<T, Dense> = nullptr ) const {
+      using Segment = typename NeighborRange<IndexType, FloatType>::Segment;
+      const int64_t N = get_num_variables();
+      const int64_t stride = _quadmat.cols();
+
+      Segment column;
+      column.value = _quadmat.data() + i;
+      column.stride = stride;
+      column.size = i;
+
+      Segment row;
+      row.value = _quadmat.data() + i * stride + i + 1;
+      row.size = N - i - 1;
+      row.base = i + 1;
+      return NeighborRange<IndexType, FloatType>( _idx_to_label.data(), column, row );
+    }
+
+    /**
+     * @brief neighbors of the variable with index i for sparse matrix
+     * column i is taken from the column index (generated if it is out of date) and row i is viewed in place.
+     *
+     * @param i
+     *
+     * @return range of the neighbors
+     */
+    template<typename T = DataType>
+    inline NeighborRange<IndexType, FloatType> _neighbors( size_t i, dispatch_t<T, Sparse> = nullptr ) const {
+      using Segment = typename NeighborRange<IndexType, FloatType>::Segment;
+      _col_flag.call( [ this ]() { _build_columns(); } );
+      const StorageIndex N = static_cast<StorageIndex>( get_num_variables() );
+
+      Segment column;
+      column.index = _col_row.data() + _col_ptr[ i ];
+      column.value = _col_value.data() + _col_ptr[ i ];
+      column.size = _col_ptr[ i + 1 ] - _col_ptr[ i ];
+
+      // the inner indices of a row are sorted; skip the diagonal and the linear column
+      const StorageIndex *inner = _quadmat.innerIndexPtr();
+      const StorageIndex begin = _quadmat.outerIndexPtr()[ i ];
+      const StorageIndex end
+          = _quadmat.isCompressed() ? _quadmat.outerIndexPtr()[ i + 1 ] : begin + _quadmat.innerNonZeroPtr()[ i ];
+      const StorageIndex *first = std::upper_bound( inner + begin, inner + end, static_cast<StorageIndex>( i ) );
+      const StorageIndex *last = std::lower_bound( first, inner + end, N );
+
+      Segment row;
+      row.index = first;
+      row.value = _quadmat.valuePtr() + ( first - inner );
+      row.size = last - first;
+      return NeighborRange<IndexType, FloatType>( _idx_to_label.data(), column, row );
+    }
+
+    /**
+     * @brief fold fixed variables into the linear biases and the offset
+     * only the neighbors of the fixed variables are visited. neighbors that are left without any interaction and
+     * linear bias are also marked as removed, as remove_interaction does.
+     *
+     * @param is_fixed
+     * @param values values of the fixed variables
+     * @param removed [out] variables to be removed
+     * @param linear_delta [out] changes of the linear biases
+     */
+    inline void _fold_fixed_indices(
+        const std::vector<char> &is_fixed,
+        const std::vector<int32_t> &values,
+        std::vector<char> &removed,
+        Vector &linear_delta ) {
+      size_t N = get_num_variables();
+      size_t last = _quadmat.rows() - 1;
+      linear_delta = Vector::Zero( N );
+      std::vector<char> touched( N, false );
+
+      for ( size_t i = 0; i < N; i++ ) {
+        if ( !is_fixed[ i ] )
+          continue;
+        m_offset += _quadmat.coeff( i, last ) * values[ i ];
+        const auto range = _neighbors( i );
+        for ( auto it = range.begin(); it != range.end(); ++it ) {
+          size_t j = it.id();
+          if ( !is_fixed[ j ] ) {
+            linear_delta( j ) += it.bias() * values[ i ];
+            touched[ j ] = true;
+          } else if ( j < i ) {
+            // pairs of fixed variables are counted once
+            m_offset += it.bias() * values[ i ] * values[ j ];
+          }
+        }
+      }
+
+      removed = is_fixed;
+      for ( size_t j = 0; j < N; j++ ) {
+        if ( !touched[ j ] )
+          continue;
+        FloatType row_norm = std::pow( _quadmat.coeff( j, last ) + linear_delta( j ), 2 );
+        FloatType col_norm = 0;
+        const auto range = _neighbors( j );
+        for ( auto it = range.begin(); it != range.end(); ++it ) {
+          size_t k = it.id();
+          if ( is_fixed[ k ] )
+            continue;
+          if ( k < j )
+            col_norm += it.bias() * it.bias();
+          else
+            row_norm += it.bias() * it.bias();
+        }
+        if ( row_norm <= std::numeric_limits<FloatType>::epsilon()
+             && col_norm <= std::numeric_limits<FloatType>::epsilon() ) {
+          removed[ j ] = true;
+        }
+      }
+    }
+
+    /**
+     * @brief flip the binary variable with index i (x_i -> 1 - x_i) for dense matrix
+     * The following conversion is applied:
+     *
+     * \f[
+     * \mathrm{offset} += h_{i},\quad h_{i} \to -h_{i},\quad h_{j} += Q_{ij},\quad Q_{ij} \to -Q_{ij}
+     * \f]
+     *
+     * @param i
+     */
+    template<typename T = DataType>
+    inline void _flip_binary_variable( size_t i, dispatch_t<T, Dense> = nullptr ) {
+      size_t N = get_num_variables();
+      size_t M = N - i - 1;
+      size_t last = _quadmat.rows() - 1;
+
+      // interactions with j < i
+      _quadmat.block( 0, last, i, 1 ) += _quadmat.block( 0, i, i, 1 );
+      _quadmat.block( 0, i, i, 1 ) *= -1;
+
+      // interactions with j > i
+      _quadmat.block( i + 1, last, M, 1 ) += _quadmat.block( i, i + 1, 1, M ).transpose();
+      _quadmat.block( i, i + 1, 1, M ) *= -1;
+
+      // linear
+      m_offset += _quadmat( i, last );
+      _quadmat( i, last ) *= -1;
+    }
+
+    /**
+     * @brief flip the binary variable with index i (x_i -> 1 - x_i) for sparse matrix
+     * The following conversion is applied:
+     *
+     * \f[
+     * \mathrm{offset} += h_{i},\quad h_{i} \to -h_{i},\quad h_{j} += Q_{ij},\quad Q_{ij} \to -Q_{ij}
+     * \f]
+     *
+     * Row i is traversed directly and column i is taken from the column index, so only the existing nonzeros of the
+     * neighbors are visited. Each of them is located by a binary search in the row (or column) of the neighbor, so a
+     * flip takes O(d log d_max) for degree d and maximum degree d_max. The column index is updated in place and kept
+     * valid. Elements are inserted only for the linear biases of neighbors that are not stored yet.
+     *
+     * @param i
+     */
+    template<typename T = DataType>
+    inline void _flip_binary_variable( size_t i, dispatch_t<T, Sparse> = nullptr ) {
+      _col_flag.call( [ this ]() { _build_columns(); } );
+      const size_t N = get_num_variables();
+      const StorageIndex last = static_cast<StorageIndex>( _quadmat.rows() - 1 );
+
+      const StorageIndex *outer = _quadmat.outerIndexPtr();
+      const StorageIndex *inner_nnz = _quadmat.innerNonZeroPtr();
+      const StorageIndex *inner = _quadmat.innerIndexPtr();
+      FloatType *values = _quadmat.valuePtr();
+      auto row_end = [ & ]( size_t j ) {
+        return ( inner_nnz != nullptr ) ? inner + outer[ j ] + inner_nnz[ j ] : inner + outer[ j + 1 ];
+      };
+      // the linear bias is the last element of a row if it is stored
+      auto linear_bias = [ & ]( size_t j ) -> FloatType * {
+        const StorageIndex *end = row_end( j );
+        return ( end != inner + outer[ j ] && end[ -1 ] == last ) ? values + ( end - 1 - inner ) : nullptr;
+      };
+
+      // neighbors and their (original) interactions
+      std::vector<std::pair<size_t, FloatType>> neighbors;
+      neighbors.reserve( _col_ptr[ i + 1 ] - _col_ptr[ i ] + ( row_end( i ) - ( inner + outer[ i ] ) ) );
+
+      // interactions with j < i
+      for ( StorageIndex k = _col_ptr[ i ]; k < _col_ptr[ i + 1 ]; k++ ) {
+        const size_t j = _col_row[ k ];
+        const StorageIndex *pos = std::lower_bound( inner + outer[ j ], row_end( j ), static_cast<StorageIndex>( i ) );
+        FloatType &val = values[ pos - inner ];
+        neighbors.emplace_back( j, val );
+        val = -val;
+        _col_value[ k ] = val;
+      }
 
-          if ( ( r < num_variables ) && ( c < num_variables ) ) {
-            colwise_sum( c ) += val;
-            rowwise_sum( r ) += val;
-          }
+      // interactions with j > i
+      for ( const StorageIndex *pos = inner + outer[ i ]; pos != row_end( i ); pos++ ) {
+        const size_t c = *pos;
+        if ( c > i && c < N ) {
+          FloatType &val = values[ pos - inner ];
+          neighbors.emplace_back( c, val );
+          val = -val;
+          auto first = _col_row.begin() + _col_ptr[ c ];
+          auto found = std::lower_bound( first, _col_row.begin() + _col_ptr[ c + 1 ], static_cast<StorageIndex>( i ) );
+          _col_value[ found - _col_row.begin() ] = val;
         }
       }
 
-      Vector local_field = _quadmat.block( 0, num_variables, num_variables, 1 );
+      // linear
+      if ( FloatType *h_i = linear_bias( i ) ) {
+        m_offset += *h_i;
+        *h_i = -*h_i;
+      }
+      std::vector<std::pair<size_t, FloatType>> missing;
+      for ( const auto &it : neighbors ) {
+        if ( FloatType *h_j = linear_bias( it.first ) ) {
+          *h_j += it.second;
+        } else {
+          missing.push_back( it );
+        }
+      }
+      // coeffRef may reallocate the storage, so it is called after all the pointers are used
+      for ( const auto &it : missing ) {
+        _quadmat.coeffRef( it.first, last ) += it.second;
+      }
+    }
 
-      // offset
-      m_offset += 0.25 * colwise_sum.sum() + 0.5 * local_field.sum();
+    /**
+     * @brief calculate energies of samples block by block as \f$\mathrm{rowwise\ sum}((S Q) \circ S)\f$
+     * blocks of samples are processed in parallel.
+     *
+     * @tparam FillBlock
+     * @param num_samples
+     * @param fill_block callable (SampleMatrix &S, size_t begin) that sets the samples [begin, begin + S.rows()) to S.
+     * S is zero-initialized and its column index corresponds to the index of the variable.
+     *
+     * @return energies
+     */
+    template<typename FillBlock>
+    inline std::vector<FloatType> _energies( size_t num_samples, FillBlock fill_block ) const {
+      const size_t block_size = 256;
+      const size_t mat_size = _quadmat.rows();
+      const int64_t num_blocks = ( num_samples + block_size - 1 ) / block_size;
+      std::vector<FloatType> en_vec( num_samples );
 
-      // local field
-      //_quadmat.block(0,num_variables,num_variables,1)
-      //    = 0.5 * local_field + 0.25 * (colwise_sum + rowwise_sum);
+#pragma omp parallel for
+      for ( int64_t b = 0; b < num_blocks; b++ ) {
+        const size_t begin = b * block_size;
+        const size_t length = std::min( block_size, num_samples - begin );
 
-      // quadratic
-      // quadmat.block(0,0,num_variables,num_variables) *= 0.25;
+        SampleMatrix S = SampleMatrix::Zero( length, mat_size );
+        fill_block( S, begin );
+        S.col( mat_size - 1 ).setOnes();
 
-      Vector new_local_field = 0.5 * local_field + 0.25 * ( colwise_sum + rowwise_sum );
+        // the product is taken in FloatType and reduced in AccType
+        AccVector en = ( S * _quadmat ).template cast<AccType>().cwiseProduct( S.template cast<AccType>() ).rowwise().sum();
+        for ( size_t k = 0; k < length; k++ ) {
+          en_vec[ begin + k ] = static_cast<FloatType>( en( k ) + m_offset - 1 );
+        }
+      }
+      return en_vec;
+    }
 
-      std::vector<Eigen::Triplet<FloatType>> triplets;
-      triplets.reserve( _quadmat.nonZeros() );
-      for ( size_t r = 0; r < num_variables; r++ ) {
-        triplets.emplace_back( r, num_variables, new_local_field( r ) );
+    /**
+     * @brief calculate \f$s^T Q s\f$ in AccType for dense matrix
+     *
+     * @param s sample vector whose last element is 1
+     *
+     * @return quadratic form
+     */
+    template<typename T = DataType>
+    inline AccType _quadratic_form( const AccVector &s, dispatch_t<T, Dense> = nullptr ) const {
+      AccType en = 0;
+      for ( int64_t i = 0; i < _quadmat.rows(); i++ ) {
+        if ( s[ i ] != 0 ) {
+          en += s[ i ] * _quadmat.row( i ).template cast<AccType>().dot( s.transpose() );
+        }
       }
+      return en;
+    }
 
+    /**
+     * @brief calculate \f$s^T Q s\f$ in AccType for sparse matrix
+     *
+     * @param s sample vector whose last element is 1
+     *
+     * @return quadratic form
+     */
+    template<typename T = DataType>
+    inline AccType _quadratic_form( const AccVector &s, dispatch_t<T, Sparse> = nullptr ) const {
+      AccType en = 0;
       for ( int k = 0; k < _quadmat.outerSize(); k++ ) {
-        // k -> row index
+        if ( s[ k ] == 0 ) {
+          continue;
+        }
+        AccType row_sum = 0;
         for ( SpIter it( _quadmat, k ); it; ++it ) {
-          size_t r = it.row();
-          size_t c = it.col();
-          FloatType val = it.value();
-
-          if ( ( r < num_variables ) && ( c < num_variables ) ) {
-            triplets.emplace_back( r, c, 0.25 * val );
-          }
+          row_sum += static_cast<AccType>( it.value() ) * s[ it.col() ];
         }
+        en += s[ k ] * row_sum;
       }
-
-      triplets.emplace_back( num_variables, num_variables, 1 );
-
-      _quadmat.setFromTriplets( triplets.begin(), triplets.end() );
+      return en;
     }
 
   public:
@@ -1258,6 +2445,43 @@ namespace cimod {
         BinaryQuadraticModel( mat, labels_vec, 0.0, vartype ) {
     }
 
+    /**
+     * @brief BinaryQuadraticModel constructor (with sparse matrix);
+     * this constructor is for developers. The storage of mat is taken over without a copy for sparse matrix.
+     *
+     * @param mat
+     * @param labels_vec
+     * @param offset
+     * @param vartype
+     *
+     */
+    BinaryQuadraticModel(
+        SparseMatrix &&mat,
+        const std::vector<IndexType> &labels_vec,
+        const FloatType &offset,
+        const Vartype vartype ) :
+        m_offset( offset ),
+        m_vartype( vartype ) {
+      _initialize_quadmat( std::move( mat ), labels_vec );
+    }
+
+    /**
+     * @brief BinaryQuadraticModel constructor.
+     * Creates a model without biases whose variables are the labels of the table, so that the ids of the model
+     * coincide with the ids of the table until a variable is removed.
+     *
+     * @param labels
+     * @param vartype
+     */
+    BinaryQuadraticModel( const LabelTable<IndexType> &labels, const Vartype vartype ) :
+        BinaryQuadraticModel( Linear<IndexType, FloatType>{}, Quadratic<IndexType, FloatType>{}, 0.0, vartype ) {
+      _reserve_mat( labels.size() );
+      _label_to_idx.reserve( labels.size() );
+      for ( const auto &it : labels.labels() ) {
+        _add_new_label( it );
+      }
+    }
+
     BinaryQuadraticModel( const BinaryQuadraticModel & ) = default;
 
     /**
@@ -1329,6 +2553,49 @@ namespace cimod {
       return _generate_quadratic();
     }
 
+    /**
+     * @brief Get the neighbors of variable v.
+     * The range refers to the interaction matrix without generating a map, and yields pairs of the label of a neighbor
+     * and the quadratic bias. For the sparse matrix, the first call after a change of the model generates a column
+     * index of the interactions. The range is invalidated by any change of the model.
+     *
+     * @param v
+     *
+     * @return range of the neighbors
+     */
+    NeighborRange<IndexType, FloatType> neighbors( const IndexType &v ) const {
+      return _neighbors( _label_to_idx.at( v ) );
+    }
+
+    /**
+     * @brief Get the number of neighbors of variable v.
+     *
+     * @param v
+     *
+     * @return degree
+     */
+    size_t degree( const IndexType &v ) const {
+      return neighbors( v ).size();
+    }
+
+    /**
+     * @brief Get the adjacency list of the model.
+     * Every interaction is stored in both directions.
+     *
+     * @return adjacency list
+     */
+    Adjacency<IndexType, FloatType> get_adjacency() const {
+      Adjacency<IndexType, FloatType> adjacency;
+      adjacency.reserve( get_num_variables() );
+      for ( size_t i = 0; i < get_num_variables(); i++ ) {
+        auto &adjacent = adjacency[ _idx_to_label[ i ] ];
+        for ( const auto &it : _neighbors( i ) ) {
+          adjacent.emplace( it.first, it.second );
+        }
+      }
+      return adjacency;
+    }
+
     /**
      * @brief Get the offset
      *
@@ -1347,13 +2614,84 @@ namespace cimod {
       return this->m_vartype;
     }
 
+    /**
+     * @brief Get the version of the model.
+     * The version is advanced by every change of the model, so that snapshots of get_linear() and get_quadratic()
+     * can be reused while the version stays the same.
+     *
+     * @return version
+     */
+    uint64_t get_version() const {
+      return _version;
+    }
+
     /**
      * @brief Get variables
+     * the sorted list is generated lazily if variables have been added out of order.
      *
      * @return variables
      */
     const std::vector<IndexType> &get_variables() const {
-      return this->_idx_to_label;
+      if ( _sorted ) {
+        return this->_idx_to_label;
+      }
+
+      _sorted_labels_flag.call( [ this ]() {
+        std::vector<size_t> indices = _generate_sorted_indices();
+        _sorted_labels.clear();
+        _sorted_labels.reserve( indices.size() );
+        for ( size_t i : indices ) {
+          _sorted_labels.push_back( _idx_to_label[ i ] );
+        }
+      } );
+      return _sorted_labels;
+    }
+
+    /**
+     * @brief Get the id of variable v.
+     * Ids are the contiguous internal indices of the variables in the order they were added. They stay valid until a
+     * variable is removed, fixed or the model is reconstructed.
+     *
+     * @param v
+     *
+     * @return id
+     */
+    LabelId get_id( const IndexType &v ) const {
+      return static_cast<LabelId>( _label_to_idx.at( v ) );
+    }
+
+    /**
+     * @brief Get the label of an id
+     *
+     * @param id
+     *
+     * @return label
+     */
+    const IndexType &get_label( LabelId id ) const {
+      return _idx_to_label[ _check_id( id ) ];
+    }
+
+    /**
+     * @brief Get the linear bias of the variable with the specified id
+     *
+     * @param id
+     *
+     * @return A linear bias.
+     */
+    FloatType get_linear_id( LabelId id ) const {
+      return _mat_idx( _check_id( id ) );
+    }
+
+    /**
+     * @brief Get the quadratic bias between the variables with the specified ids
+     *
+     * @param id_i
+     * @param id_j
+     *
+     * @return A quadratic bias.
+     */
+    FloatType get_quadratic_id( LabelId id_i, LabelId id_j ) const {
+      return _mat_idx( _check_id( id_i ), _check_id( id_j ) );
     }
 
     /**
@@ -1375,6 +2713,7 @@ namespace cimod {
      * @param bias
      */
     void add_variable( const IndexType &v, const FloatType &bias ) {
+      _on_modified();
       // add new label if not exist
       _add_new_label( v );
       _mat( v ) += bias;
@@ -1399,12 +2738,36 @@ namespace cimod {
      * @param bias
      */
     void add_interaction( const IndexType &u, const IndexType &v, const FloatType &bias ) {
+      _on_modified();
       // add labels u and v
       _add_new_label( u );
       _add_new_label( v );
       _mat( u, v ) += bias;
     }
 
+    /**
+     * @brief Add the bias of the existing variable with the specified id.
+     *
+     * @param id
+     * @param bias
+     */
+    void add_variable_id( LabelId id, const FloatType &bias ) {
+      _on_modified();
+      _mat_idx( _check_id( id ) ) += bias;
+    }
+
+    /**
+     * @brief Add the quadratic bias between the existing variables with the specified ids.
+     *
+     * @param id_i
+     * @param id_j
+     * @param bias
+     */
+    void add_interaction_id( LabelId id_i, LabelId id_j, const FloatType &bias ) {
+      _on_modified();
+      _mat_idx( _check_id( id_i ), _check_id( id_j ) ) += bias;
+    }
+
     /**
      * @brief Add interactions and/or quadratic biases to a binary quadratic model.
      *
@@ -1422,18 +2785,26 @@ namespace cimod {
      * @param v
      */
     void remove_variable( const IndexType &v ) {
+      _on_modified();
       _delete_label( v );
     }
 
     /**
      * @brief Remove specified variables and all of their interactions from a binary quadratic model.
+     * The matrix is compacted once for all the variables.
      *
      * @param variables
      */
     void remove_variables_from( const std::vector<IndexType> &variables ) {
-      for ( auto &it : variables ) {
-        remove_variable( it );
+      _on_modified();
+      std::vector<char> removed( get_num_variables(), false );
+      for ( const auto &it : variables ) {
+        auto position = _label_to_idx.find( it );
+        if ( position != _label_to_idx.end() ) {
+          removed[ position->second ] = true;
+        }
       }
+      _delete_indices( removed );
     }
 
     /**
@@ -1443,6 +2814,7 @@ namespace cimod {
      * @param v
      */
     void remove_interaction( const IndexType &u, const IndexType &v ) {
+      _on_modified();
       _mat( u, v ) = 0;
       _delete_label( u, false );
       _delete_label( v, false );
@@ -1465,6 +2837,7 @@ namespace cimod {
      * @param offset
      */
     void add_offset( const FloatType &offset ) {
+      _version++;
       m_offset += offset;
     }
 
@@ -1490,9 +2863,11 @@ namespace cimod {
         const bool ignored_offset = false ) {
       if ( scalar == 0.0 )
         throw std::runtime_error( "scalar must not be zero" );
+      _on_modified();
 
-      // scale
+      // scale in place and keep the constant element of the last row
       _quadmat *= scalar;
+      _quadmat_get( _quadmat.rows() - 1, _quadmat.cols() - 1 ) = 1.0;
 
       // revert scale of linear
       for ( const auto &it : ignored_variables ) {
@@ -1539,15 +2914,14 @@ namespace cimod {
       }
 
       // calculate scaling value
-      FloatType lin_min = _min_linear();
-      FloatType lin_max = _max_linear();
-      FloatType quad_min = _min_quadratic();
-      FloatType quad_max = _max_quadratic();
-
-      std::vector<FloatType> v_scale
-          = { lin_min / l_range.first, lin_max / l_range.second, quad_min / q_range.first, quad_max / q_range.second };
+      const auto ranges = _bias_ranges();
+      const auto &lin = ranges.first;
+      const auto &quad = ranges.second;
 
-      FloatType inv_scale = *std::max_element( v_scale.begin(), v_scale.end() );
+      FloatType inv_scale = std::max( { lin.first / l_range.first,
+                                        lin.second / l_range.second,
+                                        quad.first / q_range.first,
+                                        quad.second / q_range.second } );
 
       // scaling
       if ( inv_scale != 0.0 ) {
@@ -1562,31 +2936,38 @@ namespace cimod {
      * @param value
      */
     void fix_variable( const IndexType &v, const int32_t &value ) {
-      std::vector<std::pair<IndexType, IndexType>> interactions;
-      const Quadratic<IndexType, FloatType> &quadratic = this->get_quadratic();
-      for ( const auto &it : quadratic ) {
-        if ( it.first.first == v ) {
-          add_variable( it.first.second, value * it.second );
-          interactions.push_back( it.first );
-        } else if ( it.first.second == v ) {
-          add_variable( it.first.first, value * it.second );
-          interactions.push_back( it.first );
-        }
-      }
-      remove_interactions_from( interactions );
-      add_offset( _mat( v ) * value );
-      remove_variable( v );
+      fix_variables( { std::make_pair( v, value ) } );
     }
 
     /**
      * @brief Fix the value of the variables and remove it from a binary quadratic model.
+     * The interactions of the fixed variables are folded into the linear biases and the offset,
+     * and the matrix is compacted once for the whole batch.
      *
      * @param fixed
      */
     void fix_variables( const std::vector<std::pair<IndexType, int32_t>> &fixed ) {
-      for ( auto &it : fixed ) {
-        fix_variable( it.first, it.second );
+      if ( fixed.empty() ) {
+        return;
+      }
+
+      size_t N = get_num_variables();
+      std::vector<char> is_fixed( N, false );
+      std::vector<int32_t> values( N, 0 );
+      for ( const auto &it : fixed ) {
+        size_t i = _label_to_idx.at( it.first );
+        if ( is_fixed[ i ] ) {
+          throw std::runtime_error( "the same variable is fixed more than once." );
+        }
+        is_fixed[ i ] = true;
+        values[ i ] = it.second;
       }
+
+      std::vector<char> removed;
+      Vector linear_delta;
+      _fold_fixed_indices( is_fixed, values, removed, linear_delta );
+      _delete_indices( removed, linear_delta );
+      _on_modified();
     }
 
     /**
@@ -1595,21 +2976,15 @@ namespace cimod {
      * @param v
      */
     void flip_variable( const IndexType &v ) {
-
+      size_t i = _label_to_idx.at( v );
       if ( m_vartype == Vartype::SPIN ) {
-        size_t i = _label_to_idx.at( v );
+        _on_modified();
         _quadmat.row( i ) *= -1;
         _quadmat.col( i ) *= -1;
       } else if ( m_vartype == Vartype::BINARY ) {
-        // change vartype to spin
-        this->change_vartype( Vartype::SPIN );
-
-        size_t i = _label_to_idx.at( v );
-        _quadmat.row( i ) *= -1;
-        _quadmat.col( i ) *= -1;
-
-        // change vartype to binary
-        this->change_vartype( Vartype::BINARY );
+        // _flip_binary_variable keeps the column index of sparse matrix up to date, so only the version is advanced
+        _version++;
+        _flip_binary_variable( i );
       }
     }
 
@@ -1647,6 +3022,7 @@ namespace cimod {
      * @param vartype
      */
     void change_vartype( const Vartype &vartype ) {
+      _on_modified();
       if ( m_vartype == Vartype::BINARY && vartype == Vartype::SPIN ) // binary -> spin
       {
         _binary_to_spin();
@@ -1666,15 +3042,28 @@ namespace cimod {
      * @return created object
      */
     BinaryQuadraticModel<IndexType, FloatType, DataType> change_vartype( const Vartype &vartype, bool inplace ) {
-      BinaryQuadraticModel<IndexType, FloatType, DataType> new_bqm = *this;
       if ( inplace == true ) {
         this->change_vartype( vartype );
+        return *this;
       }
+      BinaryQuadraticModel<IndexType, FloatType, DataType> new_bqm = *this;
       new_bqm.change_vartype( vartype );
 
       return new_bqm;
     }
 
+    /**
+     * @brief Create a view of the binary quadratic model with the specified vartype.
+     * The model is neither copied nor converted; energies are evaluated in the other vartype on the fly.
+     *
+     * @param vartype
+     *
+     * @return view
+     */
+    VartypeView<IndexType, FloatType, DataType> change_vartype_view( const Vartype &vartype ) const {
+      return VartypeView<IndexType, FloatType, DataType>( *this, vartype );
+    }
+
     /* Methods */
 
     /**
@@ -1684,15 +3073,34 @@ namespace cimod {
      * @return An energy with respect to the sample.
      */
     FloatType energy( const Sample<IndexType> &sample ) const {
-      FloatType en = m_offset;
       // initialize vector
-      Vector s = Vector::Zero( _quadmat.rows() );
+      AccVector s = AccVector::Zero( _quadmat.rows() );
       for ( const auto &elem : sample ) {
         s[ _label_to_idx.at( elem.first ) ] = elem.second;
       }
       s[ _quadmat.rows() - 1 ] = 1;
 
-      return en + ( s.transpose() * _quadmat * s ) - 1;
+      return static_cast<FloatType>( m_offset + _quadratic_form( s ) - 1 );
+    }
+
+    /**
+     * @brief Determine the energy of the state indexed by id, i.e. state[id] is the value of the variable with id.
+     *
+     * @param state
+     * @return An energy with respect to the state.
+     */
+    FloatType energy_ids( const std::vector<int32_t> &state ) const {
+      const size_t num_variables = get_num_variables();
+      if ( state.size() != num_variables ) {
+        throw std::runtime_error( "the size of the state must be equal to the number of variables." );
+      }
+      AccVector s = AccVector::Zero( _quadmat.rows() );
+      for ( size_t i = 0; i < num_variables; i++ ) {
+        s[ i ] = state[ i ];
+      }
+      s[ _quadmat.rows() - 1 ] = 1;
+
+      return static_cast<FloatType>( m_offset + _quadratic_form( s ) - 1 );
     }
 
     /**
@@ -1702,13 +3110,52 @@ namespace cimod {
      * @return A vector including energies with respect to the samples.
      */
     std::vector<FloatType> energies( const std::vector<Sample<IndexType>> &samples_like ) const {
-      std::vector<FloatType> en_vec;
-      for ( auto &it : samples_like ) {
-        en_vec.push_back( energy( it ) );
+      std::vector<char> found( samples_like.size(), true );
+      std::vector<FloatType> en_vec
+          = _energies( samples_like.size(), [ this, &samples_like, &found ]( SampleMatrix &S, size_t begin ) {
+              for ( size_t k = 0; k < ( size_t )S.rows(); k++ ) {
+                for ( const auto &elem : samples_like[ begin + k ] ) {
+                  auto it = _label_to_idx.find( elem.first );
+                  if ( it == _label_to_idx.end() ) {
+                    found[ begin + k ] = false;
+                    break;
+                  }
+                  S( k, it->second ) = elem.second;
+                }
+              }
+            } );
+
+      if ( std::find( found.begin(), found.end(), false ) != found.end() ) {
+        throw std::out_of_range( "the sample contains a variable not in the model." );
       }
       return en_vec;
     }
 
+    /**
+     * @brief Determine the energies of the given samples stored in a contiguous array.
+     * The array is a row-major (num_samples x num_variables) matrix whose columns follow the order of get_variables().
+     *
+     * @tparam SampleType integer type of the samples (e.g. int8_t, int32_t)
+     * @param samples pointer to the first element of the array
+     * @param num_samples
+     * @return A vector including energies with respect to the samples.
+     */
+    template<typename SampleType>
+    std::vector<FloatType> energies( const SampleType *samples, size_t num_samples ) const {
+      static_assert( std::is_integral_v<SampleType>, "SampleType must be an integer type." );
+      const size_t num_variables = get_num_variables();
+      const std::vector<size_t> ranks = _generate_sorted_ranks();
+
+      return _energies( num_samples, [ samples, num_variables, &ranks ]( SampleMatrix &S, size_t begin ) {
+        for ( size_t i = 0; i < num_variables; i++ ) {
+          const SampleType *col = samples + begin * num_variables + ranks[ i ];
+          for ( size_t k = 0; k < ( size_t )S.rows(); k++ ) {
+            S( k, i ) = col[ k * num_variables ];
+          }
+        }
+      } );
+    }
+
     /* Conversions */
     /**
      * @brief Convert a binary quadratic model to QUBO format.
@@ -1754,6 +3201,31 @@ namespace cimod {
       return BinaryQuadraticModel<IndexType, FloatType, DataType>( linear, quadratic, offset, Vartype::BINARY );
     }
 
+    /**
+     * @brief Create a binary quadratic model from COO triplets.
+     * Each triplet (row[k], col[k], bias[k]) is added to the model; diagonal elements (row[k] == col[k]) are
+     * regarded as linear biases, (u, v) and (v, u) are merged and duplicated elements are summed up.
+     *
+     * @param row
+     * @param col
+     * @param bias
+     * @param offset
+     * @param vartype
+     *
+     * @return Binary quadratic model
+     */
+    static BinaryQuadraticModel<IndexType, FloatType, DataType> from_coo(
+        const std::vector<IndexType> &row,
+        const std::vector<IndexType> &col,
+        const std::vector<FloatType> &bias,
+        FloatType offset,
+        const Vartype vartype ) {
+      BinaryQuadraticModel<IndexType, FloatType, DataType> bqm(
+          Linear<IndexType, FloatType>(), Quadratic<IndexType, FloatType>(), offset, vartype );
+      bqm._initialize_quadmat( row, col, bias );
+      return bqm;
+    }
+
     /**
      * @brief Convert a binary quadratic model to Ising format.
      *
@@ -1803,7 +3275,32 @@ namespace cimod {
      * @return corresponding interaction matrix (Eigen)
      */
     Matrix interaction_matrix() const {
-      return this->_quadmat;
+      if ( _is_canonical() ) {
+        return this->_quadmat;
+      }
+      return _generate_sorted_quadmat();
+    }
+
+    /**
+     * @brief Get the interaction matrix of interaction_matrix() without a copy.
+     * If the variables were added out of order or spare rows and columns are held, the model is first rearranged into
+     * that form in place, which changes the ids of the variables. The reference is invalidated by any change of the
+     * model.
+     *
+     * @return reference to the interaction matrix (compressed for sparse matrix)
+     */
+    const Matrix &interaction_matrix_ref() {
+      if ( !_is_canonical() ) {
+        std::vector<IndexType> labels = get_variables();
+        _quadmat = _generate_sorted_quadmat();
+        _idx_to_label = std::move( labels );
+        _sorted = true;
+        _sorted_labels_flag.reset();
+        _set_label_to_idx();
+        _on_modified();
+      }
+      _compress_mat();
+      return _quadmat;
     }
 
     using json = nlohmann::json;
@@ -1851,7 +3348,12 @@ namespace cimod {
       }
 
       // copy matrix to std::vector
-      std::vector<FloatType> biases( _quadmat.data(), _quadmat.data() + _quadmat.size() );
+      Matrix sorted_mat;
+      if ( !_is_canonical() ) {
+        sorted_mat = _generate_sorted_quadmat();
+      }
+      const Matrix &mat = _is_canonical() ? _quadmat : sorted_mat;
+      std::vector<FloatType> biases( mat.data(), mat.data() + mat.size() );
 
       json output;
       output[ "type" ] = "BinaryQuadraticModel";
@@ -1925,34 +3427,11 @@ namespace cimod {
       output[ "info" ] = "";
 
       // biases
-      size_t mat_size = this->get_num_variables() + 1;
-      Vector l_bias_vec = _quadmat.block( 0, mat_size - 1, mat_size - 1, 1 );
-      std::vector<FloatType> l_bias( l_bias_vec.size() );
-      for ( int i = 0; i < l_bias_vec.size(); i++ ) {
-        l_bias[ i ] = l_bias_vec( i );
-      }
-
-      std::vector<FloatType> q_bias;
+      std::vector<FloatType> l_bias;
       std::vector<size_t> q_head;
       std::vector<size_t> q_tail;
-
-      q_bias.reserve( _quadmat.nonZeros() );
-      q_head.reserve( _quadmat.nonZeros() );
-      q_tail.reserve( _quadmat.nonZeros() );
-
-      for ( int k = 0; k < _quadmat.outerSize(); k++ ) {
-        for ( SpIter it( _quadmat, k ); it; ++it ) {
-          size_t r = it.row();
-          size_t c = it.col();
-          FloatType val = it.value();
-
-          if ( ( r < mat_size - 1 ) && ( c < mat_size - 1 ) ) {
-            q_bias.push_back( val );
-            q_head.push_back( r );
-            q_tail.push_back( c );
-          }
-        }
-      }
+      std::vector<FloatType> q_bias;
+      _generate_serializable_biases( l_bias, q_head, q_tail, q_bias );
 
       output[ "linear_biases" ] = l_bias;
       output[ "quadratic_biases" ] = q_bias;
@@ -2044,32 +3523,143 @@ namespace cimod {
       FloatType offset = input[ "offset" ];
 
       std::vector<FloatType_serial> l_bias = input[ "linear_biases" ];
-      std::vector<size_t> q_head = input[ "quadratic_head" ];
-      std::vector<size_t> q_tail = input[ "quadratic_tail" ];
-      std::vector<FloatType_serial> q_bias = input[ "quadratic_biases" ];
-
-      // make triplets
-      std::vector<Eigen::Triplet<FloatType_serial>> triplets;
-      triplets.reserve( q_bias.size() + l_bias.size() );
-
-      size_t mat_size = variables.size() + 1;
+      const json &head_json = input[ "quadratic_head" ];
+      const json &tail_json = input[ "quadratic_tail" ];
+      const json &bias_json = input[ "quadratic_biases" ];
+
+      const int64_t N = variables.size();
+      const int64_t num_interactions = bias_json.size();
+      if ( ( int64_t )l_bias.size() != N || ( int64_t )head_json.size() != num_interactions
+           || ( int64_t )tail_json.size() != num_interactions ) {
+        throw std::runtime_error( "the sizes of the bias arrays do not match." );
+      }
 
-      for ( size_t i = 0; i < l_bias.size(); i++ ) {
-        if ( l_bias[ i ] != 0 )
-          triplets.emplace_back( i, mat_size - 1, l_bias[ i ] );
+      // convert the arrays in parallel; an exception must not leave the parallel region, so the first one is kept
+      // and rethrown after the loop
+      std::vector<size_t> q_head( num_interactions );
+      std::vector<size_t> q_tail( num_interactions );
+      std::vector<FloatType_serial> q_bias( num_interactions );
+      std::exception_ptr error;
+      char in_range = true;
+      char in_order = true;
+#pragma omp parallel for reduction( && : in_range, in_order )
+      for ( int64_t k = 0; k < num_interactions; k++ ) {
+        try {
+          q_head[ k ] = head_json[ k ].get<size_t>();
+          q_tail[ k ] = tail_json[ k ].get<size_t>();
+          q_bias[ k ] = bias_json[ k ].get<FloatType_serial>();
+        } catch ( ... ) {
+#pragma omp critical
+          {
+            if ( !error ) {
+              error = std::current_exception();
+            }
+          }
+          continue;
+        }
+        in_range = in_range && q_head[ k ] < ( size_t )N && q_tail[ k ] < ( size_t )N && q_head[ k ] != q_tail[ k ];
+        in_order = in_order && q_head[ k ] < q_tail[ k ];
+      }
+      if ( error ) {
+        std::rethrow_exception( error );
+      }
+      if ( !in_range ) {
+        throw std::runtime_error( "the quadratic indices must be distinct indices of the variables." );
+      }
+      if ( in_order ) {
+#pragma omp parallel for reduction( && : in_order )
+        for ( int64_t k = 1; k < num_interactions; k++ ) {
+          in_order = in_order
+                     && std::make_pair( q_head[ k - 1 ], q_tail[ k - 1 ] ) < std::make_pair( q_head[ k ], q_tail[ k ] );
+        }
       }
 
-      for ( size_t i = 0; i < q_bias.size(); i++ ) {
-        triplets.emplace_back( q_head[ i ], q_tail[ i ], q_bias[ i ] );
+      const size_t mat_size = N + 1;
+      SparseMatrix mat( mat_size, mat_size );
+      if ( in_order ) {
+        // the interactions are sorted by (head, tail) without duplicates (as written by to_serializable),
+        // so the storage of each row is filled directly
+        using StorageIndex = typename SparseMatrix::StorageIndex;
+        std::vector<int64_t> q_row_ptr( N + 1 );
+#pragma omp parallel for
+        for ( int64_t r = 0; r <= N; r++ ) {
+          q_row_ptr[ r ] = std::lower_bound( q_head.begin(), q_head.end(), ( size_t )r ) - q_head.begin();
+        }
+
+        StorageIndex *outer = mat.outerIndexPtr();
+        outer[ 0 ] = 0;
+        for ( int64_t r = 0; r < N; r++ ) {
+          outer[ r + 1 ] = outer[ r ] + ( q_row_ptr[ r + 1 ] - q_row_ptr[ r ] ) + ( l_bias[ r ] != 0 ? 1 : 0 );
+        }
+        outer[ N + 1 ] = outer[ N ] + 1;
+        mat.resizeNonZeros( outer[ N + 1 ] );
+
+        StorageIndex *inner = mat.innerIndexPtr();
+        FloatType *values = mat.valuePtr();
+#pragma omp parallel for
+        for ( int64_t r = 0; r < N; r++ ) {
+          StorageIndex p = outer[ r ];
+          for ( int64_t k = q_row_ptr[ r ]; k < q_row_ptr[ r + 1 ]; k++, p++ ) {
+            inner[ p ] = q_tail[ k ];
+            values[ p ] = q_bias[ k ];
+          }
+          if ( l_bias[ r ] != 0 ) {
+            inner[ p ] = N;
+            values[ p ] = l_bias[ r ];
+          }
+        }
+        inner[ outer[ N ] ] = N;
+        values[ outer[ N ] ] = 1;
+      } else {
+        // make triplets; duplicated interactions are summed up
+        std::vector<Eigen::Triplet<FloatType_serial>> triplets;
+        triplets.reserve( q_bias.size() + l_bias.size() + 1 );
+        for ( int64_t i = 0; i < N; i++ ) {
+          if ( l_bias[ i ] != 0 )
+            triplets.emplace_back( i, mat_size - 1, l_bias[ i ] );
+        }
+        for ( int64_t k = 0; k < num_interactions; k++ ) {
+          triplets.emplace_back( std::min( q_head[ k ], q_tail[ k ] ), std::max( q_head[ k ], q_tail[ k ] ), q_bias[ k ] );
+        }
+        triplets.emplace_back( mat_size - 1, mat_size - 1, 1 );
+        mat.setFromTriplets( triplets.begin(), triplets.end() );
       }
 
-      triplets.emplace_back( mat_size - 1, mat_size - 1, 1 );
+      BinaryQuadraticModel<IndexType_serial, FloatType_serial, DataType> bqm(
+          std::move( mat ), variables, offset, vartype );
+      return bqm;
+    }
 
-      SparseMatrix mat( mat_size, mat_size );
+    /**
+     * @brief Save the binary quadratic model to a file in the binary format (see binary_format.hpp).
+     * Dense models are written in the PACKED payload and sparse models in the CSR payload.
+     *
+     * @param path
+     */
+    void save( const std::string &path ) const {
+      _save_binary( path );
+    }
 
-      mat.setFromTriplets( triplets.begin(), triplets.end() );
+    /**
+     * @brief Load a binary quadratic model from a file in the binary format.
+     * Both the PACKED and the CSR payload are accepted. The file is mapped into memory and the biases are copied
+     * straight into the interaction matrix.
+     *
+     * @param path
+     * @return BinaryQuadraticModel
+     */
+    static BinaryQuadraticModel<IndexType, FloatType, DataType> load( const std::string &path ) {
+      BinaryReader reader( path );
+      std::vector<IndexType> labels = reader.read_labels<IndexType>();
+      const BinaryQuadraticPayload<FloatType> payload = reader.read_quadratic_payload<FloatType>();
 
-      BinaryQuadraticModel<IndexType_serial, FloatType_serial, DataType> bqm( mat, variables, offset, vartype );
+      BinaryQuadraticModel<IndexType, FloatType, DataType> bqm(
+          Linear<IndexType, FloatType>(),
+          Quadratic<IndexType, FloatType>(),
+          static_cast<FloatType>( reader.header().offset ),
+          reader.header().vartype );
+      bqm._set_binary_labels( std::move( labels ) );
+      bqm._load_binary( payload );
       return bqm;
     }
   };
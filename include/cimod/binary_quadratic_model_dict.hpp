@@ -16,11 +16,13 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <exception>
 #include <functional>
 #include <iostream>
 #include <set>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <typeinfo>
 #include <unordered_map>
 #include <unordered_set>
@@ -70,6 +72,13 @@ namespace cimod {
      */
     Quadratic<IndexType, FloatType> m_quadratic;
 
+    /**
+     * @brief Adjacency list of m_quadratic (variable -> neighbor -> bias).
+     * Every interaction is stored in both directions, and variables without interactions have no entry.
+     *
+     */
+    Adjacency<IndexType, FloatType> m_adj;
+
     /**
      * @brief The energy offset associated with the model.
      *
@@ -182,6 +191,62 @@ namespace cimod {
      */
     BinaryQuadraticModel( const BinaryQuadraticModel & ) = default;
 
+    /**
+     * @brief set the bias of interaction u, v in the adjacency list
+     *
+     * @param u
+     * @param v
+     * @param bias
+     */
+    void _set_adjacency( const IndexType &u, const IndexType &v, const FloatType &bias ) {
+      m_adj[ u ][ v ] = bias;
+      m_adj[ v ][ u ] = bias;
+    }
+
+    /**
+     * @brief erase interaction u, v from the adjacency list
+     *
+     * @param u
+     * @param v
+     */
+    void _erase_adjacency( const IndexType &u, const IndexType &v ) {
+      for ( const auto &p : { std::make_pair( u, v ), std::make_pair( v, u ) } ) {
+        auto it = m_adj.find( p.first );
+        if ( it != m_adj.end() ) {
+          it->second.erase( p.second );
+          if ( it->second.empty() ) {
+            m_adj.erase( it );
+          }
+        }
+      }
+    }
+
+    /**
+     * @brief generate the adjacency list from m_quadratic
+     *
+     */
+    void _generate_adjacency() {
+      m_adj.clear();
+      for ( const auto &it : m_quadratic ) {
+        _set_adjacency( it.first.first, it.first.second, it.second );
+      }
+    }
+
+    /**
+     * @brief get the neighbors of v with their biases (copied, so that the model can be modified while iterating)
+     *
+     * @param v
+     *
+     * @return neighbors
+     */
+    std::vector<std::pair<IndexType, FloatType>> _copy_neighbors( const IndexType &v ) const {
+      auto it = m_adj.find( v );
+      if ( it == m_adj.end() ) {
+        return {};
+      }
+      return std::vector<std::pair<IndexType, FloatType>>( it->second.begin(), it->second.end() );
+    }
+
     /**
      * @brief generate indices
      *
@@ -310,6 +375,28 @@ namespace cimod {
       return variables;
     }
 
+    /**
+     * @brief Get the number of neighbors of variable v.
+     *
+     * @param v
+     *
+     * @return degree
+     */
+    size_t degree( const IndexType &v ) const {
+      auto it = m_adj.find( v );
+      return it == m_adj.end() ? 0 : it->second.size();
+    }
+
+    /**
+     * @brief Get the adjacency list of the model.
+     * Every interaction is stored in both directions.
+     *
+     * @return adjacency list
+     */
+    const Adjacency<IndexType, FloatType> &get_adjacency() const {
+      return m_adj;
+    }
+
     /**
      * @brief Create an empty BinaryQuadraticModel
      *
@@ -345,12 +432,8 @@ namespace cimod {
         }
       }
 
-      // Insert or assign the bias
-      FloatType value = 0;
-      if ( m_linear.count( v ) != 0 ) {
-        value = m_linear[ v ];
-      }
-      insert_or_assign( m_linear, v, value + b );
+      // Insert or add to the bias with a single lookup
+      m_linear.try_emplace( v, 0 ).first->second += b;
     }
 
     /**
@@ -408,20 +491,13 @@ namespace cimod {
             throw std::runtime_error( "Unknown vartype" );
           }
         } else {
-          if ( m_linear.count( u ) == 0 ) {
-            add_variable( u, 0 );
-          }
-          if ( m_linear.count( v ) == 0 ) {
-            add_variable( v, 0 );
-          }
+          m_linear.try_emplace( u, 0 );
+          m_linear.try_emplace( v, 0 );
         }
 
-        FloatType value = 0;
-        std::pair<IndexType, IndexType> p1 = std::make_pair( u, v );
-        if ( m_quadratic.count( p1 ) != 0 ) {
-          value = m_quadratic[ p1 ];
-        }
-        insert_or_assign( m_quadratic, p1, value + b );
+        FloatType &value = m_quadratic.try_emplace( std::make_pair( u, v ), 0 ).first->second;
+        value += b;
+        _set_adjacency( u, v, value );
       }
     }
 
@@ -442,13 +518,9 @@ namespace cimod {
      * @param v
      */
     void remove_variable( const IndexType &v ) {
-      std::vector<std::pair<IndexType, IndexType>> interactions;
-      for ( auto &it : m_quadratic ) {
-        if ( it.first.first == v || it.first.second == v ) {
-          interactions.push_back( it.first );
-        }
+      for ( const auto &it : _copy_neighbors( v ) ) {
+        remove_interaction( v, it.first );
       }
-      remove_interactions_from( interactions );
       m_linear.erase( v );
     }
 
@@ -475,29 +547,14 @@ namespace cimod {
       auto p = std::make_pair( u, v );
       if ( m_quadratic.count( p ) != 0 ) {
         m_quadratic.erase( p );
+        _erase_adjacency( u, v );
       }
 
-      bool u_flag = true;
-      for ( auto &it : m_quadratic ) {
-        if ( ( it.first.first == u ) || ( it.first.second == u ) ) {
-          u_flag = false;
-          break;
-        }
-      }
-
-      if ( u_flag && ( m_linear[ u ] == 0 ) ) {
+      if ( ( m_adj.count( u ) == 0 ) && ( m_linear[ u ] == 0 ) ) {
         remove_variable( u );
       }
 
-      bool v_flag = true;
-      for ( auto &it : m_quadratic ) {
-        if ( ( it.first.first == v ) || ( it.first.second == v ) ) {
-          v_flag = false;
-          break;
-        }
-      }
-
-      if ( v_flag && ( m_linear[ v ] == 0 ) ) {
+      if ( ( m_adj.count( v ) == 0 ) && ( m_linear[ v ] == 0 ) ) {
         remove_variable( v );
       }
     }
@@ -555,6 +612,7 @@ namespace cimod {
         if ( std::find( ignored_interactions.begin(), ignored_interactions.end(), it.first ) != ignored_interactions.end()
              || ignored_variables.empty() ) {
           it.second *= scalar;
+          _set_adjacency( it.first.first, it.first.second, it.second );
         }
       }
 
@@ -622,17 +680,13 @@ namespace cimod {
      * @param value
      */
     void fix_variable( const IndexType &v, const int32_t &value ) {
-      std::vector<std::pair<IndexType, IndexType>> interactions;
-      for ( auto &it : m_quadratic ) {
-        if ( it.first.first == v ) {
-          add_variable( it.first.second, value * it.second );
-          interactions.push_back( it.first );
-        } else if ( it.first.second == v ) {
-          add_variable( it.first.first, value * it.second );
-          interactions.push_back( it.first );
-        }
+      const auto neighbors = _copy_neighbors( v );
+      for ( const auto &it : neighbors ) {
+        add_variable( it.first, value * it.second );
+      }
+      for ( const auto &it : neighbors ) {
+        remove_interaction( v, it.first );
       }
-      remove_interactions_from( interactions );
       add_offset( m_linear[ v ] * value );
       remove_variable( v );
     }
@@ -659,26 +713,29 @@ namespace cimod {
         throw std::runtime_error( "not a variable in the binary quadratic model." );
       }
 
+      auto flip_interactions = [ this, &v ]() {
+        auto it_adj = m_adj.find( v );
+        if ( it_adj == m_adj.end() ) {
+          return;
+        }
+        for ( auto &it : it_adj->second ) {
+          it.second *= -1.0;
+          m_adj[ it.first ][ v ] = it.second;
+          m_quadratic[ std::make_pair( std::min( v, it.first ), std::max( v, it.first ) ) ] = it.second;
+        }
+      };
+
       if ( m_vartype == Vartype::SPIN ) {
         m_linear[ v ] *= -1.0;
-        for ( auto &it : m_quadratic ) {
-          if ( it.first.first == v || it.first.second == v ) {
-            it.second *= -1.0;
-          }
-        }
+        flip_interactions();
       } else if ( m_vartype == Vartype::BINARY ) {
         add_offset( m_linear[ v ] );
         m_linear[ v ] *= -1.0;
 
-        for ( auto &it : m_quadratic ) {
-          if ( it.first.first == v ) {
-            m_linear[ it.first.second ] += it.second;
-            it.second *= -1.0;
-          } else if ( it.first.second == v ) {
-            m_linear[ it.first.first ] += it.second;
-            it.second *= -1.0;
-          }
+        for ( const auto &it : _copy_neighbors( v ) ) {
+          m_linear[ it.first ] += it.second;
         }
+        flip_interactions();
       }
     }
 
@@ -716,17 +773,13 @@ namespace cimod {
         remove_interaction( v, u );
       }
 
-      std::vector<std::pair<IndexType, IndexType>> interactions;
-      for ( auto &it : m_quadratic ) {
-        if ( it.first.first == v ) {
-          add_interaction( u, it.first.second, it.second );
-          interactions.push_back( it.first );
-        } else if ( it.first.second == v ) {
-          add_interaction( it.first.first, u, it.second );
-          interactions.push_back( it.first );
-        }
+      const auto neighbors = _copy_neighbors( v );
+      for ( const auto &it : neighbors ) {
+        add_interaction( u, it.first, it.second );
+      }
+      for ( const auto &it : neighbors ) {
+        remove_interaction( v, it.first );
       }
-      remove_interactions_from( interactions );
 
       add_variable( u, m_linear[ v ] );
       remove_variable( v );
@@ -760,6 +813,7 @@ namespace cimod {
       m_quadratic = quadratic;
       m_offset = offset;
       m_vartype = vartype;
+      _generate_adjacency();
     }
 
     /**
@@ -790,6 +844,7 @@ namespace cimod {
         // inplace
         m_linear = bqm.get_linear();
         m_quadratic = bqm.get_quadratic();
+        m_adj = bqm.get_adjacency();
         m_offset = bqm.get_offset();
         m_vartype = bqm.get_vartype();
       }
@@ -815,8 +870,8 @@ namespace cimod {
       Linear<IndexType, FloatType> new_linear;
       Quadratic<IndexType, FloatType> new_quadratic;
       FloatType new_offset = offset;
-      FloatType linear_offset = 0.0;
-      FloatType quadratic_offset = 0.0;
+      AccumulateType<FloatType> linear_offset = 0.0;
+      AccumulateType<FloatType> quadratic_offset = 0.0;
 
       for ( auto &it : linear ) {
         insert_or_assign( new_linear, it.first, static_cast<FloatType>( 2.0 * it.second ) );
@@ -830,7 +885,7 @@ namespace cimod {
         quadratic_offset += it.second;
       }
 
-      new_offset += quadratic_offset - linear_offset;
+      new_offset += static_cast<FloatType>( quadratic_offset - linear_offset );
 
       return std::make_tuple( new_linear, new_quadratic, new_offset );
     }
@@ -852,8 +907,8 @@ namespace cimod {
       Linear<IndexType, FloatType> h;
       Quadratic<IndexType, FloatType> J;
       FloatType new_offset = offset;
-      FloatType linear_offset = 0.0;
-      FloatType quadratic_offset = 0.0;
+      AccumulateType<FloatType> linear_offset = 0.0;
+      AccumulateType<FloatType> quadratic_offset = 0.0;
 
       for ( auto &it : linear ) {
         insert_or_assign( h, it.first, static_cast<FloatType>( 0.5 * it.second ) );
@@ -867,46 +922,180 @@ namespace cimod {
         quadratic_offset += it.second;
       }
 
-      new_offset += 0.5 * linear_offset + 0.25 * quadratic_offset;
+      new_offset += static_cast<FloatType>( 0.5 * linear_offset + 0.25 * quadratic_offset );
 
       return std::make_tuple( h, J, new_offset );
     }
 
+    /**
+     * @brief Create a view of the binary quadratic model with the specified vartype.
+     * The model is neither copied nor converted; energies are evaluated in the other vartype on the fly.
+     *
+     * @param vartype
+     *
+     * @return view
+     */
+    VartypeView<IndexType, FloatType, Dict> change_vartype_view( const Vartype &vartype ) const {
+      return VartypeView<IndexType, FloatType, Dict>( *this, vartype );
+    }
+
     /* Methods */
 
     /**
      * @brief Determine the energy of the specified sample of a binary quadratic model.
+     * Each value of the sample is looked up and validated once. Set validate to false to skip the check for trusted samples.
      *
      * @param sample
+     * @param validate check that every variable has a value of the vartype
      * @return An energy with respect to the sample.
      */
-    FloatType energy( const Sample<IndexType> &sample ) const {
-      FloatType en = m_offset;
-      for ( auto &&it : m_linear ) {
-        if ( check_vartype( sample.at( it.first ), m_vartype ) ) {
-          en += static_cast<FloatType>( sample.at( it.first ) ) * it.second;
+    FloatType energy( const Sample<IndexType> &sample, bool validate = true ) const {
+      using AccType = AccumulateType<FloatType>;
+      AccType en = m_offset;
+      // every endpoint of m_quadratic is in m_linear, so this pass validates all values before they are used
+      for ( const auto &it : m_linear ) {
+        const int32_t value = sample.at( it.first );
+        if ( validate ) {
+          validate_vartype( value, m_vartype );
         }
+        en += static_cast<AccType>( value ) * it.second;
       }
-      for ( auto &it : m_quadratic ) {
-        if ( check_vartype( sample.at( it.first.first ), m_vartype )
-             && check_vartype( sample.at( it.first.second ), m_vartype ) ) {
-          en += static_cast<FloatType>( sample.at( it.first.first ) )
-                * static_cast<FloatType>( sample.at( it.first.second ) ) * it.second;
+      for ( const auto &it : m_quadratic ) {
+        en += static_cast<AccType>( sample.at( it.first.first ) ) * static_cast<AccType>( sample.at( it.first.second ) )
+              * it.second;
+      }
+      return static_cast<FloatType>( en );
+    }
+
+    /**
+     * @brief gather the nonzero biases into flat arrays of column indices of variables
+     *
+     * @param variables labels of the columns of a sample row
+     * @param linear (column, bias) of the linear terms
+     * @param quadratic (column, column, bias) of the quadratic terms
+     */
+    void _flatten_biases(
+        const std::vector<IndexType> &variables,
+        std::vector<std::pair<size_t, FloatType>> &linear,
+        std::vector<std::tuple<size_t, size_t, FloatType>> &quadratic ) const {
+      std::unordered_map<IndexType, size_t> column;
+      column.reserve( variables.size() );
+      for ( size_t i = 0; i < variables.size(); i++ ) {
+        column.emplace( variables[ i ], i );
+      }
+
+      linear.clear();
+      linear.reserve( m_linear.size() );
+      for ( const auto &it : m_linear ) {
+        if ( it.second != 0 ) {
+          linear.emplace_back( column.at( it.first ), it.second );
+        }
+      }
+      quadratic.clear();
+      quadratic.reserve( m_quadratic.size() );
+      for ( const auto &it : m_quadratic ) {
+        if ( it.second != 0 ) {
+          quadratic.emplace_back( column.at( it.first.first ), column.at( it.first.second ), it.second );
         }
       }
-      return en;
+    }
+
+    /**
+     * @brief energy of a sample row with the biases gathered by _flatten_biases
+     *
+     * @tparam SampleType integer type of the sample
+     * @param row pointer to the first element of the row
+     * @param linear
+     * @param quadratic
+     * @return An energy with respect to the row.
+     */
+    template<typename SampleType>
+    FloatType _energy_row(
+        const SampleType *row,
+        const std::vector<std::pair<size_t, FloatType>> &linear,
+        const std::vector<std::tuple<size_t, size_t, FloatType>> &quadratic ) const {
+      using AccType = AccumulateType<FloatType>;
+      AccType en = m_offset;
+      for ( const auto &it : linear ) {
+        en += static_cast<AccType>( row[ it.first ] ) * it.second;
+      }
+      for ( const auto &[ i, j, bias ] : quadratic ) {
+        en += static_cast<AccType>( row[ i ] ) * static_cast<AccType>( row[ j ] ) * bias;
+      }
+      return static_cast<FloatType>( en );
     }
 
     /**
      * @brief Determine the energies of the given samples.
+     * The biases are gathered into flat arrays once. Each sample is then looked up once per variable into a row, and
+     * the samples are evaluated in parallel. An error of any sample is rethrown after the loop.
      *
      * @param samples_like
+     * @param validate check that every variable has a value of the vartype
      * @return A vector including energies with respect to the samples.
      */
-    std::vector<FloatType> energies( const std::vector<Sample<IndexType>> &samples_like ) const {
-      std::vector<FloatType> en_vec;
-      for ( auto &it : samples_like ) {
-        en_vec.push_back( energy( it ) );
+    std::vector<FloatType> energies( const std::vector<Sample<IndexType>> &samples_like, bool validate = true ) const {
+      std::vector<IndexType> variables;
+      variables.reserve( m_linear.size() );
+      for ( const auto &it : m_linear ) {
+        variables.push_back( it.first );
+      }
+      std::vector<std::pair<size_t, FloatType>> linear;
+      std::vector<std::tuple<size_t, size_t, FloatType>> quadratic;
+      _flatten_biases( variables, linear, quadratic );
+
+      std::vector<FloatType> en_vec( samples_like.size() );
+      std::vector<std::exception_ptr> errors( samples_like.size() );
+#pragma omp parallel
+      {
+        std::vector<int32_t> row( variables.size() );
+#pragma omp for
+        for ( int64_t k = 0; k < ( int64_t )samples_like.size(); k++ ) {
+          try {
+            for ( size_t i = 0; i < variables.size(); i++ ) {
+              row[ i ] = samples_like[ k ].at( variables[ i ] );
+              if ( validate ) {
+                validate_vartype( row[ i ], m_vartype );
+              }
+            }
+            en_vec[ k ] = _energy_row( row.data(), linear, quadratic );
+          } catch ( ... ) {
+            errors[ k ] = std::current_exception();
+          }
+        }
+      }
+
+      for ( const auto &error : errors ) {
+        if ( error ) {
+          std::rethrow_exception( error );
+        }
+      }
+      return en_vec;
+    }
+
+    /**
+     * @brief Determine the energies of the given samples stored in a contiguous array.
+     * The array is a row-major (num_samples x num_variables) matrix whose columns follow the order of get_variables().
+     * The biases are gathered into flat arrays of column indices once, and the samples are evaluated in parallel.
+     *
+     * @tparam SampleType integer type of the samples (e.g. int8_t, int32_t)
+     * @param samples pointer to the first element of the array
+     * @param num_samples
+     * @return A vector including energies with respect to the samples.
+     */
+    template<typename SampleType>
+    std::vector<FloatType> energies( const SampleType *samples, size_t num_samples ) const {
+      static_assert( std::is_integral_v<SampleType>, "SampleType must be an integer type." );
+      const std::vector<IndexType> variables = get_variables();
+      const size_t num_variables = variables.size();
+      std::vector<std::pair<size_t, FloatType>> linear;
+      std::vector<std::tuple<size_t, size_t, FloatType>> quadratic;
+      _flatten_biases( variables, linear, quadratic );
+
+      std::vector<FloatType> en_vec( num_samples );
+#pragma omp parallel for
+      for ( int64_t k = 0; k < ( int64_t )num_samples; k++ ) {
+        en_vec[ k ] = _energy_row( samples + k * num_variables, linear, quadratic );
       }
       return en_vec;
     }
@@ -1250,5 +1439,69 @@ namespace cimod {
       BinaryQuadraticModel<IndexType_serial, FloatType_serial, DataType> bqm( linear, quadratic, offset, vartype );
       return bqm;
     }
+
+    /**
+     * @brief Save the binary quadratic model to a file in the binary format (see binary_format.hpp).
+     * The model is written in the CSR payload.
+     *
+     * @param path
+     */
+    void save( const std::string &path ) const {
+      const std::vector<IndexType> variables = get_variables();
+      const size_t N = variables.size();
+      std::unordered_map<IndexType, uint32_t> label_to_idx;
+      label_to_idx.reserve( N );
+      for ( size_t i = 0; i < N; i++ ) {
+        label_to_idx[ variables[ i ] ] = static_cast<uint32_t>( i );
+      }
+
+      std::vector<FloatType> linear( N );
+      for ( size_t i = 0; i < N; i++ ) {
+        linear[ i ] = m_linear.at( variables[ i ] );
+      }
+      std::vector<std::vector<std::pair<uint32_t, FloatType>>> rows( N );
+      for ( const auto &it : m_quadratic ) {
+        uint32_t i = label_to_idx.at( it.first.first );
+        uint32_t j = label_to_idx.at( it.first.second );
+        rows[ std::min( i, j ) ].emplace_back( std::max( i, j ), it.second );
+      }
+      for ( auto &row : rows ) {
+        std::sort( row.begin(), row.end() );
+      }
+      write_binary_csr( path, variables, linear, rows, m_offset, m_vartype );
+    }
+
+    /**
+     * @brief Load a binary quadratic model from a file in the binary format.
+     * Both the PACKED and the CSR payload are accepted.
+     *
+     * @param path
+     * @return BinaryQuadraticModel
+     */
+    static BinaryQuadraticModel<IndexType, FloatType, DataType> load( const std::string &path ) {
+      BinaryReader reader( path );
+      const std::vector<IndexType> labels = reader.read_labels<IndexType>();
+      const BinaryQuadraticPayload<FloatType> payload = reader.read_quadratic_payload<FloatType>();
+
+      BinaryQuadraticModel<IndexType, FloatType, DataType> bqm(
+          Linear<IndexType, FloatType>(),
+          Quadratic<IndexType, FloatType>(),
+          static_cast<FloatType>( reader.header().offset ),
+          reader.header().vartype );
+      bqm.m_linear.reserve( labels.size() );
+      for ( size_t i = 0; i < labels.size(); i++ ) {
+        bqm.m_linear[ labels[ i ] ] = payload.linear[ i ];
+      }
+      if ( bqm.m_linear.size() != labels.size() ) {
+        throw std::runtime_error( "the binary file contains duplicated labels." );
+      }
+      bqm.m_quadratic.reserve( payload.num_interactions );
+      payload.for_each_interaction( [ &bqm, &labels ]( size_t i, size_t j, FloatType bias ) {
+        bqm.m_quadratic[ std::make_pair( std::min( labels[ i ], labels[ j ] ), std::max( labels[ i ], labels[ j ] ) ) ]
+            = bias;
+      } );
+      bqm._generate_adjacency();
+      return bqm;
+    }
   };
 } // namespace cimod
@@ -0,0 +1,1646 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include "cimod/binary_quadratic_model.hpp"
+#include "cimod/disable_eigen_warning.hpp"
+#include "cimod/hash.hpp"
+#include "cimod/json.hpp"
+#include "cimod/utilities.hpp"
+#include "cimod/vartypes.hpp"
+
+namespace cimod {
+
+  struct PackedDense { };
+
+  /**
+   * @brief Class for binary quadratic model with packed upper-triangular storage.
+   *
+   * Only the strictly upper triangle of the interaction matrix is stored, column by column:
+   * \f[
+   * (J_{0,1}), (J_{0,2}, J_{1,2}), (J_{0,3}, J_{1,3}, J_{2,3}), \ldots
+   * \f]
+   * i.e. \f$J_{ij}\f$ (\f$i<j\f$) is stored at \f$j(j-1)/2 + i\f$, and the linear biases are stored separately.
+   * The memory footprint is about half of the Dense model and adding a new variable only appends a column.
+   */
+  template<typename IndexType, typename FloatType>
+  class BinaryQuadraticModel<IndexType, FloatType, PackedDense> {
+    using DataType = PackedDense;
+
+  public:
+    using DenseMatrix = Eigen::Matrix<FloatType, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using SparseMatrix = Eigen::SparseMatrix<FloatType, Eigen::RowMajor>;
+    using SpIter = typename SparseMatrix::InnerIterator;
+
+    /**
+     * @brief Eigen Matrix
+     */
+    using Matrix = DenseMatrix;
+
+    /**
+     * @brief Eigen Vector
+     */
+    using Vector = Eigen::Matrix<FloatType, Eigen::Dynamic, 1>;
+
+    /**
+     * @brief type used to accumulate the biases (double for float models)
+     */
+    using AccType = AccumulateType<FloatType>;
+
+    /**
+     * @brief Eigen vector of AccType
+     */
+    using AccVector = Eigen::Matrix<AccType, Eigen::Dynamic, 1>;
+
+  protected:
+    /**
+     * @brief packed strictly upper-triangular quadratic biases
+     * \f$J_{ij}\f$ (\f$i<j\f$) is stored at _column_offset(j) + i.
+     */
+    std::vector<FloatType> _quadratic;
+
+    /**
+     * @brief linear biases
+     */
+    std::vector<FloatType> _linear;
+
+    /**
+     * @brief vector for converting index to label
+     * labels are stored in insertion order; use get_variables() for the sorted list.
+     */
+    std::vector<IndexType> _idx_to_label;
+
+    /**
+     * @brief dict for converting label to index
+     */
+    std::unordered_map<IndexType, size_t> _label_to_idx;
+
+    /**
+     * @brief true if _idx_to_label is sorted
+     */
+    bool _sorted = true;
+
+    /**
+     * @brief sorted labels, generated lazily when _idx_to_label is not sorted
+     */
+    mutable std::vector<IndexType> _sorted_labels;
+
+    /**
+     * @brief flag for generating _sorted_labels once; concurrent const methods generate it only once
+     */
+    mutable CacheOnceFlag _sorted_labels_flag;
+
+    /**
+     * @brief The energy offset associated with the model.
+     *
+     */
+    FloatType m_offset;
+
+    /**
+     * @brief The model's type.
+     *
+     */
+    Vartype m_vartype = Vartype::NONE;
+
+    /**
+     * @brief position of the first element of column j in _quadratic
+     *
+     * @param j
+     *
+     * @return position
+     */
+    static inline size_t _column_offset( size_t j ) {
+      return j * ( j - 1 ) / 2;
+    }
+
+    /**
+     * @brief set _label_to_idx from _idx_to_label
+     */
+    inline void _set_label_to_idx() {
+      // reset
+      _label_to_idx.clear();
+      // initialize
+      for ( size_t i = 0; i < _idx_to_label.size(); i++ ) {
+        _label_to_idx[ _idx_to_label[ i ] ] = i;
+      }
+    }
+
+    /**
+     * @brief access the quadratic bias of indices i and j (i != j)
+     *
+     * @param i
+     * @param j
+     *
+     * @return corresponding element
+     */
+    inline FloatType &_quad( size_t i, size_t j ) {
+      return ( i < j ) ? _quadratic[ _column_offset( j ) + i ] : _quadratic[ _column_offset( i ) + j ];
+    }
+
+    /**
+     * @brief access the quadratic bias of indices i and j (i != j)
+     *
+     * @param i
+     * @param j
+     *
+     * @return corresponding element
+     */
+    inline FloatType _quad( size_t i, size_t j ) const {
+      return ( i < j ) ? _quadratic[ _column_offset( j ) + i ] : _quadratic[ _column_offset( i ) + j ];
+    }
+
+    /**
+     * @brief get reference from label_i and label_j
+     *
+     * @param label_i
+     * @param label_j
+     *
+     * @return corresponding reference
+     */
+    inline FloatType &_mat( IndexType label_i, IndexType label_j ) {
+      size_t i = _label_to_idx.at( label_i );
+      size_t j = _label_to_idx.at( label_j );
+      if ( i == j )
+        throw std::runtime_error( "No self-loop (mat(i,i)) allowed" );
+      return _quad( i, j );
+    }
+
+    /**
+     * @brief get reference from label_i
+     *
+     * @param label_i
+     *
+     * @return corresponding reference
+     */
+    inline FloatType &_mat( IndexType label_i ) {
+      return _linear[ _label_to_idx.at( label_i ) ];
+    }
+
+    /**
+     * @brief get value from label_i and label_j
+     *
+     * @param label_i
+     * @param label_j
+     *
+     * @return corresponding value
+     */
+    inline FloatType _mat( IndexType label_i, IndexType label_j ) const {
+      size_t i = _label_to_idx.at( label_i );
+      size_t j = _label_to_idx.at( label_j );
+      if ( i == j )
+        throw std::runtime_error( "No self-loop (mat(i,i)) allowed" );
+      return _quad( i, j );
+    }
+
+    /**
+     * @brief get value from label_i
+     *
+     * @param label_i
+     *
+     * @return corresponding value
+     */
+    inline FloatType _mat( IndexType label_i ) const {
+      return _linear[ _label_to_idx.at( label_i ) ];
+    }
+
+    /**
+     * @brief minimum and maximum of the linear biases
+     *
+     * @return pair of minimum and maximum
+     */
+    inline std::pair<FloatType, FloatType> _minmax_linear() const {
+      if ( _linear.empty() ) {
+        return std::make_pair( FloatType( 0 ), FloatType( 0 ) );
+      }
+      auto range = std::minmax_element( _linear.begin(), _linear.end() );
+      return std::make_pair( *range.first, *range.second );
+    }
+
+    /**
+     * @brief minimum and maximum of the quadratic biases
+     * the implicit zeros (diagonal and lower triangle) are taken into account as the Dense model does.
+     *
+     * @return pair of minimum and maximum
+     */
+    inline std::pair<FloatType, FloatType> _minmax_quadratic() const {
+      FloatType min_val = 0;
+      FloatType max_val = 0;
+      for ( const auto &val : _quadratic ) {
+        min_val = std::min( min_val, val );
+        max_val = std::max( max_val, val );
+      }
+      return std::make_pair( min_val, max_val );
+    }
+
+    /**
+     * @brief add new label
+     * if label_i already exists, this process is skipped.
+     * the label is appended to the end of _idx_to_label and a new zero column is appended to _quadratic.
+     *
+     * @param label_i
+     */
+    inline void _add_new_label( IndexType label_i ) {
+      if ( _label_to_idx.find( label_i ) == _label_to_idx.end() ) {
+        size_t N = get_num_variables();
+        _quadratic.resize( _quadratic.size() + N, 0 );
+        _linear.push_back( 0 );
+
+        if ( N > 0 && !( _idx_to_label.back() < label_i ) ) {
+          _sorted = false;
+        }
+
+        // add label_i
+        _idx_to_label.push_back( label_i );
+        _label_to_idx[ label_i ] = N;
+        _sorted_labels_flag.reset();
+      }
+    }
+
+    /**
+     * @brief check if index i has any nonzero bias
+     *
+     * @param i
+     *
+     * @return true if all the biases of index i are (numerically) zero
+     */
+    inline bool _is_isolated( size_t i ) const {
+      FloatType norm = _linear[ i ] * _linear[ i ];
+      for ( size_t j = 0; j < get_num_variables(); j++ ) {
+        if ( j != i ) {
+          FloatType val = _quad( i, j );
+          norm += val * val;
+        }
+      }
+      return norm <= std::numeric_limits<FloatType>::epsilon();
+    }
+
+    /**
+     * @brief delete the variables marked in removed and compact the storage once.
+     * the packed columns are moved forward in place.
+     *
+     * @param removed removed[i] is true if the variable with index i is deleted
+     */
+    inline void _delete_indices( const std::vector<char> &removed ) {
+      if ( std::find( removed.begin(), removed.end(), true ) == removed.end() ) {
+        return;
+      }
+
+      size_t N = get_num_variables();
+      size_t pos = 0;
+      size_t new_N = 0;
+      for ( size_t j = 0; j < N; j++ ) {
+        if ( removed[ j ] ) {
+          continue;
+        }
+        const size_t offset = _column_offset( j );
+        for ( size_t i = 0; i < j; i++ ) {
+          if ( !removed[ i ] ) {
+            _quadratic[ pos++ ] = _quadratic[ offset + i ];
+          }
+        }
+        _linear[ new_N ] = _linear[ j ];
+        _idx_to_label[ new_N ] = _idx_to_label[ j ];
+        new_N++;
+      }
+      _quadratic.resize( pos );
+      _linear.resize( new_N );
+      _idx_to_label.resize( new_N );
+      _set_label_to_idx();
+      _sorted_labels_flag.reset();
+    }
+
+    /**
+     * @brief delete label
+     * if label_i does not exist, this process is skipped.
+     *
+     * @param label_i
+     * @param force_delete if true, delete label whenever there exists corresponding nonzero elements.
+     * otherwise, delete label only if there are no corresponding nonzero elements.
+     */
+    inline void _delete_label( IndexType label_i, bool force_delete = true ) {
+      auto position = _label_to_idx.find( label_i );
+      if ( position != _label_to_idx.end() ) {
+        size_t i = position->second;
+        if ( force_delete == false && !_is_isolated( i ) ) {
+          // exists nonzero elements
+          return;
+        }
+        std::vector<char> removed( get_num_variables(), false );
+        removed[ i ] = true;
+        _delete_indices( removed );
+      }
+    }
+
+    /**
+     * @brief generate the indices of _idx_to_label in the order of sorted labels
+     *
+     * @return sorted indices
+     */
+    inline std::vector<size_t> _generate_sorted_indices() const {
+      std::vector<size_t> indices( _idx_to_label.size() );
+      std::iota( indices.begin(), indices.end(), 0 );
+      if ( !_sorted ) {
+        std::sort( indices.begin(), indices.end(), [ this ]( size_t a, size_t b ) {
+          return _idx_to_label[ a ] < _idx_to_label[ b ];
+        } );
+      }
+      return indices;
+    }
+
+    /**
+     * @brief generate the rank of each index of _idx_to_label in the sorted labels
+     *
+     * @return ranks
+     */
+    inline std::vector<size_t> _generate_sorted_ranks() const {
+      std::vector<size_t> indices = _generate_sorted_indices();
+      std::vector<size_t> ranks( indices.size() );
+      for ( size_t k = 0; k < indices.size(); k++ ) {
+        ranks[ indices[ k ] ] = k;
+      }
+      return ranks;
+    }
+
+    /**
+     * @brief generate a label pair of indices i and j ordered by the labels
+     *
+     * @param i
+     * @param j
+     *
+     * @return label pair
+     */
+    inline std::pair<IndexType, IndexType> _make_label_pair( size_t i, size_t j ) const {
+      const IndexType &label_i = _idx_to_label[ i ];
+      const IndexType &label_j = _idx_to_label[ j ];
+      return ( label_i < label_j ) ? std::make_pair( label_i, label_j ) : std::make_pair( label_j, label_i );
+    }
+
+    /**
+     * @brief initialize labels with sorted and deduplicated labels_vec and allocate zero biases
+     *
+     * @param labels_vec
+     */
+    inline void _initialize_labels( const std::vector<IndexType> &labels_vec ) {
+      std::set<IndexType> labels( labels_vec.begin(), labels_vec.end() );
+      _idx_to_label = std::vector<IndexType>( labels.begin(), labels.end() );
+      _sorted = true;
+      _sorted_labels_flag.reset();
+      _set_label_to_idx();
+
+      size_t N = _idx_to_label.size();
+      _linear.assign( N, 0 );
+      _quadratic.assign( _column_offset( N ), 0 );
+    }
+
+    /**
+     * @brief initialize biases from linear and quadratic
+     *
+     * @param linear
+     * @param quadratic
+     */
+    inline void _initialize_biases( const Linear<IndexType, FloatType> &linear,
+                                    const Quadratic<IndexType, FloatType> &quadratic ) {
+      std::vector<IndexType> labels;
+      labels.reserve( linear.size() + 2 * quadratic.size() );
+      for ( const auto &it : linear ) {
+        labels.push_back( it.first );
+      }
+      for ( const auto &it : quadratic ) {
+        labels.push_back( it.first.first );
+        labels.push_back( it.first.second );
+      }
+      _initialize_labels( labels );
+
+      for ( const auto &it : linear ) {
+        _mat( it.first ) += it.second;
+      }
+      for ( const auto &it : quadratic ) {
+        _mat( it.first.first, it.first.second ) += it.second;
+      }
+    }
+
+    /**
+     * @brief initialize biases from an interaction matrix (see the Dense model for the format)
+     *
+     * @param mat
+     * @param labels_vec
+     * @param fix_format if true, the lower triangle is added to the upper triangle.
+     */
+    inline void _initialize_biases( const Eigen::Ref<const DenseMatrix> &mat,
+                                    const std::vector<IndexType> &labels_vec,
+                                    bool fix_format ) {
+      if ( mat.rows() != mat.cols() ) {
+        throw std::runtime_error( "matrix must be a square matrix" );
+      }
+      _initialize_labels( labels_vec );
+      const size_t N = get_num_variables();
+
+      if ( ( size_t )mat.rows() == N + 1 ) {
+        for ( size_t i = 0; i < N; i++ ) {
+          _linear[ i ] = fix_format ? mat( i, N ) + mat( N, i ) : mat( i, N );
+        }
+        for ( size_t j = 0; j < N; j++ ) {
+          for ( size_t i = 0; i < j; i++ ) {
+            _quadratic[ _column_offset( j ) + i ] = fix_format ? mat( i, j ) + mat( j, i ) : mat( i, j );
+          }
+        }
+      } else if ( ( size_t )mat.rows() == N ) {
+        for ( size_t i = 0; i < N; i++ ) {
+          _linear[ i ] = mat( i, i );
+        }
+        for ( size_t j = 0; j < N; j++ ) {
+          for ( size_t i = 0; i < j; i++ ) {
+            _quadratic[ _column_offset( j ) + i ] = mat( i, j ) + mat( j, i );
+          }
+        }
+      } else {
+        throw std::runtime_error( "the number of variables and dimension do not match." );
+      }
+    }
+
+    /**
+     * @brief initialize biases from a sparse interaction matrix (see the Sparse model for the format)
+     *
+     * @param mat
+     * @param labels_vec
+     */
+    inline void _initialize_biases( const SparseMatrix &mat, const std::vector<IndexType> &labels_vec ) {
+      if ( mat.rows() != mat.cols() ) {
+        throw std::runtime_error( "matrix must be a square matrix" );
+      }
+      _initialize_labels( labels_vec );
+      const size_t N = get_num_variables();
+      if ( ( size_t )mat.rows() != N + 1 ) {
+        throw std::runtime_error( "the number of variables and dimension do not match." );
+      }
+
+      for ( int k = 0; k < mat.outerSize(); k++ ) {
+        for ( SpIter it( mat, k ); it; ++it ) {
+          size_t r = it.row();
+          size_t c = it.col();
+          if ( r < N && c < N && r != c ) {
+            _quad( r, c ) += it.value();
+          } else if ( r < N && c == N ) {
+            _linear[ r ] += it.value();
+          } else if ( r == N && c < N ) {
+            _linear[ c ] += it.value();
+          }
+        }
+      }
+    }
+
+    /**
+     * @brief initialize biases from COO triplets (see from_coo)
+     *
+     * @param row
+     * @param col
+     * @param bias
+     */
+    inline void _initialize_biases( const std::vector<IndexType> &row,
+                                    const std::vector<IndexType> &col,
+                                    const std::vector<FloatType> &bias ) {
+      if ( row.size() != col.size() || row.size() != bias.size() ) {
+        throw std::runtime_error( "the sizes of row, col and bias must be the same." );
+      }
+      std::unordered_set<IndexType> labels( row.begin(), row.end() );
+      labels.insert( col.begin(), col.end() );
+      _initialize_labels( std::vector<IndexType>( labels.begin(), labels.end() ) );
+
+      for ( size_t k = 0; k < bias.size(); k++ ) {
+        size_t i = _label_to_idx.at( row[ k ] );
+        size_t j = _label_to_idx.at( col[ k ] );
+        if ( i == j ) {
+          _linear[ i ] += bias[ k ];
+        } else {
+          _quad( i, j ) += bias[ k ];
+        }
+      }
+    }
+
+    /**
+     * @brief sum of the quadratic biases of each variable and the total sum of the quadratic biases
+     *
+     * @param neighbor_sum
+     *
+     * @return total sum
+     */
+    inline AccType _neighbor_sum( AccVector &neighbor_sum ) const {
+      const size_t N = get_num_variables();
+      neighbor_sum = AccVector::Zero( N );
+      AccType total = 0;
+      for ( size_t j = 0; j < N; j++ ) {
+        const FloatType *column = _quadratic.data() + _column_offset( j );
+        for ( size_t i = 0; i < j; i++ ) {
+          neighbor_sum[ i ] += column[ i ];
+          neighbor_sum[ j ] += column[ i ];
+          total += column[ i ];
+        }
+      }
+      return total;
+    }
+
+    /**
+     * @brief change internal vartype from spin to binary
+     *
+     */
+    inline void _spin_to_binary() {
+      AccVector neighbor_sum;
+      AccType quad_sum = _neighbor_sum( neighbor_sum );
+      AccType lin_sum = std::accumulate( _linear.begin(), _linear.end(), AccType( 0 ) );
+
+      m_offset += static_cast<FloatType>( quad_sum - lin_sum );
+      for ( size_t i = 0; i < _linear.size(); i++ ) {
+        _linear[ i ] = static_cast<FloatType>( 2 * _linear[ i ] - 2 * neighbor_sum[ i ] );
+      }
+      for ( auto &val : _quadratic ) {
+        val *= 4;
+      }
+      m_vartype = Vartype::BINARY;
+    }
+
+    /**
+     * @brief change internal vartype from binary to spin
+     *
+     */
+    inline void _binary_to_spin() {
+      AccVector neighbor_sum;
+      AccType quad_sum = _neighbor_sum( neighbor_sum );
+      AccType lin_sum = std::accumulate( _linear.begin(), _linear.end(), AccType( 0 ) );
+
+      m_offset += static_cast<FloatType>( 0.25 * quad_sum + 0.5 * lin_sum );
+      for ( size_t i = 0; i < _linear.size(); i++ ) {
+        _linear[ i ] = static_cast<FloatType>( 0.5 * _linear[ i ] + 0.25 * neighbor_sum[ i ] );
+      }
+      for ( auto &val : _quadratic ) {
+        val *= 0.25;
+      }
+      m_vartype = Vartype::SPIN;
+    }
+
+    /**
+     * @brief energy of a sample given as a dense vector in the index order
+     * \f$E = \delta + \sum_j s_j (h_j + \sum_{i<j} J_{ij} s_i)\f$, each column is a contiguous dot product.
+     *
+     * @param s
+     *
+     * @return energy
+     */
+    inline FloatType _energy( const AccVector &s ) const {
+      AccType en = m_offset;
+      for ( size_t j = 0; j < get_num_variables(); j++ ) {
+        if ( s[ j ] == 0 ) {
+          continue;
+        }
+        Eigen::Map<const Vector> column( _quadratic.data() + _column_offset( j ), j );
+        en += s[ j ] * ( _linear[ j ] + column.template cast<AccType>().dot( s.head( j ) ) );
+      }
+      return static_cast<FloatType>( en );
+    }
+
+  public:
+    /**
+     * @brief BinaryQuadraticModel constructor.
+     *
+     * @param linear
+     * @param quadratic
+     * @param offset
+     * @param vartype
+     */
+    BinaryQuadraticModel(
+        const Linear<IndexType, FloatType> &linear,
+        const Quadratic<IndexType, FloatType> &quadratic,
+        const FloatType &offset,
+        const Vartype vartype ) :
+        m_offset( offset ),
+        m_vartype( vartype ) {
+      _initialize_biases( linear, quadratic );
+    }
+
+    /**
+     * @brief BinaryQuadraticModel constructor.
+     *
+     * @param linear
+     * @param quadratic
+     * @param vartype
+     */
+    BinaryQuadraticModel(
+        const Linear<IndexType, FloatType> &linear,
+        const Quadratic<IndexType, FloatType> &quadratic,
+        const Vartype vartype ) :
+        BinaryQuadraticModel( linear, quadratic, 0.0, vartype ) {
+    }
+
+    /**
+     * @brief BinaryQuadraticModel constructor (with matrix);
+     *
+     * @param mat
+     * @param labels_vec
+     * @param offset
+     * @param vartype
+     * @param fix_format
+     */
+    BinaryQuadraticModel(
+        const Eigen::Ref<const DenseMatrix> &mat,
+        const std::vector<IndexType> &labels_vec,
+        const FloatType &offset,
+        const Vartype vartype,
+        bool fix_format = true ) :
+        m_offset( offset ),
+        m_vartype( vartype ) {
+      _initialize_biases( mat, labels_vec, fix_format );
+    }
+
+    /**
+     * @brief BinaryQuadraticModel constructor (with matrix);
+     *
+     * @param mat
+     * @param labels_vec
+     * @param vartype
+     * @param fix_format
+     */
+    BinaryQuadraticModel(
+        const Eigen::Ref<const DenseMatrix> &mat,
+        const std::vector<IndexType> &labels_vec,
+        const Vartype vartype,
+        bool fix_format = true ) :
+        BinaryQuadraticModel( mat, labels_vec, 0.0, vartype, fix_format ) {
+    }
+
+    /**
+     * @brief BinaryQuadraticModel constructor (with sparse matrix);
+     * this constructor is for developers.
+     *
+     * @param mat
+     * @param labels_vec
+     * @param offset
+     * @param vartype
+     */
+    BinaryQuadraticModel(
+        const SparseMatrix &mat,
+        const std::vector<IndexType> &labels_vec,
+        const FloatType &offset,
+        const Vartype vartype ) :
+        m_offset( offset ),
+        m_vartype( vartype ) {
+      _initialize_biases( mat, labels_vec );
+    }
+
+    /**
+     * @brief BinaryQuadraticModel constructor (with sparse matrix);
+     * this constructor is for developers.
+     *
+     * @param mat
+     * @param labels_vec
+     * @param vartype
+     */
+    BinaryQuadraticModel( const SparseMatrix &mat, const std::vector<IndexType> &labels_vec, const Vartype vartype ) :
+        BinaryQuadraticModel( mat, labels_vec, 0.0, vartype ) {
+    }
+
+    BinaryQuadraticModel( const BinaryQuadraticModel & ) = default;
+
+    /**
+     * @brief get the number of variables
+     *
+     * @return The number of variables.
+     */
+    size_t get_num_variables() const {
+      return _idx_to_label.size();
+    }
+
+    /**
+     * @brief Return the number of variables.
+     * @deprecated use get_num_variables instead.
+     *
+     * @return The number of variables.
+     */
+    size_t length() const {
+      return get_num_variables();
+    }
+
+    /**
+     * @brief Return true if the variable contains v.
+     *
+     * @return Return true if the variable contains v.
+     * @param v
+     */
+    bool contains( const IndexType &v ) const {
+      return _label_to_idx.find( v ) != _label_to_idx.end();
+    }
+
+    /**
+     * @brief Get the element of linear object
+     *
+     * @return A linear bias.
+     */
+    FloatType get_linear( IndexType label_i ) const {
+      return _mat( label_i );
+    }
+
+    /**
+     * @brief Get linear object
+     *
+     * @return A linear object
+     */
+    Linear<IndexType, FloatType> get_linear() const {
+      Linear<IndexType, FloatType> ret;
+      for ( size_t i = 0; i < get_num_variables(); i++ ) {
+        if ( _linear[ i ] != 0 ) {
+          ret[ _idx_to_label[ i ] ] = _linear[ i ];
+        }
+      }
+      return ret;
+    }
+
+    /**
+     * @brief Get the element of quadratic object
+     *
+     * @return A quadratic bias.
+     */
+    FloatType get_quadratic( IndexType label_i, IndexType label_j ) const {
+      return _mat( label_i, label_j );
+    }
+
+    /**
+     * @brief Get quadratic object
+     *
+     * @return A quadratic object.
+     */
+    Quadratic<IndexType, FloatType> get_quadratic() const {
+      Quadratic<IndexType, FloatType> ret;
+      for ( size_t j = 0; j < get_num_variables(); j++ ) {
+        const FloatType *column = _quadratic.data() + _column_offset( j );
+        for ( size_t i = 0; i < j; i++ ) {
+          if ( column[ i ] != 0 ) {
+            ret.insert( { _make_label_pair( i, j ), column[ i ] } );
+          }
+        }
+      }
+      return ret;
+    }
+
+    /**
+     * @brief Get the offset
+     *
+     * @return An offset.
+     */
+    FloatType get_offset() const {
+      return this->m_offset;
+    }
+
+    /**
+     * @brief Get the vartype object
+     *
+     * @return Type of the model.
+     */
+    Vartype get_vartype() const {
+      return this->m_vartype;
+    }
+
+    /**
+     * @brief Get variables
+     * the sorted list is generated lazily if variables have been added out of order.
+     *
+     * @return variables
+     */
+    const std::vector<IndexType> &get_variables() const {
+      if ( _sorted ) {
+        return this->_idx_to_label;
+      }
+
+      _sorted_labels_flag.call( [ this ]() {
+        std::vector<size_t> indices = _generate_sorted_indices();
+        _sorted_labels.clear();
+        _sorted_labels.reserve( indices.size() );
+        for ( size_t i : indices ) {
+          _sorted_labels.push_back( _idx_to_label[ i ] );
+        }
+      } );
+      return _sorted_labels;
+    }
+
+    /**
+     * @brief Create an empty BinaryQuadraticModel
+     *
+     * @return empty object
+     */
+    BinaryQuadraticModel<IndexType, FloatType, DataType> empty( Vartype vartype ) {
+      return BinaryQuadraticModel<IndexType, FloatType, DataType>(
+          Linear<IndexType, FloatType>(), Quadratic<IndexType, FloatType>(), 0.0, vartype );
+    }
+
+    /* Update methods */
+
+    /**
+     * @brief Add variable v and/or its bias to a binary quadratic model.
+     *
+     * @param v
+     * @param bias
+     */
+    void add_variable( const IndexType &v, const FloatType &bias ) {
+      // add new label if not exist
+      _add_new_label( v );
+      _mat( v ) += bias;
+    }
+
+    /**
+     * @brief Add variables and/or linear biases to a binary quadratic model.
+     *
+     * @param linear
+     */
+    void add_variables_from( const Linear<IndexType, FloatType> &linear ) {
+      for ( auto &it : linear ) {
+        add_variable( it.first, it.second );
+      }
+    }
+
+    /**
+     * @brief Add an interaction and/or quadratic bias to a binary quadratic model.
+     *
+     * @param u
+     * @param v
+     * @param bias
+     */
+    void add_interaction( const IndexType &u, const IndexType &v, const FloatType &bias ) {
+      // add new label if not exist
+      _add_new_label( u );
+      _add_new_label( v );
+      _mat( u, v ) += bias;
+    }
+
+    /**
+     * @brief Add interactions and/or quadratic biases to a binary quadratic model.
+     *
+     * @param quadratic
+     */
+    void add_interactions_from( const Quadratic<IndexType, FloatType> &quadratic ) {
+      for ( auto &it : quadratic ) {
+        add_interaction( it.first.first, it.first.second, it.second );
+      }
+    }
+
+    /**
+     * @brief Remove variable v and all its interactions from a binary quadratic model.
+     *
+     * @param v
+     */
+    void remove_variable( const IndexType &v ) {
+      _delete_label( v );
+    }
+
+    /**
+     * @brief Remove specified variables and all of their interactions from a binary quadratic model.
+     * The storage is compacted once for all the variables.
+     *
+     * @param variables
+     */
+    void remove_variables_from( const std::vector<IndexType> &variables ) {
+      std::vector<char> removed( get_num_variables(), false );
+      for ( const auto &it : variables ) {
+        auto position = _label_to_idx.find( it );
+        if ( position != _label_to_idx.end() ) {
+          removed[ position->second ] = true;
+        }
+      }
+      _delete_indices( removed );
+    }
+
+    /**
+     * @brief Remove interaction of variables u, v from a binary quadratic model.
+     *
+     * @param u
+     * @param v
+     */
+    void remove_interaction( const IndexType &u, const IndexType &v ) {
+      _mat( u, v ) = 0;
+      _delete_label( u, false );
+      _delete_label( v, false );
+    }
+
+    /**
+     * @brief Remove all specified interactions from the binary quadratic model.
+     *
+     * @param interactions
+     */
+    void remove_interactions_from( const std::vector<std::pair<IndexType, IndexType>> &interactions ) {
+      for ( auto &it : interactions ) {
+        remove_interaction( it.first, it.second );
+      }
+    }
+
+    /**
+     * @brief Add specified value to the offset of a binary quadratic model.
+     *
+     * @param offset
+     */
+    void add_offset( const FloatType &offset ) {
+      m_offset += offset;
+    }
+
+    /**
+     * @brief Set the binary quadratic model's offset to zero.
+     */
+    void remove_offset() {
+      add_offset( -m_offset );
+    }
+
+    /**
+     * @brief Multiply by the specified scalar all the biases and offset of a binary quadratic model.
+     *
+     * @param scalar
+     * @param ignored_variables
+     * @param ignored_interactions
+     * @param ignored_offset
+     */
+    void scale(
+        const FloatType &scalar,
+        const std::vector<IndexType> &ignored_variables = {},
+        const std::vector<std::pair<IndexType, IndexType>> &ignored_interactions = {},
+        const bool ignored_offset = false ) {
+      if ( scalar == 0.0 )
+        throw std::runtime_error( "scalar must not be zero" );
+
+      // scale
+      for ( auto &val : _linear ) {
+        val *= scalar;
+      }
+      for ( auto &val : _quadratic ) {
+        val *= scalar;
+      }
+
+      // revert scale of linear
+      for ( const auto &it : ignored_variables ) {
+        _mat( it ) *= 1.0 / scalar;
+      }
+
+      // revert scale of quadratic
+      for ( const auto &it : ignored_interactions ) {
+        _mat( it.first, it.second ) *= 1.0 / scalar;
+      }
+
+      // scaling offset
+      if ( !ignored_offset ) {
+        m_offset *= scalar;
+      }
+    }
+
+    /**
+     * @brief Normalizes the biases of the binary quadratic model such that they fall in the provided range(s), and adjusts
+     * the offset appropriately.
+     *
+     * @param bias_range
+     * @param use_quadratic_range
+     * @param quadratic_range
+     * @param ignored_variables
+     * @param ignored_interactions
+     * @param ignored_offset
+     */
+    void normalize(
+        const std::pair<FloatType, FloatType> &bias_range = { 1.0, 1.0 },
+        const bool use_quadratic_range = false,
+        const std::pair<FloatType, FloatType> &quadratic_range = { 1.0, 1.0 },
+        const std::vector<IndexType> &ignored_variables = {},
+        const std::vector<std::pair<IndexType, IndexType>> &ignored_interactions = {},
+        const bool ignored_offset = false ) {
+      // parse range
+      std::pair<FloatType, FloatType> l_range = bias_range;
+      std::pair<FloatType, FloatType> q_range;
+      if ( !use_quadratic_range ) {
+        q_range = bias_range;
+      } else {
+        q_range = quadratic_range;
+      }
+
+      // calculate scaling value
+      auto lin_range = _minmax_linear();
+      auto quad_range = _minmax_quadratic();
+
+      std::vector<FloatType> v_scale = { lin_range.first / l_range.first,
+                                         lin_range.second / l_range.second,
+                                         quad_range.first / q_range.first,
+                                         quad_range.second / q_range.second };
+
+      FloatType inv_scale = *std::max_element( v_scale.begin(), v_scale.end() );
+
+      // scaling
+      if ( inv_scale != 0.0 ) {
+        scale( 1.0 / inv_scale, ignored_variables, ignored_interactions, ignored_offset );
+      }
+    }
+
+    /**
+     * @brief Fix the value of a variable and remove it from a binary quadratic model.
+     *
+     * @param v
+     * @param value
+     */
+    void fix_variable( const IndexType &v, const int32_t &value ) {
+      fix_variables( { std::make_pair( v, value ) } );
+    }
+
+    /**
+     * @brief Fix the value of the variables and remove it from a binary quadratic model.
+     * The interactions of the fixed variables are folded into the linear biases and the offset,
+     * and the storage is compacted once for the whole batch.
+     *
+     * @param fixed
+     */
+    void fix_variables( const std::vector<std::pair<IndexType, int32_t>> &fixed ) {
+      if ( fixed.empty() ) {
+        return;
+      }
+
+      const size_t N = get_num_variables();
+      std::vector<char> is_fixed( N, false );
+      std::vector<int32_t> values( N, 0 );
+      for ( const auto &it : fixed ) {
+        size_t i = _label_to_idx.at( it.first );
+        if ( is_fixed[ i ] ) {
+          throw std::runtime_error( "the same variable is fixed more than once." );
+        }
+        is_fixed[ i ] = true;
+        values[ i ] = it.second;
+      }
+
+      // fold the fixed variables into the offset and the linear biases
+      std::vector<char> touched( N, false );
+      for ( size_t i = 0; i < N; i++ ) {
+        if ( !is_fixed[ i ] ) {
+          continue;
+        }
+        m_offset += _linear[ i ] * values[ i ];
+        for ( size_t j = 0; j < N; j++ ) {
+          if ( j == i ) {
+            continue;
+          }
+          FloatType &val = _quad( i, j );
+          if ( val == 0 ) {
+            continue;
+          }
+          if ( !is_fixed[ j ] ) {
+            _linear[ j ] += val * values[ i ];
+            touched[ j ] = true;
+          } else if ( j < i ) {
+            m_offset += val * values[ i ] * values[ j ];
+          }
+        }
+      }
+
+      // the fixed variables and the neighbors left without any bias are removed
+      std::vector<char> removed( is_fixed );
+      for ( size_t j = 0; j < N; j++ ) {
+        if ( !touched[ j ] ) {
+          continue;
+        }
+        FloatType norm = _linear[ j ] * _linear[ j ];
+        for ( size_t k = 0; k < N; k++ ) {
+          if ( k != j && !is_fixed[ k ] ) {
+            FloatType val = _quad( j, k );
+            norm += val * val;
+          }
+        }
+        if ( norm <= std::numeric_limits<FloatType>::epsilon() ) {
+          removed[ j ] = true;
+        }
+      }
+      _delete_indices( removed );
+    }
+
+    /**
+     * @brief Flip variable v in a binary quadratic model.
+     *
+     * @param v
+     */
+    void flip_variable( const IndexType &v ) {
+      const size_t i = _label_to_idx.at( v );
+      const size_t N = get_num_variables();
+
+      if ( m_vartype == Vartype::SPIN ) {
+        _linear[ i ] *= -1;
+        for ( size_t j = 0; j < N; j++ ) {
+          if ( j != i ) {
+            _quad( i, j ) *= -1;
+          }
+        }
+      } else if ( m_vartype == Vartype::BINARY ) {
+        // x_i -> 1 - x_i
+        m_offset += _linear[ i ];
+        _linear[ i ] *= -1;
+        for ( size_t j = 0; j < N; j++ ) {
+          if ( j != i ) {
+            FloatType &val = _quad( i, j );
+            _linear[ j ] += val;
+            val *= -1;
+          }
+        }
+      }
+    }
+
+    /* Transformations */
+
+    /**
+     * @brief Create a binary quadratic model with the specified vartype.
+     * This function does not return any object.
+     *
+     * @param vartype
+     */
+    void change_vartype( const Vartype &vartype ) {
+      if ( m_vartype == Vartype::BINARY && vartype == Vartype::SPIN ) // binary -> spin
+      {
+        _binary_to_spin();
+      } else if ( m_vartype == Vartype::SPIN && vartype == Vartype::BINARY ) // spin -> binary
+      {
+        _spin_to_binary();
+      }
+    }
+
+    /**
+     * @brief Create a binary quadratic model with the specified vartype.
+     * This function generates and returns a new object.
+     *
+     * @param vartype
+     * @param inplace if set true, the current object is converted.
+     *
+     * @return created object
+     */
+    BinaryQuadraticModel<IndexType, FloatType, DataType> change_vartype( const Vartype &vartype, bool inplace ) {
+      if ( inplace == true ) {
+        this->change_vartype( vartype );
+        return *this;
+      }
+      BinaryQuadraticModel<IndexType, FloatType, DataType> new_bqm = *this;
+      new_bqm.change_vartype( vartype );
+
+      return new_bqm;
+    }
+
+    /**
+     * @brief Create a view of the binary quadratic model with the specified vartype.
+     * The model is neither copied nor converted; energies are evaluated in the other vartype on the fly.
+     *
+     * @param vartype
+     *
+     * @return view
+     */
+    VartypeView<IndexType, FloatType, DataType> change_vartype_view( const Vartype &vartype ) const {
+      return VartypeView<IndexType, FloatType, DataType>( *this, vartype );
+    }
+
+    /* Methods */
+
+    /**
+     * @brief Determine the energy of the specified sample of a binary quadratic model.
+     *
+     * @param sample
+     * @return An energy with respect to the sample.
+     */
+    FloatType energy( const Sample<IndexType> &sample ) const {
+      AccVector s = AccVector::Zero( get_num_variables() );
+      for ( const auto &elem : sample ) {
+        s[ _label_to_idx.at( elem.first ) ] = elem.second;
+      }
+      return _energy( s );
+    }
+
+    /**
+     * @brief Determine the energies of the given samples.
+     *
+     * @param samples_like
+     * @return A vector including energies with respect to the samples.
+     */
+    std::vector<FloatType> energies( const std::vector<Sample<IndexType>> &samples_like ) const {
+      const int64_t num_samples = samples_like.size();
+      std::vector<FloatType> en_vec( num_samples );
+      std::vector<char> found( num_samples, true );
+
+#pragma omp parallel for
+      for ( int64_t k = 0; k < num_samples; k++ ) {
+        AccVector s = AccVector::Zero( get_num_variables() );
+        for ( const auto &elem : samples_like[ k ] ) {
+          auto it = _label_to_idx.find( elem.first );
+          if ( it == _label_to_idx.end() ) {
+            found[ k ] = false;
+            break;
+          }
+          s[ it->second ] = elem.second;
+        }
+        en_vec[ k ] = _energy( s );
+      }
+
+      if ( std::find( found.begin(), found.end(), false ) != found.end() ) {
+        throw std::out_of_range( "the sample contains a variable not in the model." );
+      }
+      return en_vec;
+    }
+
+    /**
+     * @brief Determine the energies of the given samples stored in a contiguous array.
+     * The array is a row-major (num_samples x num_variables) matrix whose columns follow the order of get_variables().
+     *
+     * @tparam SampleType integer type of the samples (e.g. int8_t, int32_t)
+     * @param samples pointer to the first element of the array
+     * @param num_samples
+     * @return A vector including energies with respect to the samples.
+     */
+    template<typename SampleType>
+    std::vector<FloatType> energies( const SampleType *samples, size_t num_samples ) const {
+      static_assert( std::is_integral_v<SampleType>, "SampleType must be an integer type." );
+      const size_t num_variables = get_num_variables();
+      const std::vector<size_t> ranks = _generate_sorted_ranks();
+      std::vector<FloatType> en_vec( num_samples );
+
+#pragma omp parallel for
+      for ( int64_t k = 0; k < ( int64_t )num_samples; k++ ) {
+        const SampleType *row = samples + k * num_variables;
+        AccVector s( num_variables );
+        for ( size_t i = 0; i < num_variables; i++ ) {
+          s[ i ] = row[ ranks[ i ] ];
+        }
+        en_vec[ k ] = _energy( s );
+      }
+      return en_vec;
+    }
+
+    /* Conversions */
+    /**
+     * @brief Convert a binary quadratic model to QUBO format.
+     *
+     * @return A tuple including a quadratic bias and an offset.
+     */
+    std::tuple<Quadratic<IndexType, FloatType>, FloatType> to_qubo() {
+      // change vartype to binary
+      BinaryQuadraticModel<IndexType, FloatType, DataType> bqm = change_vartype( Vartype::BINARY, false );
+
+      const Linear<IndexType, FloatType> &linear = bqm.get_linear();
+      Quadratic<IndexType, FloatType> Q = bqm.get_quadratic();
+      FloatType offset = bqm.get_offset();
+      for ( const auto &it : linear ) {
+        Q[ std::make_pair( it.first, it.first ) ] = it.second;
+      }
+      return std::make_tuple( Q, offset );
+    }
+
+    /**
+     * @brief Create a binary quadratic model from a QUBO model.
+     *
+     * @param Q
+     * @param offset
+     *
+     * @return Binary quadratic model with vartype set to `.Vartype.BINARY`.
+     */
+    static BinaryQuadraticModel<IndexType, FloatType, DataType>
+    from_qubo( const Quadratic<IndexType, FloatType> &Q, FloatType offset = 0.0 ) {
+      Linear<IndexType, FloatType> linear;
+      Quadratic<IndexType, FloatType> quadratic;
+
+      for ( auto &&elem : Q ) {
+        const auto &key = elem.first;
+        const auto &value = elem.second;
+        if ( key.first == key.second ) {
+          linear[ key.first ] = value;
+        } else {
+          quadratic[ std::make_pair( key.first, key.second ) ] = value;
+        }
+      }
+
+      return BinaryQuadraticModel<IndexType, FloatType, DataType>( linear, quadratic, offset, Vartype::BINARY );
+    }
+
+    /**
+     * @brief Create a binary quadratic model from COO triplets.
+     * Each triplet (row[k], col[k], bias[k]) is added to the model; diagonal elements (row[k] == col[k]) are
+     * regarded as linear biases, (u, v) and (v, u) are merged and duplicated elements are summed up.
+     *
+     * @param row
+     * @param col
+     * @param bias
+     * @param offset
+     * @param vartype
+     *
+     * @return Binary quadratic model
+     */
+    static BinaryQuadraticModel<IndexType, FloatType, DataType> from_coo(
+        const std::vector<IndexType> &row,
+        const std::vector<IndexType> &col,
+        const std::vector<FloatType> &bias,
+        FloatType offset,
+        const Vartype vartype ) {
+      BinaryQuadraticModel<IndexType, FloatType, DataType> bqm(
+          Linear<IndexType, FloatType>(), Quadratic<IndexType, FloatType>(), offset, vartype );
+      bqm._initialize_biases( row, col, bias );
+      return bqm;
+    }
+
+    /**
+     * @brief Convert a binary quadratic model to Ising format.
+     *
+     * @return A tuple including a linear bias, a quadratic bias and an offset.
+     */
+    std::tuple<Linear<IndexType, FloatType>, Quadratic<IndexType, FloatType>, FloatType> to_ising() {
+      // change vartype to spin
+      BinaryQuadraticModel<IndexType, FloatType, DataType> bqm = change_vartype( Vartype::SPIN, false );
+
+      const Linear<IndexType, FloatType> &linear = bqm.get_linear();
+      const Quadratic<IndexType, FloatType> &quadratic = bqm.get_quadratic();
+      FloatType offset = bqm.get_offset();
+      return std::make_tuple( linear, quadratic, offset );
+    }
+
+    /**
+     * @brief Create a binary quadratic model from an Ising problem.
+     *
+     * @param linear
+     * @param quadratic
+     * @param offset
+     *
+     * @return Binary quadratic model with vartype set to `.Vartype.SPIN`.
+     */
+    static BinaryQuadraticModel<IndexType, FloatType, DataType> from_ising(
+        const Linear<IndexType, FloatType> &linear,
+        const Quadratic<IndexType, FloatType> &quadratic,
+        FloatType offset = 0.0 ) {
+      return BinaryQuadraticModel<IndexType, FloatType, DataType>( linear, quadratic, offset, Vartype::SPIN );
+    }
+
+    /**
+     * @brief generate the (dense) interaction matrix in the same triangular form as the Dense model,
+     * with the variables in the order of get_variables().
+     * Note that the generated matrix holds (N+1)^2 elements.
+     *
+     * @return corresponding interaction matrix (Eigen)
+     */
+    Matrix interaction_matrix() const {
+      const size_t N = get_num_variables();
+      const std::vector<size_t> ranks = _generate_sorted_ranks();
+      Matrix mat = Matrix::Zero( N + 1, N + 1 );
+      for ( size_t j = 0; j < N; j++ ) {
+        const FloatType *column = _quadratic.data() + _column_offset( j );
+        for ( size_t i = 0; i < j; i++ ) {
+          mat( std::min( ranks[ i ], ranks[ j ] ), std::max( ranks[ i ], ranks[ j ] ) ) = column[ i ];
+        }
+        mat( ranks[ j ], N ) = _linear[ j ];
+      }
+      mat( N, N ) = 1;
+      return mat;
+    }
+
+    using json = nlohmann::json;
+
+    /**
+     * @brief Convert the binary quadratic model to a serializable object.
+     * The sparse schema (3.0.0) is used so that the full matrix is never materialized.
+     *
+     * @return An object that can be serialized (nlohmann::json)
+     */
+    json to_serializable() const {
+      std::string schema_version = "3.0.0";
+
+      // set index_dtype
+      std::string index_dtype = this->get_num_variables() <= 65536UL ? "uint16" : "uint32";
+
+      // set bias_type
+      std::string bias_type;
+      if ( typeid( m_offset ) == typeid( float ) ) {
+        bias_type = "float32";
+      } else if ( typeid( m_offset ) == typeid( double ) ) {
+        bias_type = "float64";
+      } else {
+        throw std::runtime_error( "FloatType must be float or double." );
+      }
+
+      // set variable type
+      std::string variable_type;
+      if ( m_vartype == Vartype::SPIN ) {
+        variable_type = "SPIN";
+      } else if ( m_vartype == Vartype::BINARY ) {
+        variable_type = "BINARY";
+      } else {
+        throw std::runtime_error( "Variable type must be SPIN or BINARY." );
+      }
+
+      json output;
+      output[ "type" ] = "BinaryQuadraticModel";
+      output[ "version" ] = { { "bqm_schema", schema_version } };
+      output[ "variable_labels" ] = this->get_variables();
+      output[ "use_bytes" ] = false;
+      output[ "index_type" ] = index_dtype;
+      output[ "bias_type" ] = bias_type;
+      output[ "num_variables" ] = this->get_num_variables();
+      output[ "variable_type" ] = variable_type;
+      output[ "offset" ] = m_offset;
+      output[ "info" ] = "";
+
+      // biases
+      const size_t N = get_num_variables();
+      const std::vector<size_t> ranks = _generate_sorted_ranks();
+
+      std::vector<FloatType> l_bias( N );
+      for ( size_t i = 0; i < N; i++ ) {
+        l_bias[ ranks[ i ] ] = _linear[ i ];
+      }
+
+      // (tail, head, bias) in the column-major order of the sorted labels
+      std::vector<std::tuple<size_t, size_t, FloatType>> q_elems;
+      for ( size_t j = 0; j < N; j++ ) {
+        const FloatType *column = _quadratic.data() + _column_offset( j );
+        for ( size_t i = 0; i < j; i++ ) {
+          if ( column[ i ] != 0 ) {
+            q_elems.emplace_back(
+                std::max( ranks[ i ], ranks[ j ] ), std::min( ranks[ i ], ranks[ j ] ), column[ i ] );
+          }
+        }
+      }
+      if ( !_sorted ) {
+        std::sort( q_elems.begin(), q_elems.end() );
+      }
+
+      std::vector<FloatType> q_bias;
+      std::vector<size_t> q_head;
+      std::vector<size_t> q_tail;
+      q_bias.reserve( q_elems.size() );
+      q_head.reserve( q_elems.size() );
+      q_tail.reserve( q_elems.size() );
+      for ( const auto &elem : q_elems ) {
+        q_tail.push_back( std::get<0>( elem ) );
+        q_head.push_back( std::get<1>( elem ) );
+        q_bias.push_back( std::get<2>( elem ) );
+      }
+
+      output[ "linear_biases" ] = l_bias;
+      output[ "quadratic_biases" ] = q_bias;
+      output[ "quadratic_head" ] = q_head;
+      output[ "quadratic_tail" ] = q_tail;
+      output[ "num_interactions" ] = q_bias.size();
+
+      return output;
+    }
+
+    /**
+     * @brief Create a BinaryQuadraticModel instance from a serializable object.
+     * Both the sparse (3.0.0) and the dense (3.0.0-dense) schema are accepted.
+     *
+     * @tparam IndexType_serial
+     * @tparam FloatType_serial
+     * @param input
+     * @return BinaryQuadraticModel<IndexType_serial, FloatType_serial>
+     */
+    template<typename IndexType_serial = IndexType, typename FloatType_serial = FloatType>
+    static BinaryQuadraticModel<IndexType_serial, FloatType_serial, DataType> from_serializable( const json &input ) {
+      using BQM = BinaryQuadraticModel<IndexType_serial, FloatType_serial, DataType>;
+      // extract type and version
+      std::string type = input[ "type" ];
+      if ( type != "BinaryQuadraticModel" ) {
+        throw std::runtime_error( "Type must be \"BinaryQuadraticModel\".\n" );
+      }
+      std::string version = input[ "version" ][ "bqm_schema" ];
+      if ( version != "3.0.0" && version != "3.0.0-dense" ) {
+        throw std::runtime_error( "bqm_schema must be 3.0.0 or 3.0.0-dense.\n" );
+      }
+
+      // extract variable_type
+      Vartype vartype;
+      std::string variable_type = input[ "variable_type" ];
+      if ( variable_type == "SPIN" ) {
+        vartype = Vartype::SPIN;
+      } else if ( variable_type == "BINARY" ) {
+        vartype = Vartype::BINARY;
+      } else {
+        throw std::runtime_error( "variable_type must be SPIN or BINARY." );
+      }
+
+      // extract biases
+      std::vector<IndexType_serial> variables = input[ "variable_labels" ];
+      FloatType offset = input[ "offset" ];
+
+      if ( version == "3.0.0-dense" ) {
+        std::vector<FloatType_serial> biases = input[ "biases" ];
+        size_t mat_size = variables.size() + 1;
+        Eigen::Map<typename BQM::DenseMatrix> mat( biases.data(), mat_size, mat_size );
+        return BQM( mat, variables, offset, vartype );
+      }
+
+      std::vector<FloatType_serial> l_bias = input[ "linear_biases" ];
+      std::vector<size_t> q_head = input[ "quadratic_head" ];
+      std::vector<size_t> q_tail = input[ "quadratic_tail" ];
+      std::vector<FloatType_serial> q_bias = input[ "quadratic_biases" ];
+      const size_t N = variables.size();
+      if ( l_bias.size() != N || q_head.size() != q_bias.size() || q_tail.size() != q_bias.size() ) {
+        throw std::runtime_error( "the sizes of the bias arrays do not match." );
+      }
+      for ( size_t k = 0; k < q_bias.size(); k++ ) {
+        if ( q_head[ k ] >= N || q_tail[ k ] >= N || q_head[ k ] == q_tail[ k ] ) {
+          throw std::runtime_error( "the quadratic indices must be distinct indices of the variables." );
+        }
+      }
+
+      BQM bqm( Linear<IndexType_serial, FloatType_serial>(), Quadratic<IndexType_serial, FloatType_serial>(), offset, vartype );
+      bqm._initialize_labels( variables );
+      std::vector<size_t> indices( variables.size() );
+      for ( size_t i = 0; i < variables.size(); i++ ) {
+        indices[ i ] = bqm._label_to_idx.at( variables[ i ] );
+      }
+      for ( size_t i = 0; i < l_bias.size(); i++ ) {
+        bqm._linear[ indices[ i ] ] += l_bias[ i ];
+      }
+      for ( size_t k = 0; k < q_bias.size(); k++ ) {
+        bqm._quad( indices[ q_head[ k ] ], indices[ q_tail[ k ] ] ) += q_bias[ k ];
+      }
+      return bqm;
+    }
+
+    /**
+     * @brief Save the binary quadratic model to a file in the binary format (see binary_format.hpp).
+     * The packed storage is written as it is in the PACKED payload if the labels are sorted.
+     *
+     * @param path
+     */
+    void save( const std::string &path ) const {
+      if ( _sorted ) {
+        write_binary_packed( path, _idx_to_label, _linear.data(), _quadratic.data(), m_offset, m_vartype );
+        return;
+      }
+
+      const size_t N = get_num_variables();
+      const std::vector<size_t> indices = _generate_sorted_indices();
+      std::vector<FloatType> linear( N );
+      std::vector<FloatType> upper( _column_offset( N ) );
+      for ( size_t j = 0; j < N; j++ ) {
+        linear[ j ] = _linear[ indices[ j ] ];
+        FloatType *column = upper.data() + _column_offset( j );
+        for ( size_t i = 0; i < j; i++ ) {
+          column[ i ] = _quad( indices[ i ], indices[ j ] );
+        }
+      }
+      write_binary_packed( path, get_variables(), linear.data(), upper.data(), m_offset, m_vartype );
+    }
+
+    /**
+     * @brief Load a binary quadratic model from a file in the binary format.
+     * Both the PACKED and the CSR payload are accepted. The file is mapped into memory and a PACKED payload is copied
+     * straight into the packed storage.
+     *
+     * @param path
+     * @return BinaryQuadraticModel
+     */
+    static BinaryQuadraticModel<IndexType, FloatType, DataType> load( const std::string &path ) {
+      BinaryReader reader( path );
+      std::vector<IndexType> labels = reader.read_labels<IndexType>();
+      const BinaryQuadraticPayload<FloatType> payload = reader.read_quadratic_payload<FloatType>();
+      const size_t N = payload.num_variables;
+
+      BinaryQuadraticModel<IndexType, FloatType, DataType> bqm(
+          Linear<IndexType, FloatType>(),
+          Quadratic<IndexType, FloatType>(),
+          static_cast<FloatType>( reader.header().offset ),
+          reader.header().vartype );
+      bqm._idx_to_label = std::move( labels );
+      bqm._set_label_to_idx();
+      if ( bqm._label_to_idx.size() != N ) {
+        throw std::runtime_error( "the binary file contains duplicated labels." );
+      }
+      bqm._sorted = std::is_sorted( bqm._idx_to_label.begin(), bqm._idx_to_label.end() );
+      bqm._sorted_labels_flag.reset();
+
+      bqm._linear.assign( payload.linear, payload.linear + N );
+      if ( payload.kind == BinaryPayload::PACKED ) {
+        bqm._quadratic.assign( payload.upper, payload.upper + _column_offset( N ) );
+      } else {
+        bqm._quadratic.assign( _column_offset( N ), 0 );
+        payload.for_each_interaction( [ &bqm ]( size_t i, size_t j, FloatType bias ) { bqm._quad( i, j ) = bias; } );
+      }
+      return bqm;
+    }
+
+    template<typename, typename, typename>
+    friend class BinaryQuadraticModel;
+  };
+} // namespace cimod
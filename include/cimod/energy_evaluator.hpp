@@ -0,0 +1,294 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cimod/binary_quadratic_model.hpp"
+#include "cimod/binary_quadratic_model_dict.hpp"
+#include "cimod/vartypes.hpp"
+
+namespace cimod {
+
+  /**
+   * @brief Class for evaluating energy differences of single-variable flips.
+   *
+   * The evaluator takes a snapshot of a binary quadratic model (Dense, Sparse or Dict) as a symmetric adjacency list
+   * and holds the current state together with the local field of each variable:
+   * \f[
+   * f_i = h_i + \sum_{j} J_{ij} s_j,
+   * \f]
+   * so that delta_energy() and flip() cost O(degree(v)). Later modifications of the model are not reflected.
+   *
+   * @tparam IndexType
+   * @tparam FloatType
+   * @tparam DataType
+   */
+  template<typename IndexType, typename FloatType, typename DataType>
+  class EnergyEvaluator {
+  public:
+    using BQM = BinaryQuadraticModel<IndexType, FloatType, DataType>;
+
+  protected:
+    /**
+     * @brief variable labels (sorted)
+     */
+    std::vector<IndexType> m_variables;
+
+    /**
+     * @brief dict for converting label to index
+     */
+    std::unordered_map<IndexType, size_t> m_label_to_idx;
+
+    /**
+     * @brief linear biases
+     */
+    std::vector<FloatType> m_linear;
+
+    /**
+     * @brief neighbors of variable i are m_adj_idx[m_adj_ptr[i]:m_adj_ptr[i+1]]
+     */
+    std::vector<size_t> m_adj_ptr;
+
+    /**
+     * @brief indices of neighbors
+     */
+    std::vector<size_t> m_adj_idx;
+
+    /**
+     * @brief quadratic biases corresponding to m_adj_idx
+     */
+    std::vector<FloatType> m_adj_bias;
+
+    /**
+     * @brief current state
+     */
+    std::vector<int32_t> m_state;
+
+    /**
+     * @brief current local fields
+     */
+    std::vector<FloatType> m_local_field;
+
+    /**
+     * @brief current energy
+     */
+    FloatType m_energy;
+
+    /**
+     * @brief The model's type.
+     */
+    Vartype m_vartype;
+
+    /**
+     * @brief value of variable i after a flip
+     *
+     * @param i
+     *
+     * @return flipped value
+     */
+    inline int32_t _flipped( size_t i ) const {
+      return ( m_vartype == Vartype::SPIN ) ? -m_state[ i ] : 1 - m_state[ i ];
+    }
+
+  public:
+    /**
+     * @brief EnergyEvaluator constructor.
+     *
+     * @param bqm
+     * @param sample initial state. All variables in bqm must be contained.
+     */
+    EnergyEvaluator( const BQM &bqm, const Sample<IndexType> &sample ) :
+        m_variables( bqm.get_variables() ),
+        m_energy( bqm.get_offset() ),
+        m_vartype( bqm.get_vartype() ) {
+      if ( m_vartype == Vartype::NONE ) {
+        throw std::runtime_error( "Unknown vartype detected" );
+      }
+
+      const size_t num_variables = m_variables.size();
+      m_label_to_idx.reserve( num_variables );
+      for ( size_t i = 0; i < num_variables; i++ ) {
+        m_label_to_idx[ m_variables[ i ] ] = i;
+      }
+
+      // state and linear biases
+      m_state.resize( num_variables );
+      m_linear.assign( num_variables, 0 );
+      for ( size_t i = 0; i < num_variables; i++ ) {
+        m_state[ i ] = sample.at( m_variables[ i ] );
+      }
+      for ( const auto &it : bqm.get_linear() ) {
+        m_linear[ m_label_to_idx.at( it.first ) ] += it.second;
+      }
+
+      // symmetric adjacency list (CSR)
+      const auto &quadratic = bqm.get_quadratic();
+      std::vector<std::pair<size_t, size_t>> edges;
+      edges.reserve( quadratic.size() );
+      m_adj_ptr.assign( num_variables + 1, 0 );
+      for ( const auto &it : quadratic ) {
+        size_t i = m_label_to_idx.at( it.first.first );
+        size_t j = m_label_to_idx.at( it.first.second );
+        edges.emplace_back( i, j );
+        m_adj_ptr[ i + 1 ]++;
+        m_adj_ptr[ j + 1 ]++;
+      }
+      for ( size_t i = 0; i < num_variables; i++ ) {
+        m_adj_ptr[ i + 1 ] += m_adj_ptr[ i ];
+      }
+
+      m_adj_idx.resize( m_adj_ptr.back() );
+      m_adj_bias.resize( m_adj_ptr.back() );
+      std::vector<size_t> pos( m_adj_ptr.begin(), m_adj_ptr.end() - 1 );
+      size_t k = 0;
+      for ( const auto &it : quadratic ) {
+        size_t i = edges[ k ].first;
+        size_t j = edges[ k ].second;
+        m_adj_idx[ pos[ i ] ] = j;
+        m_adj_bias[ pos[ i ]++ ] = it.second;
+        m_adj_idx[ pos[ j ] ] = i;
+        m_adj_bias[ pos[ j ]++ ] = it.second;
+        k++;
+      }
+
+      // local fields and energy
+      m_local_field = m_linear;
+      for ( size_t i = 0; i < num_variables; i++ ) {
+        for ( size_t p = m_adj_ptr[ i ]; p < m_adj_ptr[ i + 1 ]; p++ ) {
+          m_local_field[ i ] += m_adj_bias[ p ] * m_state[ m_adj_idx[ p ] ];
+        }
+      }
+      // each interaction is counted twice in the local fields
+      for ( size_t i = 0; i < num_variables; i++ ) {
+        m_energy += 0.5 * m_state[ i ] * ( m_linear[ i ] + m_local_field[ i ] );
+      }
+    }
+
+    /**
+     * @brief Get variables
+     *
+     * @return variables in index order
+     */
+    const std::vector<IndexType> &get_variables() const {
+      return m_variables;
+    }
+
+    /**
+     * @brief Get the index of variable v
+     *
+     * @param v
+     *
+     * @return index
+     */
+    size_t get_index( const IndexType &v ) const {
+      return m_label_to_idx.at( v );
+    }
+
+    /**
+     * @brief Get the current energy
+     *
+     * @return energy
+     */
+    FloatType energy() const {
+      return m_energy;
+    }
+
+    /**
+     * @brief Get the current state of variable v
+     *
+     * @param v
+     *
+     * @return state
+     */
+    int32_t get_state( const IndexType &v ) const {
+      return m_state[ m_label_to_idx.at( v ) ];
+    }
+
+    /**
+     * @brief Get the current state as a sample
+     *
+     * @return sample
+     */
+    Sample<IndexType> get_sample() const {
+      Sample<IndexType> sample;
+      sample.reserve( m_variables.size() );
+      for ( size_t i = 0; i < m_variables.size(); i++ ) {
+        sample[ m_variables[ i ] ] = m_state[ i ];
+      }
+      return sample;
+    }
+
+    /**
+     * @brief Get the current local field of variable v
+     *
+     * @param v
+     *
+     * @return local field
+     */
+    FloatType get_local_field( const IndexType &v ) const {
+      return m_local_field[ m_label_to_idx.at( v ) ];
+    }
+
+    /**
+     * @brief Energy difference caused by flipping the variable with index i
+     *
+     * @param i
+     *
+     * @return energy difference
+     */
+    FloatType delta_energy_index( size_t i ) const {
+      return ( _flipped( i ) - m_state[ i ] ) * m_local_field[ i ];
+    }
+
+    /**
+     * @brief Energy difference caused by flipping variable v
+     *
+     * @param v
+     *
+     * @return energy difference
+     */
+    FloatType delta_energy( const IndexType &v ) const {
+      return delta_energy_index( m_label_to_idx.at( v ) );
+    }
+
+    /**
+     * @brief Flip the variable with index i and update the local fields of its neighbors
+     *
+     * @param i
+     */
+    void flip_index( size_t i ) {
+      const int32_t diff = _flipped( i ) - m_state[ i ];
+      m_energy += diff * m_local_field[ i ];
+      for ( size_t p = m_adj_ptr[ i ]; p < m_adj_ptr[ i + 1 ]; p++ ) {
+        m_local_field[ m_adj_idx[ p ] ] += m_adj_bias[ p ] * diff;
+      }
+      m_state[ i ] += diff;
+    }
+
+    /**
+     * @brief Flip variable v and update the local fields of its neighbors
+     *
+     * @param v
+     */
+    void flip( const IndexType &v ) {
+      flip_index( m_label_to_idx.at( v ) );
+    }
+  };
+} // namespace cimod
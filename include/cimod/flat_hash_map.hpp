@@ -0,0 +1,529 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cimod {
+
+  /**
+   * @brief Open-addressing hash map with Robin Hood probing and backward-shift deletion.
+   *
+   * The entries are stored in a flat array, so that lookups and iterations do not chase pointers and an insertion
+   * does not allocate unless the table grows. Probes do not wrap around: a cluster running past the last home slot
+   * continues into a tail of extra slots, so that erasing by an iterator never moves a visited entry ahead of it.
+   * The interface follows std::unordered_map with the following differences:
+   * - value_type is std::pair<Key, T> (the key is not const); the key of an entry must not be modified.
+   * - an insertion invalidates all iterators, pointers and references; an erasure invalidates those of the
+   *   following entries, since entries are moved.
+   * - Key and T must be default constructible and move assignable (empty slots hold value_type()).
+   *
+   * @tparam Key
+   * @tparam T
+   * @tparam Hash
+   * @tparam KeyEqual
+   */
+  template<class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+  class FlatHashMap {
+  public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+
+  private:
+    /**
+     * @brief forward iterator over the occupied slots
+     */
+    template<bool IsConst>
+    class Iterator {
+      friend class FlatHashMap;
+      using Map = std::conditional_t<IsConst, const FlatHashMap, FlatHashMap>;
+
+      Map *m_map = nullptr;
+      size_type m_index = 0;
+
+      Iterator( Map *map, size_type index ) : m_map( map ), m_index( index ) {
+      }
+
+      void skip_empty() {
+        while ( m_index < m_map->m_dist.size() && m_map->m_dist[ m_index ] == 0 ) {
+          m_index++;
+        }
+      }
+
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = typename FlatHashMap::value_type;
+      using difference_type = std::ptrdiff_t;
+      using reference = std::conditional_t<IsConst, const value_type &, value_type &>;
+      using pointer = std::conditional_t<IsConst, const value_type *, value_type *>;
+
+      Iterator() = default;
+
+      template<bool C = IsConst, std::enable_if_t<C, std::nullptr_t> = nullptr>
+      Iterator( const Iterator<false> &other ) : m_map( other.m_map ), m_index( other.m_index ) {
+      }
+
+      reference operator*() const {
+        return m_map->m_slots[ m_index ];
+      }
+
+      pointer operator->() const {
+        return &m_map->m_slots[ m_index ];
+      }
+
+      Iterator &operator++() {
+        m_index++;
+        skip_empty();
+        return *this;
+      }
+
+      Iterator operator++( int ) {
+        Iterator ret = *this;
+        ++*this;
+        return ret;
+      }
+
+      friend bool operator==( const Iterator &lhs, const Iterator &rhs ) {
+        return lhs.m_index == rhs.m_index;
+      }
+
+      friend bool operator!=( const Iterator &lhs, const Iterator &rhs ) {
+        return lhs.m_index != rhs.m_index;
+      }
+    };
+
+  public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+
+    explicit FlatHashMap( size_type bucket_count, const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual() ) :
+        m_hash( hash ),
+        m_equal( equal ) {
+      reserve( bucket_count );
+    }
+
+    template<class InputIt>
+    FlatHashMap( InputIt first, InputIt last ) {
+      insert( first, last );
+    }
+
+    FlatHashMap( std::initializer_list<value_type> init ) {
+      reserve( init.size() );
+      insert( init.begin(), init.end() );
+    }
+
+    FlatHashMap( const FlatHashMap & ) = default;
+    FlatHashMap( FlatHashMap && ) noexcept = default;
+    FlatHashMap &operator=( const FlatHashMap & ) = default;
+    FlatHashMap &operator=( FlatHashMap && ) noexcept = default;
+
+    /* Iterators */
+
+    iterator begin() {
+      iterator it( this, 0 );
+      it.skip_empty();
+      return it;
+    }
+
+    const_iterator begin() const {
+      const_iterator it( this, 0 );
+      it.skip_empty();
+      return it;
+    }
+
+    const_iterator cbegin() const {
+      return begin();
+    }
+
+    iterator end() {
+      return iterator( this, m_dist.size() );
+    }
+
+    const_iterator end() const {
+      return const_iterator( this, m_dist.size() );
+    }
+
+    const_iterator cend() const {
+      return end();
+    }
+
+    /* Capacity */
+
+    bool empty() const {
+      return m_size == 0;
+    }
+
+    size_type size() const {
+      return m_size;
+    }
+
+    /**
+     * @brief the number of home slots
+     */
+    size_type bucket_count() const {
+      return m_capacity;
+    }
+
+    float load_factor() const {
+      return m_capacity == 0 ? 0.0f : static_cast<float>( m_size ) / static_cast<float>( m_capacity );
+    }
+
+    /**
+     * @brief Reserve slots for count entries without rehashing.
+     *
+     * @param count
+     */
+    void reserve( size_type count ) {
+      size_type capacity = MIN_CAPACITY;
+      while ( max_size_for( capacity ) < count ) {
+        capacity *= 2;
+      }
+      if ( capacity > m_capacity ) {
+        rehash( capacity );
+      }
+    }
+
+    /* Modifiers */
+
+    void clear() {
+      if ( m_size == 0 ) {
+        return;
+      }
+      for ( size_type i = 0; i < m_dist.size(); i++ ) {
+        if ( m_dist[ i ] != 0 ) {
+          m_slots[ i ] = value_type();
+          m_dist[ i ] = 0;
+        }
+      }
+      m_size = 0;
+    }
+
+    template<class K, class... Args>
+    std::pair<iterator, bool> try_emplace( K &&key, Args &&...args ) {
+      Probe probe = probe_key( key );
+      if ( probe.found ) {
+        return { iterator( this, probe.index ), false };
+      }
+      if ( m_size + 1 > max_size_for( m_capacity ) ) {
+        rehash( m_capacity == 0 ? MIN_CAPACITY : 2 * m_capacity );
+        probe = probe_key( key );
+      }
+      place(
+          probe.index,
+          probe.dist,
+          value_type(
+              std::piecewise_construct,
+              std::forward_as_tuple( std::forward<K>( key ) ),
+              std::forward_as_tuple( std::forward<Args>( args )... ) ) );
+      m_size++;
+      return { iterator( this, probe.index ), true };
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> emplace( Args &&...args ) {
+      value_type value( std::forward<Args>( args )... );
+      return try_emplace( std::move( value.first ), std::move( value.second ) );
+    }
+
+    std::pair<iterator, bool> insert( const value_type &value ) {
+      return try_emplace( value.first, value.second );
+    }
+
+    std::pair<iterator, bool> insert( value_type &&value ) {
+      return try_emplace( std::move( value.first ), std::move( value.second ) );
+    }
+
+    template<class InputIt>
+    void insert( InputIt first, InputIt last ) {
+      for ( ; first != last; ++first ) {
+        insert( *first );
+      }
+    }
+
+    void insert( std::initializer_list<value_type> init ) {
+      insert( init.begin(), init.end() );
+    }
+
+    template<class M>
+    std::pair<iterator, bool> insert_or_assign( const Key &key, M &&obj ) {
+      auto ret = try_emplace( key, std::forward<M>( obj ) );
+      if ( !ret.second ) {
+        ret.first->second = std::forward<M>( obj );
+      }
+      return ret;
+    }
+
+    /**
+     * @brief Erase the entry of key.
+     *
+     * @param key
+     *
+     * @return the number of erased entries (0 or 1)
+     */
+    size_type erase( const Key &key ) {
+      const Probe probe = probe_key( key );
+      if ( !probe.found ) {
+        return 0;
+      }
+      erase_slot( probe.index );
+      return 1;
+    }
+
+    /**
+     * @brief Erase the entry at pos.
+     *
+     * @param pos
+     *
+     * @return iterator following the erased entry
+     */
+    iterator erase( const_iterator pos ) {
+      erase_slot( pos.m_index );
+      iterator it( this, pos.m_index );
+      it.skip_empty();
+      return it;
+    }
+
+    void swap( FlatHashMap &other ) noexcept {
+      using std::swap;
+      swap( m_slots, other.m_slots );
+      swap( m_dist, other.m_dist );
+      swap( m_size, other.m_size );
+      swap( m_capacity, other.m_capacity );
+      swap( m_hash, other.m_hash );
+      swap( m_equal, other.m_equal );
+    }
+
+    /* Lookup */
+
+    T &at( const Key &key ) {
+      const Probe probe = probe_key( key );
+      if ( !probe.found ) {
+        throw std::out_of_range( "FlatHashMap::at" );
+      }
+      return m_slots[ probe.index ].second;
+    }
+
+    const T &at( const Key &key ) const {
+      const Probe probe = probe_key( key );
+      if ( !probe.found ) {
+        throw std::out_of_range( "FlatHashMap::at" );
+      }
+      return m_slots[ probe.index ].second;
+    }
+
+    T &operator[]( const Key &key ) {
+      return try_emplace( key ).first->second;
+    }
+
+    T &operator[]( Key &&key ) {
+      return try_emplace( std::move( key ) ).first->second;
+    }
+
+    size_type count( const Key &key ) const {
+      return probe_key( key ).found ? 1 : 0;
+    }
+
+    bool contains( const Key &key ) const {
+      return probe_key( key ).found;
+    }
+
+    iterator find( const Key &key ) {
+      const Probe probe = probe_key( key );
+      return probe.found ? iterator( this, probe.index ) : end();
+    }
+
+    const_iterator find( const Key &key ) const {
+      const Probe probe = probe_key( key );
+      return probe.found ? const_iterator( this, probe.index ) : end();
+    }
+
+    hasher hash_function() const {
+      return m_hash;
+    }
+
+    key_equal key_eq() const {
+      return m_equal;
+    }
+
+    friend bool operator==( const FlatHashMap &lhs, const FlatHashMap &rhs ) {
+      if ( lhs.size() != rhs.size() ) {
+        return false;
+      }
+      for ( const auto &it : lhs ) {
+        auto found = rhs.find( it.first );
+        if ( found == rhs.end() || !( found->second == it.second ) ) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    friend bool operator!=( const FlatHashMap &lhs, const FlatHashMap &rhs ) {
+      return !( lhs == rhs );
+    }
+
+  private:
+    static constexpr size_type MIN_CAPACITY = 8;
+
+    //! @brief initial number of the extra slots after the last home slot
+    static constexpr size_type TAIL = 8;
+
+    /**
+     * @brief the maximum number of entries of a table with capacity slots (load factor 7/8)
+     */
+    static size_type max_size_for( size_type capacity ) {
+      return capacity - capacity / 8;
+    }
+
+    /**
+     * @brief result of a probe: the slot of the key if found, otherwise the slot (and its probe distance) where the
+     * key is inserted.
+     */
+    struct Probe {
+      size_type index;
+      uint32_t dist;
+      bool found;
+    };
+
+    /**
+     * @brief home slot of a hash value. The hash is mixed (the finalizer of MurmurHash3) and its lower bits are
+     * taken, so that hashes differing only in the upper bits (e.g. std::hash of integers) are spread, and inserting
+     * the entries of a table in its iteration order into a smaller table does not pile them up in the first slots.
+     */
+    size_type home( std::size_t hash ) const {
+      uint64_t x = static_cast<uint64_t>( hash );
+      x ^= x >> 33;
+      x *= UINT64_C( 0xff51afd7ed558ccd );
+      x ^= x >> 33;
+      return static_cast<size_type>( x ) & ( m_capacity - 1 );
+    }
+
+    template<class K>
+    Probe probe_key( const K &key ) const {
+      if ( m_capacity == 0 ) {
+        return { 0, 1, false };
+      }
+      size_type i = home( m_hash( key ) );
+      uint32_t dist = 1;
+      // Robin Hood invariant: the key cannot be behind an entry closer to its home slot than the key would be
+      while ( i < m_dist.size() && m_dist[ i ] >= dist ) {
+        if ( m_dist[ i ] == dist && m_equal( m_slots[ i ].first, key ) ) {
+          return { i, dist, true };
+        }
+        i++;
+        dist++;
+      }
+      return { i, dist, false };
+    }
+
+    /**
+     * @brief place value at slot i with probe distance dist, displacing the following entries of the cluster.
+     * The tail is extended if the cluster reaches the last slot.
+     */
+    void place( size_type i, uint32_t dist, value_type &&value ) {
+      while ( i < m_dist.size() && m_dist[ i ] != 0 ) {
+        if ( m_dist[ i ] < dist ) {
+          std::swap( m_slots[ i ], value );
+          std::swap( m_dist[ i ], dist );
+        }
+        i++;
+        dist++;
+      }
+      if ( i == m_dist.size() ) {
+        m_slots.emplace_back( std::move( value ) );
+        m_dist.push_back( dist );
+      } else {
+        m_slots[ i ] = std::move( value );
+        m_dist[ i ] = dist;
+      }
+    }
+
+    /**
+     * @brief erase the entry at slot i and shift the following entries of the cluster back by one slot
+     */
+    void erase_slot( size_type i ) {
+      size_type next = i + 1;
+      while ( next < m_dist.size() && m_dist[ next ] > 1 ) {
+        m_slots[ i ] = std::move( m_slots[ next ] );
+        m_dist[ i ] = m_dist[ next ] - 1;
+        i = next++;
+      }
+      m_slots[ i ] = value_type();
+      m_dist[ i ] = 0;
+      m_size--;
+    }
+
+    void rehash( size_type capacity ) {
+      std::vector<value_type> slots( capacity + TAIL );
+      std::vector<uint32_t> dist( capacity + TAIL, 0 );
+      std::swap( slots, m_slots );
+      std::swap( dist, m_dist );
+      m_capacity = capacity;
+      for ( size_type i = 0; i < dist.size(); i++ ) {
+        if ( dist[ i ] != 0 ) {
+          const Probe probe = probe_key( slots[ i ].first );
+          place( probe.index, probe.dist, std::move( slots[ i ] ) );
+        }
+      }
+    }
+
+    //! @brief entries (m_capacity home slots and the tail); empty slots hold value_type()
+    std::vector<value_type> m_slots;
+
+    //! @brief probe distances of the slots plus one (0 means an empty slot)
+    std::vector<uint32_t> m_dist;
+
+    size_type m_size = 0;
+    size_type m_capacity = 0;
+    Hash m_hash;
+    KeyEqual m_equal;
+  };
+
+  /**
+   * @brief Hash map of the model containers (Linear, Quadratic, Polynomial).
+   * std::unordered_map by default, FlatHashMap if CIMOD_USE_FLAT_HASH_MAP is defined.
+   *
+   * @tparam Key
+   * @tparam T
+   * @tparam Hash
+   */
+#ifdef CIMOD_USE_FLAT_HASH_MAP
+  template<class Key, class T, class Hash = std::hash<Key>>
+  using HashMap = FlatHashMap<Key, T, Hash>;
+#else
+  template<class Key, class T, class Hash = std::hash<Key>>
+  using HashMap = std::unordered_map<Key, T, Hash>;
+#endif
+
+} // namespace cimod
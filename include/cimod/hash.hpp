@@ -14,15 +14,49 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+namespace cimod {
+  /**
+   * @brief 64-bit mixer (the SplitMix64 finalizer; a full-avalanche finalizer like those of xxh3 and wyhash).
+   * Every input bit affects every output bit, so that the identity std::hash of integers and lattice-structured
+   * labels do not cluster in the buckets.
+   *
+   * @param x
+   * @return mixed value
+   */
+  inline uint64_t mix_hash( uint64_t x ) {
+    x ^= x >> 30;
+    x *= UINT64_C( 0xbf58476d1ce4e5b9 );
+    x ^= x >> 27;
+    x *= UINT64_C( 0x94d049bb133111eb );
+    x ^= x >> 31;
+    return x;
+  }
+
+  /**
+   * @brief combine the hash value h into seed (the order of the combined values matters)
+   *
+   * @param seed
+   * @param h
+   * @return combined hash value
+   */
+  inline std::size_t combine_hash( std::size_t seed, std::size_t h ) {
+    return static_cast<std::size_t>(
+        mix_hash( static_cast<uint64_t>( seed ) ^ ( static_cast<uint64_t>( h ) + UINT64_C( 0x9e3779b97f4a7c15 ) ) ) );
+  }
+} // namespace cimod
+
 template<typename T>
 inline void hash_combine( std::size_t& seed, const T& val ) {
   std::hash<T> hasher;
-  seed ^= hasher( val ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
+  seed = cimod::combine_hash( seed, hasher( val ) );
 }
 
 template<class... TupleArgs>
@@ -65,18 +99,21 @@ namespace cimod {
   struct pair_hash {
     template<class T1, class T2>
     std::size_t operator()( const std::pair<T1, T2>& p ) const {
-      std::size_t lhs = std::hash<T1>()( p.first ), rhs = std::hash<T2>()( p.second );
-      return lhs ^ ( rhs + 0x9e3779b9 + ( lhs << 6 ) + ( lhs >> 2 ) );
+      return combine_hash( combine_hash( 0, std::hash<T1>()( p.first ) ), std::hash<T2>()( p.second ) );
     }
   };
 
+  /**
+   * @brief Hash function for the keys of polynomial interactions
+   *
+   */
   struct vector_hash {
 
     template<class T>
     std::size_t operator()( const std::vector<T>& V ) const {
       std::size_t hash = V.size();
       for ( auto& i : V ) {
-        hash ^= std::hash<T>()( i ) + 0x9e3779b9 + ( hash << 6 ) + ( hash >> 2 );
+        hash = combine_hash( hash, std::hash<T>()( i ) );
       }
       return hash;
     }
@@ -0,0 +1,175 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+
+#include <nlohmann/json.hpp>
+
+#include "cimod/io/text.hpp"
+
+namespace cimod {
+  namespace io {
+
+    /**
+     * @brief Read a binary quadratic model in the bqpjson format.
+     *
+     * The biases and the offset are multiplied by `scale`, and every id of `variable_ids` becomes a variable of the
+     * model even if it has no term. The document is parsed as a whole, so it is not read in chunks.
+     *
+     * @tparam IndexType integer label type
+     * @tparam FloatType
+     * @param path
+     *
+     * @return triplets
+     */
+    template<typename IndexType = int64_t, typename FloatType = double>
+    QuadraticTriplets<IndexType, FloatType> read_bqpjson( const std::string &path ) {
+      static_assert( std::is_integral_v<IndexType>, "the bqpjson format requires integer labels." );
+
+      std::ifstream ifs( path );
+      if ( !ifs ) {
+        throw std::runtime_error( "failed to open the file: " + path );
+      }
+      const nlohmann::json input = nlohmann::json::parse( ifs );
+      for ( const char *key : { "variable_ids", "variable_domain", "linear_terms", "quadratic_terms" } ) {
+        if ( !input.contains( key ) ) {
+          throw std::runtime_error( std::string( "\"" ) + key + "\" is missing in the bqpjson file." );
+        }
+      }
+
+      QuadraticTriplets<IndexType, FloatType> triplets;
+      const std::string domain = input[ "variable_domain" ].get<std::string>();
+      if ( domain == "spin" ) {
+        triplets.vartype = Vartype::SPIN;
+      } else if ( domain == "boolean" ) {
+        triplets.vartype = Vartype::BINARY;
+      } else {
+        throw std::runtime_error( "unknown variable_domain in the bqpjson file: " + domain );
+      }
+      const double scale = input.value( "scale", 1.0 );
+      triplets.offset = static_cast<FloatType>( scale * input.value( "offset", 0.0 ) );
+
+      const auto &variable_ids = input[ "variable_ids" ];
+      const auto &linear_terms = input[ "linear_terms" ];
+      const auto &quadratic_terms = input[ "quadratic_terms" ];
+      const size_t num_entries = variable_ids.size() + linear_terms.size() + quadratic_terms.size();
+      triplets.row.reserve( num_entries );
+      triplets.col.reserve( num_entries );
+      triplets.bias.reserve( num_entries );
+
+      std::unordered_set<IndexType> ids;
+      ids.reserve( variable_ids.size() );
+      for ( const auto &it : variable_ids ) {
+        const IndexType id = it.get<IndexType>();
+        ids.insert( id );
+        triplets.row.push_back( id );
+        triplets.col.push_back( id );
+        triplets.bias.push_back( 0 );
+      }
+      auto check_id = [ &ids ]( IndexType id ) {
+        if ( ids.count( id ) == 0 ) {
+          throw std::runtime_error( "a term refers to an id not in variable_ids of the bqpjson file." );
+        }
+        return id;
+      };
+      for ( const auto &it : linear_terms ) {
+        const IndexType id = check_id( it.at( "id" ).get<IndexType>() );
+        triplets.row.push_back( id );
+        triplets.col.push_back( id );
+        triplets.bias.push_back( static_cast<FloatType>( scale * it.at( "coeff" ).get<double>() ) );
+      }
+      for ( const auto &it : quadratic_terms ) {
+        const IndexType tail = check_id( it.at( "id_tail" ).get<IndexType>() );
+        const IndexType head = check_id( it.at( "id_head" ).get<IndexType>() );
+        if ( tail == head ) {
+          throw std::runtime_error( "a quadratic term of the bqpjson file has the same id_tail and id_head." );
+        }
+        triplets.row.push_back( tail );
+        triplets.col.push_back( head );
+        triplets.bias.push_back( static_cast<FloatType>( scale * it.at( "coeff" ).get<double>() ) );
+      }
+      return triplets;
+    }
+
+    /**
+     * @brief Write a binary quadratic model in the bqpjson format (version 1.0.0, scale 1).
+     * The document is written as a stream without building it in memory.
+     *
+     * @tparam BQM binary quadratic model with integer labels
+     * @param path
+     * @param bqm
+     */
+    template<typename BQM>
+    void write_bqpjson( const std::string &path, const BQM &bqm ) {
+      const auto &variables = bqm.get_variables();
+      const auto &linear = bqm.get_linear();
+      const auto &quadratic = bqm.get_quadratic();
+      static_assert(
+          std::is_integral_v<typename std::decay_t<decltype( variables )>::value_type>,
+          "the bqpjson format requires integer labels." );
+
+      // JSON has no literal for nan or inf, so such a model is rejected before the file is touched
+      if ( !std::isfinite( bqm.get_offset() ) ) {
+        throw std::runtime_error( "the bqpjson format requires a finite offset." );
+      }
+      for ( const auto &v : variables ) {
+        if ( !std::isfinite( text_detail::linear_bias( linear, v ) ) ) {
+          throw std::runtime_error( "the bqpjson format requires finite biases." );
+        }
+      }
+      for ( const auto &it : quadratic ) {
+        if ( !std::isfinite( it.second ) ) {
+          throw std::runtime_error( "the bqpjson format requires finite biases." );
+        }
+      }
+
+      text_detail::TextWriter writer( path );
+      writer << "{\"version\": \"1.0.0\", \"id\": 0, \"metadata\": {}, \"variable_domain\": \""
+             << ( bqm.get_vartype() == Vartype::SPIN ? "spin" : "boolean" ) << "\", \"scale\": 1.0, \"offset\": "
+             << bqm.get_offset() << ",\n\"variable_ids\": [";
+      const char *separator = "";
+      for ( const auto &v : variables ) {
+        writer << separator << v;
+        separator = ", ";
+      }
+      writer << "],\n\"linear_terms\": [";
+      separator = "\n";
+      for ( const auto &v : variables ) {
+        const auto bias = text_detail::linear_bias( linear, v );
+        if ( bias != 0 ) {
+          writer << separator << "{\"id\": " << v << ", \"coeff\": " << bias << '}';
+          separator = ",\n";
+        }
+      }
+      writer << "],\n\"quadratic_terms\": [";
+      separator = "\n";
+      for ( const auto &it : quadratic ) {
+        writer << separator << "{\"id_tail\": " << std::min( it.first.first, it.first.second )
+               << ", \"id_head\": " << std::max( it.first.first, it.first.second ) << ", \"coeff\": " << it.second << '}';
+        separator = ",\n";
+      }
+      writer << "]}\n";
+      writer.close();
+    }
+  } // namespace io
+} // namespace cimod
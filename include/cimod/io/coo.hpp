@@ -0,0 +1,283 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "cimod/io/text.hpp"
+
+namespace cimod {
+  namespace io {
+
+    namespace text_detail {
+
+      /**
+       * @brief header fields of a COO file
+       */
+      template<typename FloatType>
+      struct CooHeader {
+        Vartype vartype = Vartype::NONE;
+        bool has_offset = false;
+        FloatType offset = 0;
+
+        /**
+         * @brief parse a comment line (`# vartype=SPIN`, `# offset=1.5`)
+         */
+        void parse( const char *p, const char *end ) {
+          std::string_view line( p, end - p );
+          std::string_view value;
+          if ( find_field( line, "vartype", value ) ) {
+            vartype = parse_vartype( value );
+          }
+          if ( find_field( line, "offset", value ) ) {
+            const char *q = value.data();
+            if ( !parse_number( q, value.data() + value.size(), offset ) ) {
+              throw std::runtime_error( "invalid offset in the coo file: " + std::string( line ) );
+            }
+            has_offset = true;
+          }
+        }
+
+        void merge( const CooHeader &other ) {
+          if ( other.vartype != Vartype::NONE ) {
+            vartype = other.vartype;
+          }
+          if ( other.has_offset ) {
+            has_offset = true;
+            offset = other.offset;
+          }
+        }
+
+        /**
+         * @brief resolve the vartype of the file and the vartype requested by the caller
+         */
+        Vartype resolve( Vartype requested ) const {
+          if ( requested == Vartype::NONE ) {
+            if ( vartype == Vartype::NONE ) {
+              throw std::runtime_error( "the vartype is given neither by the argument nor by the header of the coo file." );
+            }
+            return vartype;
+          }
+          if ( vartype != Vartype::NONE && vartype != requested ) {
+            throw std::runtime_error( "the vartype does not match the header of the coo file." );
+          }
+          return requested;
+        }
+      };
+    } // namespace text_detail
+
+    /**
+     * @brief Read a binary quadratic model in the COO text format.
+     *
+     * Each line is a triplet `i j bias`; diagonal entries are linear biases. Lines starting with `#` are comments, where
+     * `# vartype=SPIN` (or BINARY) gives the vartype and `# offset=<value>` the offset.
+     *
+     * @tparam IndexType integer label type
+     * @tparam FloatType
+     * @param path
+     * @param vartype vartype of the model. Vartype::NONE takes it from the header.
+     * @param options
+     *
+     * @return triplets
+     */
+    template<typename IndexType = int64_t, typename FloatType = double>
+    QuadraticTriplets<IndexType, FloatType> read_coo(
+        const std::string &path,
+        Vartype vartype = Vartype::NONE,
+        const TextReadOptions &options = TextReadOptions() ) {
+      static_assert( std::is_integral_v<IndexType>, "the coo format requires integer labels." );
+
+      struct Local {
+        QuadraticTriplets<IndexType, FloatType> triplets;
+        text_detail::CooHeader<FloatType> header;
+      };
+
+      Local result;
+      auto parse_line = []( const char *p, const char *end, Local &local ) {
+        p = text_detail::skip_space( p, end );
+        if ( p == end ) {
+          return;
+        }
+        if ( *p == '#' ) {
+          local.header.parse( p, end );
+          return;
+        }
+        const char *line = p;
+        IndexType i, j;
+        FloatType bias;
+        if ( !text_detail::parse_number( p, end, i ) || !text_detail::parse_number( p, end, j )
+             || !text_detail::parse_number( p, end, bias ) || !text_detail::at_end( p, end ) ) {
+          throw std::runtime_error( "invalid line in the coo file: " + std::string( line, end ) );
+        }
+        local.triplets.row.push_back( i );
+        local.triplets.col.push_back( j );
+        local.triplets.bias.push_back( bias );
+      };
+      auto merge = [ &result ]( Local &local ) {
+        text_detail::append_triplets( result.triplets, local.triplets );
+        result.header.merge( local.header );
+      };
+      text_detail::read_lines<Local>( path, options, parse_line, merge );
+
+      result.triplets.vartype = result.header.resolve( vartype );
+      result.triplets.offset = result.header.offset;
+      return std::move( result.triplets );
+    }
+
+    /**
+     * @brief Write a binary quadratic model in the COO text format.
+     * Linear biases are written as diagonal entries, followed by the quadratic biases; the vartype and the offset are
+     * written in the header.
+     *
+     * @tparam BQM binary quadratic model with integer labels
+     * @param path
+     * @param bqm
+     */
+    template<typename BQM>
+    void write_coo( const std::string &path, const BQM &bqm ) {
+      const auto &variables = bqm.get_variables();
+      const auto &linear = bqm.get_linear();
+      const auto &quadratic = bqm.get_quadratic();
+      static_assert(
+          std::is_integral_v<typename std::decay_t<decltype( variables )>::value_type>,
+          "the coo format requires integer labels." );
+
+      text_detail::TextWriter writer( path );
+      writer << "# vartype=" << text_detail::vartype_name( bqm.get_vartype() ) << '\n';
+      writer << "# offset=" << bqm.get_offset() << '\n';
+      for ( const auto &v : variables ) {
+        writer << v << ' ' << v << ' ' << text_detail::linear_bias( linear, v ) << '\n';
+      }
+      for ( const auto &it : quadratic ) {
+        writer << it.first.first << ' ' << it.first.second << ' ' << it.second << '\n';
+      }
+      writer.close();
+    }
+
+    /**
+     * @brief Read a binary polynomial model in the COO text format.
+     *
+     * Each line is a term `i j ... k bias` with any number of indices; a line with the bias only is the constant term.
+     * Comments are the same as read_coo.
+     *
+     * @tparam IndexType integer label type
+     * @tparam FloatType
+     * @param path
+     * @param vartype vartype of the model. Vartype::NONE takes it from the header.
+     * @param options
+     *
+     * @return terms
+     */
+    template<typename IndexType = int64_t, typename FloatType = double>
+    PolynomialTerms<IndexType, FloatType> read_coo_polynomial(
+        const std::string &path,
+        Vartype vartype = Vartype::NONE,
+        const TextReadOptions &options = TextReadOptions() ) {
+      static_assert( std::is_integral_v<IndexType>, "the coo format requires integer labels." );
+
+      struct Local {
+        PolynomialTerms<IndexType, FloatType> terms;
+        text_detail::CooHeader<FloatType> header;
+      };
+
+      Local result;
+      auto parse_line = []( const char *p, const char *end, Local &local ) {
+        p = text_detail::skip_space( p, end );
+        if ( p == end ) {
+          return;
+        }
+        if ( *p == '#' ) {
+          local.header.parse( p, end );
+          return;
+        }
+        // all the tokens but the last are indices
+        const char *line = p;
+        const char *last = end;
+        while ( last != p && text_detail::is_space( *( last - 1 ) ) ) {
+          last--;
+        }
+        while ( last != p && !text_detail::is_space( *( last - 1 ) ) ) {
+          last--;
+        }
+        std::vector<IndexType> key;
+        IndexType index;
+        while ( text_detail::skip_space( p, last ) != last ) {
+          if ( !text_detail::parse_number( p, last, index ) ) {
+            throw std::runtime_error( "invalid line in the coo file: " + std::string( line, end ) );
+          }
+          key.push_back( index );
+        }
+        FloatType value;
+        p = last;
+        if ( !text_detail::parse_number( p, end, value ) || !text_detail::at_end( p, end ) ) {
+          throw std::runtime_error( "invalid line in the coo file: " + std::string( line, end ) );
+        }
+        local.terms.key_list.push_back( std::move( key ) );
+        local.terms.value_list.push_back( value );
+      };
+      auto merge = [ &result ]( Local &local ) {
+        auto &keys = result.terms.key_list;
+        auto &values = result.terms.value_list;
+        keys.insert(
+            keys.end(),
+            std::make_move_iterator( local.terms.key_list.begin() ),
+            std::make_move_iterator( local.terms.key_list.end() ) );
+        values.insert( values.end(), local.terms.value_list.begin(), local.terms.value_list.end() );
+        local.terms = PolynomialTerms<IndexType, FloatType>();
+        result.header.merge( local.header );
+      };
+      text_detail::read_lines<Local>( path, options, parse_line, merge );
+
+      if ( result.header.has_offset ) {
+        result.terms.key_list.emplace_back();
+        result.terms.value_list.push_back( result.header.offset );
+      }
+      result.terms.vartype = result.header.resolve( vartype );
+      return std::move( result.terms );
+    }
+
+    /**
+     * @brief Write a binary polynomial model in the COO text format.
+     *
+     * @tparam IndexType integer label type
+     * @tparam FloatType
+     * @param path
+     * @param bpm
+     */
+    template<typename IndexType, typename FloatType>
+    void write_coo( const std::string &path, const BinaryPolynomialModel<IndexType, FloatType> &bpm ) {
+      static_assert( std::is_integral_v<IndexType>, "the coo format requires integer labels." );
+
+      const auto &key_list = bpm.GetKeyList();
+      const auto &value_list = bpm.GetValueList();
+      text_detail::TextWriter writer( path );
+      writer << "# vartype=" << text_detail::vartype_name( bpm.GetVartype() ) << '\n';
+      for ( size_t k = 0; k < key_list.size(); k++ ) {
+        for ( const auto &index : key_list[ k ] ) {
+          writer << index << ' ';
+        }
+        writer << value_list[ k ] << '\n';
+      }
+      writer.close();
+    }
+  } // namespace io
+} // namespace cimod
@@ -0,0 +1,186 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "cimod/io/text.hpp"
+
+namespace cimod {
+  namespace io {
+
+    /**
+     * @brief Read a QUBO in the qbsolv format.
+     *
+     * The file consists of comment lines (`c ...`), one program line `p qubo <topology> <maxNodes> <nNodes>
+     * <nCouplers>`, nNodes diagonal entries `i i bias` and nCouplers couplers `i j bias`. The number of entries and
+     * the range of the indices are checked against the program line. A comment `c offset = <value>` (written by
+     * write_qubo) sets the offset.
+     *
+     * @tparam IndexType integer label type
+     * @tparam FloatType
+     * @param path
+     * @param options
+     *
+     * @return triplets of a BINARY model
+     */
+    template<typename IndexType = int64_t, typename FloatType = double>
+    QuadraticTriplets<IndexType, FloatType> read_qubo(
+        const std::string &path,
+        const TextReadOptions &options = TextReadOptions() ) {
+      static_assert( std::is_integral_v<IndexType>, "the qbsolv format requires integer labels." );
+
+      struct Local {
+        QuadraticTriplets<IndexType, FloatType> triplets;
+        size_t num_programs = 0;
+        uint64_t max_nodes = 0;
+        uint64_t num_nodes = 0;
+        uint64_t num_couplers = 0;
+        uint64_t num_read_nodes = 0;
+        bool has_offset = false;
+        FloatType offset = 0;
+      };
+
+      Local result;
+      auto parse_line = []( const char *p, const char *end, Local &local ) {
+        p = text_detail::skip_space( p, end );
+        if ( p == end ) {
+          return;
+        }
+        if ( *p == 'c' ) {
+          std::string_view value;
+          if ( text_detail::find_field( std::string_view( p, end - p ), "offset", value ) ) {
+            const char *q = value.data();
+            if ( !text_detail::parse_number( q, value.data() + value.size(), local.offset ) ) {
+              throw std::runtime_error( "invalid offset in the qubo file: " + std::string( p, end ) );
+            }
+            local.has_offset = true;
+          }
+          return;
+        }
+        if ( *p == 'p' ) {
+          const char *q = text_detail::skip_space( p + 1, end );
+          std::string_view rest( q, end - q );
+          if ( rest.substr( 0, 4 ) != "qubo" ) {
+            throw std::runtime_error( "invalid program line in the qubo file: " + std::string( p, end ) );
+          }
+          q += 4;
+          q = text_detail::skip_space( q, end );
+          while ( q != end && !text_detail::is_space( *q ) ) {
+            q++;
+          }
+          if ( !text_detail::parse_number( q, end, local.max_nodes ) || !text_detail::parse_number( q, end, local.num_nodes )
+               || !text_detail::parse_number( q, end, local.num_couplers ) || !text_detail::at_end( q, end ) ) {
+            throw std::runtime_error( "invalid program line in the qubo file: " + std::string( p, end ) );
+          }
+          local.num_programs++;
+          return;
+        }
+        const char *line = p;
+        IndexType i, j;
+        FloatType bias;
+        if ( !text_detail::parse_number( p, end, i ) || !text_detail::parse_number( p, end, j )
+             || !text_detail::parse_number( p, end, bias ) || !text_detail::at_end( p, end ) ) {
+          throw std::runtime_error( "invalid line in the qubo file: " + std::string( line, end ) );
+        }
+        if constexpr ( std::is_signed_v<IndexType> ) {
+          if ( i < 0 || j < 0 ) {
+            throw std::runtime_error( "negative index in the qubo file: " + std::string( line, end ) );
+          }
+        }
+        local.triplets.row.push_back( i );
+        local.triplets.col.push_back( j );
+        local.triplets.bias.push_back( bias );
+        if ( i == j ) {
+          local.num_read_nodes++;
+        }
+      };
+      auto merge = [ &result ]( Local &local ) {
+        text_detail::append_triplets( result.triplets, local.triplets );
+        if ( local.num_programs != 0 ) {
+          result.max_nodes = local.max_nodes;
+          result.num_nodes = local.num_nodes;
+          result.num_couplers = local.num_couplers;
+        }
+        result.num_programs += local.num_programs;
+        result.num_read_nodes += local.num_read_nodes;
+        if ( local.has_offset ) {
+          result.has_offset = true;
+          result.offset = local.offset;
+        }
+      };
+      text_detail::read_lines<Local>( path, options, parse_line, merge );
+
+      if ( result.num_programs != 1 ) {
+        throw std::runtime_error( "the qubo file must contain exactly one program line." );
+      }
+      const uint64_t num_entries = result.triplets.bias.size();
+      if ( result.num_read_nodes != result.num_nodes || num_entries - result.num_read_nodes != result.num_couplers ) {
+        throw std::runtime_error( "the number of entries does not match the program line of the qubo file." );
+      }
+      for ( size_t k = 0; k < num_entries; k++ ) {
+        if ( static_cast<uint64_t>( std::max( result.triplets.row[ k ], result.triplets.col[ k ] ) ) >= result.max_nodes ) {
+          throw std::runtime_error( "an index exceeds maxNodes of the qubo file." );
+        }
+      }
+      result.triplets.offset = result.offset;
+      result.triplets.vartype = Vartype::BINARY;
+      return std::move( result.triplets );
+    }
+
+    /**
+     * @brief Write a binary quadratic model in the qbsolv format.
+     * SPIN models are converted into the QUBO form. The offset is written as a comment `c offset = <value>`.
+     *
+     * @tparam BQM binary quadratic model with non-negative integer labels
+     * @param path
+     * @param bqm
+     */
+    template<typename BQM>
+    void write_qubo( const std::string &path, const BQM &bqm ) {
+      using FloatType = std::decay_t<decltype( bqm.get_offset() )>;
+      const auto &variables = bqm.get_variables();
+      const auto &linear = bqm.get_linear();
+      const auto &quadratic = bqm.get_quadratic();
+      static_assert(
+          std::is_integral_v<typename std::decay_t<decltype( variables )>::value_type>,
+          "the qbsolv format requires integer labels." );
+
+      uint64_t max_nodes = 0;
+      for ( const auto &v : variables ) {
+        if constexpr ( std::is_signed_v<std::decay_t<decltype( v )>> ) {
+          if ( v < 0 ) {
+            throw std::runtime_error( "the qbsolv format requires non-negative labels." );
+          }
+        }
+        max_nodes = std::max<uint64_t>( max_nodes, static_cast<uint64_t>( v ) + 1 );
+      }
+
+      text_detail::TextWriter writer( path );
+      writer << "p qubo 0 " << max_nodes << ' ' << variables.size() << ' ' << quadratic.size() << '\n';
+      auto write_term = [ &writer ]( auto i, auto j, auto bias ) {
+        writer << std::min( i, j ) << ' ' << std::max( i, j ) << ' ' << static_cast<FloatType>( bias ) << '\n';
+      };
+      const double offset = text_detail::for_each_qubo_term( bqm, linear, quadratic, write_term );
+      writer << "c offset = " << static_cast<FloatType>( offset ) << '\n';
+      writer.close();
+    }
+  } // namespace io
+} // namespace cimod
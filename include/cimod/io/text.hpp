@@ -0,0 +1,444 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cimod/binary_polynomial_model.hpp"
+#include "cimod/binary_quadratic_model.hpp"
+#include "cimod/binary_quadratic_model_dict.hpp"
+#include "cimod/binary_quadratic_model_packed.hpp"
+#include "cimod/vartypes.hpp"
+
+// floating-point std::from_chars / std::to_chars are missing in older libc++ (e.g. AppleClang for older macOS targets)
+#ifndef CIMOD_FLOAT_CHARCONV
+#if defined( __cpp_lib_to_chars )
+#define CIMOD_FLOAT_CHARCONV 1
+#else
+#define CIMOD_FLOAT_CHARCONV 0
+#endif
+#endif
+
+namespace cimod {
+  namespace io {
+
+    /**
+     * @brief Options of the text readers
+     */
+    struct TextReadOptions {
+      /**
+       * @brief number of bytes read from the file at once. a chunk is split at line boundaries and parsed in parallel.
+       */
+      size_t chunk_size = size_t( 64 ) << 20;
+    };
+
+    /**
+     * @brief Binary quadratic model read from a text file as COO triplets.
+     * Diagonal elements (row[k] == col[k]) are linear biases and duplicated elements are summed up when a model is
+     * built.
+     *
+     * @tparam IndexType
+     * @tparam FloatType
+     */
+    template<typename IndexType, typename FloatType>
+    struct QuadraticTriplets {
+      std::vector<IndexType> row;
+      std::vector<IndexType> col;
+      std::vector<FloatType> bias;
+      FloatType offset = 0;
+      Vartype vartype = Vartype::NONE;
+
+      /**
+       * @brief Build a binary quadratic model from the triplets.
+       *
+       * @tparam DataType
+       *
+       * @return Binary quadratic model
+       */
+      template<typename DataType>
+      BinaryQuadraticModel<IndexType, FloatType, DataType> to_bqm() const {
+        if constexpr ( std::is_same_v<DataType, Dict> ) {
+          Linear<IndexType, FloatType> linear;
+          Quadratic<IndexType, FloatType> quadratic;
+          for ( size_t k = 0; k < bias.size(); k++ ) {
+            if ( row[ k ] == col[ k ] ) {
+              linear[ row[ k ] ] += bias[ k ];
+            } else {
+              linear.emplace( row[ k ], 0 );
+              linear.emplace( col[ k ], 0 );
+              quadratic[ std::make_pair( std::min( row[ k ], col[ k ] ), std::max( row[ k ], col[ k ] ) ) ] += bias[ k ];
+            }
+          }
+          return BinaryQuadraticModel<IndexType, FloatType, DataType>( linear, quadratic, offset, vartype );
+        } else {
+          return BinaryQuadraticModel<IndexType, FloatType, DataType>::from_coo( row, col, bias, offset, vartype );
+        }
+      }
+    };
+
+    /**
+     * @brief Binary polynomial model read from a text file as a list of terms.
+     * The empty key is the constant term.
+     *
+     * @tparam IndexType
+     * @tparam FloatType
+     */
+    template<typename IndexType, typename FloatType>
+    struct PolynomialTerms {
+      PolynomialKeyList<IndexType> key_list;
+      PolynomialValueList<FloatType> value_list;
+      Vartype vartype = Vartype::NONE;
+
+      /**
+       * @brief Build a binary polynomial model from the terms.
+       *
+       * @return Binary polynomial model
+       */
+      BinaryPolynomialModel<IndexType, FloatType> to_bpm() const {
+        return BinaryPolynomialModel<IndexType, FloatType>( key_list, value_list, vartype );
+      }
+    };
+
+    namespace text_detail {
+
+      inline bool is_space( char c ) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+      }
+
+      inline const char *skip_space( const char *p, const char *end ) {
+        while ( p != end && is_space( *p ) ) {
+          p++;
+        }
+        return p;
+      }
+
+      /**
+       * @brief parse a number after optional spaces and advance p. a leading '+' is accepted.
+       *
+       * @return false if no number is found or the number is not followed by a space or the end of the line
+       */
+      template<typename T>
+      bool parse_number( const char *&p, const char *end, T &value ) {
+        p = skip_space( p, end );
+        if ( p != end && *p == '+' ) {
+          p++;
+        }
+        const char *ptr = p;
+        if constexpr ( std::is_integral_v<T> || CIMOD_FLOAT_CHARCONV ) {
+          auto result = std::from_chars( p, end, value );
+          if ( result.ec != std::errc() ) {
+            return false;
+          }
+          ptr = result.ptr;
+        } else {
+          // strtod needs a null-terminated string, so the token is copied; it uses the "C" numeric locale unless the
+          // program changes LC_NUMERIC
+          char token[ 64 ];
+          size_t size = 0;
+          while ( p + size != end && !is_space( p[ size ] ) && size + 1 < sizeof( token ) ) {
+            token[ size ] = p[ size ];
+            size++;
+          }
+          token[ size ] = '\0';
+          char *token_end = nullptr;
+          errno = 0;
+          if constexpr ( std::is_same_v<T, float> ) {
+            value = std::strtof( token, &token_end );
+          } else if constexpr ( std::is_same_v<T, double> ) {
+            value = std::strtod( token, &token_end );
+          } else {
+            value = static_cast<T>( std::strtold( token, &token_end ) );
+          }
+          if ( token_end == token || errno == ERANGE ) {
+            return false;
+          }
+          ptr = p + ( token_end - token );
+        }
+        if ( ptr != end && !is_space( *ptr ) ) {
+          return false;
+        }
+        p = ptr;
+        return true;
+      }
+
+      /**
+       * @brief return true if only spaces are left in the line
+       */
+      inline bool at_end( const char *p, const char *end ) {
+        return skip_space( p, end ) == end;
+      }
+
+      /**
+       * @brief find the value of `key=value` or `key: value` in a comment line
+       */
+      inline bool find_field( std::string_view line, std::string_view key, std::string_view &value ) {
+        size_t pos = line.find( key );
+        if ( pos == std::string_view::npos ) {
+          return false;
+        }
+        const char *p = line.data() + pos + key.size();
+        const char *end = line.data() + line.size();
+        p = skip_space( p, end );
+        if ( p == end || ( *p != '=' && *p != ':' ) ) {
+          return false;
+        }
+        p = skip_space( p + 1, end );
+        const char *q = p;
+        while ( q != end && !is_space( *q ) ) {
+          q++;
+        }
+        value = std::string_view( p, q - p );
+        return true;
+      }
+
+      inline Vartype parse_vartype( std::string_view value ) {
+        if ( value == "SPIN" || value == "spin" ) {
+          return Vartype::SPIN;
+        } else if ( value == "BINARY" || value == "binary" || value == "boolean" ) {
+          return Vartype::BINARY;
+        }
+        throw std::runtime_error( "unknown vartype: " + std::string( value ) );
+      }
+
+      inline const char *vartype_name( Vartype vartype ) {
+        if ( vartype == Vartype::SPIN ) {
+          return "SPIN";
+        } else if ( vartype == Vartype::BINARY ) {
+          return "BINARY";
+        }
+        throw std::runtime_error( "Unknown vartype detected" );
+      }
+
+      /**
+       * @brief parse the lines of [begin, end) in parallel.
+       * the block is split into pieces at line boundaries; parse_line( line_begin, line_end, local ) is called for
+       * each line of a piece with a Local object of the piece, and merge( local ) is called for the pieces in order.
+       */
+      template<typename Local, typename ParseLine, typename Merge>
+      void parse_block( const char *begin, const char *end, ParseLine &parse_line, Merge &merge ) {
+        const size_t size = end - begin;
+        const size_t num_pieces = std::max<size_t>( 1, std::min<size_t>( std::thread::hardware_concurrency(), size >> 16 ) );
+        std::vector<const char *> bounds( num_pieces + 1, end );
+        bounds[ 0 ] = begin;
+        for ( size_t t = 1; t < num_pieces; t++ ) {
+          const char *p = std::max( begin + size * t / num_pieces, bounds[ t - 1 ] );
+          p = std::find( p, end, '\n' );
+          bounds[ t ] = ( p == end ) ? end : p + 1;
+        }
+
+        std::vector<Local> locals( num_pieces );
+        std::vector<std::string> errors( num_pieces );
+#pragma omp parallel for schedule( dynamic, 1 )
+        for ( int64_t t = 0; t < ( int64_t )num_pieces; t++ ) {
+          const char *p = bounds[ t ];
+          try {
+            while ( p < bounds[ t + 1 ] ) {
+              const char *q = std::find( p, bounds[ t + 1 ], '\n' );
+              parse_line( p, q, locals[ t ] );
+              p = q + 1;
+            }
+          } catch ( const std::exception &e ) {
+            errors[ t ] = e.what();
+          }
+        }
+
+        for ( size_t t = 0; t < num_pieces; t++ ) {
+          if ( !errors[ t ].empty() ) {
+            throw std::runtime_error( errors[ t ] );
+          }
+        }
+        for ( auto &local : locals ) {
+          merge( local );
+        }
+      }
+
+      /**
+       * @brief read a text file chunk by chunk and parse its lines in parallel (see parse_block).
+       * only one chunk (and the incomplete line at its end) is held in memory at a time.
+       */
+      template<typename Local, typename ParseLine, typename Merge>
+      void read_lines( const std::string &path, const TextReadOptions &options, ParseLine parse_line, Merge merge ) {
+        std::ifstream ifs( path, std::ios::binary );
+        if ( !ifs ) {
+          throw std::runtime_error( "failed to open the file: " + path );
+        }
+        const size_t chunk_size = std::max<size_t>( options.chunk_size, 1 );
+        std::vector<char> buffer;
+        size_t carry = 0;
+        while ( true ) {
+          buffer.resize( carry + chunk_size );
+          ifs.read( buffer.data() + carry, chunk_size );
+          const size_t size = carry + static_cast<size_t>( ifs.gcount() );
+          const bool eof = !ifs;
+          if ( ifs.bad() ) {
+            throw std::runtime_error( "failed to read the file: " + path );
+          }
+
+          size_t parsed = size;
+          if ( !eof ) {
+            auto rit = std::find( buffer.rbegin() + ( buffer.size() - size ), buffer.rend(), '\n' );
+            parsed = buffer.rend() - rit;
+          }
+          parse_block<Local>( buffer.data(), buffer.data() + parsed, parse_line, merge );
+          if ( eof ) {
+            break;
+          }
+          // move the incomplete line to the front; a chunk without a newline grows the buffer
+          std::copy( buffer.begin() + parsed, buffer.begin() + size, buffer.begin() );
+          carry = size - parsed;
+        }
+      }
+
+      /**
+       * @brief merge the triplets of a piece
+       */
+      template<typename IndexType, typename FloatType>
+      void append_triplets( QuadraticTriplets<IndexType, FloatType> &dst, QuadraticTriplets<IndexType, FloatType> &src ) {
+        dst.row.insert( dst.row.end(), src.row.begin(), src.row.end() );
+        dst.col.insert( dst.col.end(), src.col.begin(), src.col.end() );
+        dst.bias.insert( dst.bias.end(), src.bias.begin(), src.bias.end() );
+        src = QuadraticTriplets<IndexType, FloatType>();
+      }
+
+      /**
+       * @brief Buffered writer of text files
+       */
+      class TextWriter {
+      private:
+        std::ofstream m_ofs;
+        std::string m_buffer;
+        std::string m_path;
+        static constexpr size_t buffer_size = size_t( 1 ) << 20;
+
+      public:
+        explicit TextWriter( const std::string &path ) : m_ofs( path, std::ios::binary ), m_path( path ) {
+          if ( !m_ofs ) {
+            throw std::runtime_error( "failed to open the file: " + path );
+          }
+          m_buffer.reserve( buffer_size + 64 );
+        }
+
+        TextWriter &operator<<( std::string_view str ) {
+          m_buffer.append( str );
+          if ( m_buffer.size() >= buffer_size ) {
+            flush();
+          }
+          return *this;
+        }
+
+        TextWriter &operator<<( char c ) {
+          return *this << std::string_view( &c, 1 );
+        }
+
+        /**
+         * @brief write a number in the shortest representation that reads back to the same value
+         */
+        template<typename T, std::enable_if_t<std::is_arithmetic_v<T>, std::nullptr_t> = nullptr>
+        TextWriter &operator<<( T value ) {
+          char str[ 64 ];
+          if constexpr ( std::is_integral_v<T> || CIMOD_FLOAT_CHARCONV ) {
+            auto result = std::to_chars( str, str + sizeof( str ), value );
+            return *this << std::string_view( str, result.ptr - str );
+          } else {
+            // enough digits to read back to the same value, though not always the shortest representation
+            int size;
+            if constexpr ( std::is_same_v<T, float> ) {
+              size = std::snprintf( str, sizeof( str ), "%.9g", static_cast<double>( value ) );
+            } else if constexpr ( std::is_same_v<T, double> ) {
+              size = std::snprintf( str, sizeof( str ), "%.17g", value );
+            } else {
+              size = std::snprintf( str, sizeof( str ), "%.21Lg", static_cast<long double>( value ) );
+            }
+            return *this << std::string_view( str, size );
+          }
+        }
+
+        void flush() {
+          m_ofs.write( m_buffer.data(), m_buffer.size() );
+          m_buffer.clear();
+        }
+
+        void close() {
+          flush();
+          m_ofs.close();
+          if ( !m_ofs ) {
+            throw std::runtime_error( "failed to write the file: " + m_path );
+          }
+        }
+      };
+
+      /**
+       * @brief get a linear bias; get_linear() of Dense and Sparse models omits zero biases
+       */
+      template<typename LinearType>
+      typename LinearType::mapped_type linear_bias( const LinearType &linear, const typename LinearType::key_type &v ) {
+        auto it = linear.find( v );
+        return ( it == linear.end() ) ? 0 : it->second;
+      }
+
+      /**
+       * @brief call f( i, j, bias ) for the linear ( i == j ) and quadratic biases of a binary quadratic model in the
+       * QUBO form, and return the offset of the QUBO form. SPIN models are converted on the fly.
+       */
+      template<typename BQM, typename LinearType, typename QuadraticType, typename F>
+      double for_each_qubo_term( const BQM &bqm, const LinearType &linear, const QuadraticType &quadratic, F &&f ) {
+        using IndexType = typename LinearType::key_type;
+        double offset = bqm.get_offset();
+        if ( bqm.get_vartype() == Vartype::BINARY ) {
+          for ( const auto &v : bqm.get_variables() ) {
+            f( v, v, linear_bias( linear, v ) );
+          }
+          for ( const auto &it : quadratic ) {
+            f( it.first.first, it.first.second, it.second );
+          }
+        } else if ( bqm.get_vartype() == Vartype::SPIN ) {
+          std::unordered_map<IndexType, double> sums;
+          for ( const auto &it : quadratic ) {
+            sums[ it.first.first ] += it.second;
+            sums[ it.first.second ] += it.second;
+          }
+          for ( const auto &v : bqm.get_variables() ) {
+            const double h = linear_bias( linear, v );
+            const double sum = ( sums.count( v ) != 0 ) ? sums.at( v ) : 0;
+            offset += 0.5 * sum - h;
+            f( v, v, 2 * h - 2 * sum );
+          }
+          for ( const auto &it : quadratic ) {
+            f( it.first.first, it.first.second, 4 * static_cast<double>( it.second ) );
+          }
+        } else {
+          throw std::runtime_error( "Unknown vartype detected" );
+        }
+        return offset;
+      }
+    } // namespace text_detail
+  } // namespace io
+} // namespace cimod
@@ -0,0 +1,152 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "cimod/hash.hpp"
+
+namespace cimod {
+
+  /**
+   * @brief Type alias for the dense integer id of an interned label
+   */
+  using LabelId = uint32_t;
+
+  /**
+   * @brief Class for interning labels to dense integer ids.
+   *
+   * Each label is hashed once when it is interned and gets the next id, starting from zero. Ids are never reassigned,
+   * so a table can be shared between models built on the same set of variables and hot loops can work on the ids
+   * without hashing labels such as strings or tuples.
+   *
+   * @tparam IndexType label type. type must be hashable.
+   */
+  template<typename IndexType>
+  class LabelTable {
+  protected:
+    /**
+     * @brief labels in the order of their ids
+     */
+    std::vector<IndexType> m_labels;
+
+    /**
+     * @brief dict for converting label to id
+     */
+    std::unordered_map<IndexType, LabelId> m_label_to_id;
+
+  public:
+    /**
+     * @brief LabelTable constructor.
+     */
+    LabelTable() = default;
+
+    /**
+     * @brief LabelTable constructor.
+     *
+     * @param labels labels interned in this order. duplicated labels are interned once.
+     */
+    explicit LabelTable( const std::vector<IndexType> &labels ) {
+      reserve( labels.size() );
+      for ( const auto &it : labels ) {
+        intern( it );
+      }
+    }
+
+    /**
+     * @brief reserve memory for `size` labels
+     *
+     * @param size
+     */
+    void reserve( size_t size ) {
+      m_labels.reserve( size );
+      m_label_to_id.reserve( size );
+    }
+
+    /**
+     * @brief Intern a label
+     *
+     * @param label
+     *
+     * @return id of the label. a new id is assigned if the label is not interned yet.
+     */
+    LabelId intern( const IndexType &label ) {
+      auto it = m_label_to_id.find( label );
+      if ( it != m_label_to_id.end() ) {
+        return it->second;
+      }
+      if ( m_labels.size() >= std::numeric_limits<LabelId>::max() ) {
+        throw std::length_error( "the number of labels exceeds the range of LabelId" );
+      }
+      LabelId id = static_cast<LabelId>( m_labels.size() );
+      m_labels.push_back( label );
+      m_label_to_id.emplace( label, id );
+      return id;
+    }
+
+    /**
+     * @brief Get the id of an interned label
+     *
+     * @param label
+     *
+     * @return id
+     */
+    LabelId id( const IndexType &label ) const {
+      return m_label_to_id.at( label );
+    }
+
+    /**
+     * @brief Get the label of an id
+     *
+     * @param id
+     *
+     * @return label
+     */
+    const IndexType &label( LabelId id ) const {
+      return m_labels.at( id );
+    }
+
+    /**
+     * @brief Return true if the label is interned
+     *
+     * @param label
+     */
+    bool contains( const IndexType &label ) const {
+      return m_label_to_id.find( label ) != m_label_to_id.end();
+    }
+
+    /**
+     * @brief Get labels
+     *
+     * @return labels in the order of their ids
+     */
+    const std::vector<IndexType> &labels() const {
+      return m_labels;
+    }
+
+    /**
+     * @brief Get the number of interned labels
+     *
+     * @return size
+     */
+    size_t size() const {
+      return m_labels.size();
+    }
+  };
+} // namespace cimod
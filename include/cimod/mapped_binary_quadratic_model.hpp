@@ -0,0 +1,489 @@
+//    Copyright 2020-2025 Jij Inc.
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cimod/binary_format.hpp"
+#include "cimod/binary_quadratic_model.hpp"
+#include "cimod/utilities.hpp"
+#include "cimod/vartypes.hpp"
+
+namespace cimod {
+
+  /**
+   * @brief Class for a read-only binary quadratic model backed by a memory-mapped binary file in the CSR payload.
+   *
+   * The biases are not copied into the process: the row pointers, column indices and biases of the file (written by
+   * BinaryQuadraticModel<IndexType, FloatType, Sparse>::save) are used in place, so that several processes mapping the
+   * same file share one physical copy. Only the labels and their index table are held in memory. If the bias type of
+   * the file differs from FloatType, the biases are converted into private buffers.
+   *
+   * The interface follows the read-only part of the Sparse BinaryQuadraticModel.
+   *
+   * @tparam IndexType
+   * @tparam FloatType
+   */
+  template<typename IndexType, typename FloatType>
+  class MappedBinaryQuadraticModel {
+  public:
+    using AccType = AccumulateType<FloatType>;
+
+  protected:
+    /**
+     * @brief reader holding the mapping
+     */
+    std::unique_ptr<BinaryReader> m_reader;
+
+    /**
+     * @brief arrays of the CSR payload in the mapping
+     */
+    BinaryQuadraticPayload<FloatType> m_payload;
+
+    /**
+     * @brief variable labels (sorted)
+     */
+    std::vector<IndexType> m_variables;
+
+    /**
+     * @brief dict for converting label to index
+     */
+    std::unordered_map<IndexType, size_t> m_label_to_idx;
+
+    /**
+     * @brief The energy offset associated with the model.
+     */
+    FloatType m_offset;
+
+    /**
+     * @brief The model's type.
+     */
+    Vartype m_vartype;
+
+    /**
+     * @brief transposed index of the upper triangle, built on the first neighbor query.
+     * the interactions (i, j) with i < j of column j are at m_col_pos[m_col_ptr[j]:m_col_ptr[j+1]].
+     */
+    mutable std::vector<uint64_t> m_col_ptr;
+
+    /**
+     * @brief row indices of the transposed index
+     */
+    mutable std::vector<uint32_t> m_col_row;
+
+    /**
+     * @brief positions of the biases in m_payload.values of the transposed index
+     */
+    mutable std::vector<uint64_t> m_col_pos;
+
+    /**
+     * @brief flag for building the transposed index once
+     */
+    mutable std::unique_ptr<std::once_flag> m_col_flag = std::make_unique<std::once_flag>();
+
+    /**
+     * @brief build the transposed index of the upper triangle
+     */
+    void _build_columns() const {
+      const size_t N = m_variables.size();
+      m_col_ptr.assign( N + 1, 0 );
+      for ( uint64_t p = 0; p < m_payload.num_interactions; p++ ) {
+        m_col_ptr[ m_payload.col_idx[ p ] + 1 ]++;
+      }
+      for ( size_t j = 0; j < N; j++ ) {
+        m_col_ptr[ j + 1 ] += m_col_ptr[ j ];
+      }
+      m_col_row.resize( m_payload.num_interactions );
+      m_col_pos.resize( m_payload.num_interactions );
+      std::vector<uint64_t> fill( m_col_ptr.begin(), m_col_ptr.end() - 1 );
+      for ( size_t i = 0; i < N; i++ ) {
+        for ( uint64_t p = m_payload.row_ptr[ i ]; p < m_payload.row_ptr[ i + 1 ]; p++ ) {
+          uint64_t q = fill[ m_payload.col_idx[ p ] ]++;
+          m_col_row[ q ] = static_cast<uint32_t>( i );
+          m_col_pos[ q ] = p;
+        }
+      }
+    }
+
+    /**
+     * @brief energy of a state indexed by the variable indices
+     *
+     * @param s
+     *
+     * @return energy
+     */
+    FloatType _energy( const std::vector<AccType> &s ) const {
+      AccType energy = m_offset;
+      for ( size_t i = 0; i < m_variables.size(); i++ ) {
+        if ( s[ i ] == 0 ) {
+          continue;
+        }
+        AccType field = m_payload.linear[ i ];
+        for ( uint64_t p = m_payload.row_ptr[ i ]; p < m_payload.row_ptr[ i + 1 ]; p++ ) {
+          field += m_payload.values[ p ] * s[ m_payload.col_idx[ p ] ];
+        }
+        energy += s[ i ] * field;
+      }
+      return static_cast<FloatType>( energy );
+    }
+
+    /**
+     * @brief sum of the quadratic biases of each variable over both directions
+     *
+     * @return sums
+     */
+    std::vector<AccType> _quadratic_sums() const {
+      std::vector<AccType> sums( m_variables.size(), 0 );
+      for ( size_t i = 0; i < m_variables.size(); i++ ) {
+        for ( uint64_t p = m_payload.row_ptr[ i ]; p < m_payload.row_ptr[ i + 1 ]; p++ ) {
+          sums[ i ] += m_payload.values[ p ];
+          sums[ m_payload.col_idx[ p ] ] += m_payload.values[ p ];
+        }
+      }
+      return sums;
+    }
+
+  public:
+    /**
+     * @brief MappedBinaryQuadraticModel constructor.
+     *
+     * @param path binary file in the CSR payload
+     */
+    explicit MappedBinaryQuadraticModel( const std::string &path ) : m_reader( std::make_unique<BinaryReader>( path ) ) {
+      if ( m_reader->header().payload != BinaryPayload::CSR ) {
+        throw std::runtime_error( "MappedBinaryQuadraticModel requires a binary file in the CSR payload." );
+      }
+      m_variables = m_reader->read_labels<IndexType>();
+      if ( !std::is_sorted( m_variables.begin(), m_variables.end() ) ) {
+        throw std::runtime_error( "the labels of the binary file must be sorted." );
+      }
+      m_payload = m_reader->read_quadratic_payload<FloatType>();
+      m_offset = static_cast<FloatType>( m_reader->header().offset );
+      m_vartype = m_reader->header().vartype;
+
+      m_label_to_idx.reserve( m_variables.size() );
+      for ( size_t i = 0; i < m_variables.size(); i++ ) {
+        m_label_to_idx[ m_variables[ i ] ] = i;
+      }
+      if ( m_label_to_idx.size() != m_variables.size() ) {
+        throw std::runtime_error( "the binary file contains duplicated labels." );
+      }
+    }
+
+    /**
+     * @brief get the number of variables
+     *
+     * @return The number of variables.
+     */
+    size_t get_num_variables() const {
+      return m_variables.size();
+    }
+
+    /**
+     * @brief get the number of stored interactions
+     *
+     * @return The number of interactions.
+     */
+    size_t get_num_interactions() const {
+      return m_payload.num_interactions;
+    }
+
+    /**
+     * @brief Return true if the variable contains v.
+     *
+     * @param v
+     * @return Return true if the variable contains v.
+     */
+    bool contains( const IndexType &v ) const {
+      return m_label_to_idx.find( v ) != m_label_to_idx.end();
+    }
+
+    /**
+     * @brief Get variables
+     *
+     * @return variables (sorted)
+     */
+    const std::vector<IndexType> &get_variables() const {
+      return m_variables;
+    }
+
+    /**
+     * @brief Get the offset
+     *
+     * @return An offset.
+     */
+    FloatType get_offset() const {
+      return m_offset;
+    }
+
+    /**
+     * @brief Get the vartype object
+     *
+     * @return Type of the model.
+     */
+    Vartype get_vartype() const {
+      return m_vartype;
+    }
+
+    /**
+     * @brief Get the element of linear object
+     *
+     * @param label_i
+     * @return A linear bias.
+     */
+    FloatType get_linear( const IndexType &label_i ) const {
+      return m_payload.linear[ m_label_to_idx.at( label_i ) ];
+    }
+
+    /**
+     * @brief Get linear object
+     *
+     * @return A linear object
+     */
+    Linear<IndexType, FloatType> get_linear() const {
+      Linear<IndexType, FloatType> linear;
+      linear.reserve( m_variables.size() );
+      for ( size_t i = 0; i < m_variables.size(); i++ ) {
+        linear[ m_variables[ i ] ] = m_payload.linear[ i ];
+      }
+      return linear;
+    }
+
+    /**
+     * @brief Get the element of quadratic object
+     * the column indices of each row are sorted, so the bias is found by binary search.
+     *
+     * @param label_i
+     * @param label_j
+     * @return A quadratic bias.
+     */
+    FloatType get_quadratic( const IndexType &label_i, const IndexType &label_j ) const {
+      size_t i = m_label_to_idx.at( label_i );
+      size_t j = m_label_to_idx.at( label_j );
+      if ( i == j ) {
+        throw std::runtime_error( "No self-loop (mat(i,i)) allowed" );
+      }
+      if ( i > j ) {
+        std::swap( i, j );
+      }
+      const uint32_t *begin = m_payload.col_idx + m_payload.row_ptr[ i ];
+      const uint32_t *end = m_payload.col_idx + m_payload.row_ptr[ i + 1 ];
+      const uint32_t *it = std::lower_bound( begin, end, static_cast<uint32_t>( j ) );
+      if ( it == end || *it != j ) {
+        return 0;
+      }
+      return m_payload.values[ it - m_payload.col_idx ];
+    }
+
+    /**
+     * @brief Get quadratic object
+     *
+     * @return A quadratic object.
+     */
+    Quadratic<IndexType, FloatType> get_quadratic() const {
+      Quadratic<IndexType, FloatType> quadratic;
+      quadratic.reserve( m_payload.num_interactions );
+      for ( size_t i = 0; i < m_variables.size(); i++ ) {
+        for ( uint64_t p = m_payload.row_ptr[ i ]; p < m_payload.row_ptr[ i + 1 ]; p++ ) {
+          quadratic[ std::make_pair( m_variables[ i ], m_variables[ m_payload.col_idx[ p ] ] ) ] = m_payload.values[ p ];
+        }
+      }
+      return quadratic;
+    }
+
+    /**
+     * @brief Get the number of neighbors of variable v
+     *
+     * @param v
+     * @return degree
+     */
+    size_t degree( const IndexType &v ) const {
+      std::call_once( *m_col_flag, [ this ]() { _build_columns(); } );
+      size_t i = m_label_to_idx.at( v );
+      return ( m_payload.row_ptr[ i + 1 ] - m_payload.row_ptr[ i ] ) + ( m_col_ptr[ i + 1 ] - m_col_ptr[ i ] );
+    }
+
+    /**
+     * @brief Call f(u, bias) for each neighbor u of variable v.
+     * The first call builds a transposed index of the interactions (12 bytes per interaction) in private memory.
+     *
+     * @tparam F
+     * @param v
+     * @param f
+     */
+    template<typename F>
+    void for_each_neighbor( const IndexType &v, F &&f ) const {
+      std::call_once( *m_col_flag, [ this ]() { _build_columns(); } );
+      size_t i = m_label_to_idx.at( v );
+      for ( uint64_t q = m_col_ptr[ i ]; q < m_col_ptr[ i + 1 ]; q++ ) {
+        f( m_variables[ m_col_row[ q ] ], m_payload.values[ m_col_pos[ q ] ] );
+      }
+      for ( uint64_t p = m_payload.row_ptr[ i ]; p < m_payload.row_ptr[ i + 1 ]; p++ ) {
+        f( m_variables[ m_payload.col_idx[ p ] ], m_payload.values[ p ] );
+      }
+    }
+
+    /**
+     * @brief Determine the energy of the specified sample of a binary quadratic model.
+     *
+     * @param sample
+     * @return An energy with respect to the sample.
+     */
+    FloatType energy( const Sample<IndexType> &sample ) const {
+      std::vector<AccType> s( m_variables.size(), 0 );
+      for ( const auto &elem : sample ) {
+        s[ m_label_to_idx.at( elem.first ) ] = elem.second;
+      }
+      return _energy( s );
+    }
+
+    /**
+     * @brief Determine the energies of the given samples.
+     *
+     * @param samples_like
+     * @return A vector including energies with respect to the samples.
+     */
+    std::vector<FloatType> energies( const std::vector<Sample<IndexType>> &samples_like ) const {
+      std::vector<FloatType> en_vec( samples_like.size() );
+      std::vector<char> found( samples_like.size(), true );
+
+#pragma omp parallel
+      {
+        std::vector<AccType> s( m_variables.size() );
+#pragma omp for
+        for ( int64_t k = 0; k < ( int64_t )samples_like.size(); k++ ) {
+          std::fill( s.begin(), s.end(), 0 );
+          for ( const auto &elem : samples_like[ k ] ) {
+            auto it = m_label_to_idx.find( elem.first );
+            if ( it == m_label_to_idx.end() ) {
+              found[ k ] = false;
+              break;
+            }
+            s[ it->second ] = elem.second;
+          }
+          en_vec[ k ] = _energy( s );
+        }
+      }
+
+      if ( std::find( found.begin(), found.end(), false ) != found.end() ) {
+        throw std::out_of_range( "the sample contains a variable not in the model." );
+      }
+      return en_vec;
+    }
+
+    /**
+     * @brief Determine the energies of the given samples stored in a contiguous array.
+     * The array is a row-major (num_samples x num_variables) matrix whose columns follow the order of get_variables().
+     *
+     * @tparam SampleType integer type of the samples (e.g. int8_t, int32_t)
+     * @param samples pointer to the first element of the array
+     * @param num_samples
+     * @return A vector including energies with respect to the samples.
+     */
+    template<typename SampleType>
+    std::vector<FloatType> energies( const SampleType *samples, size_t num_samples ) const {
+      static_assert( std::is_integral_v<SampleType>, "SampleType must be an integer type." );
+      const size_t num_variables = m_variables.size();
+      std::vector<FloatType> en_vec( num_samples );
+
+#pragma omp parallel
+      {
+        std::vector<AccType> s( num_variables );
+#pragma omp for
+        for ( int64_t k = 0; k < ( int64_t )num_samples; k++ ) {
+          std::copy( samples + k * num_variables, samples + ( k + 1 ) * num_variables, s.begin() );
+          en_vec[ k ] = _energy( s );
+        }
+      }
+      return en_vec;
+    }
+
+    /**
+     * @brief Convert a binary quadratic model to QUBO format.
+     * SPIN models are converted on the fly without creating another model.
+     *
+     * @return A tuple including a quadratic bias and an offset.
+     */
+    std::tuple<Quadratic<IndexType, FloatType>, FloatType> to_qubo() const {
+      const size_t N = m_variables.size();
+      const bool spin = ( m_vartype == Vartype::SPIN );
+      std::vector<AccType> sums;
+      if ( spin ) {
+        sums = _quadratic_sums();
+      }
+
+      Quadratic<IndexType, FloatType> Q;
+      Q.reserve( N + m_payload.num_interactions );
+      AccType offset = m_offset;
+      for ( size_t i = 0; i < N; i++ ) {
+        AccType h = m_payload.linear[ i ];
+        if ( spin ) {
+          offset += 0.5 * sums[ i ] - h;
+          h = 2 * h - 2 * sums[ i ];
+        }
+        Q[ std::make_pair( m_variables[ i ], m_variables[ i ] ) ] = static_cast<FloatType>( h );
+        for ( uint64_t p = m_payload.row_ptr[ i ]; p < m_payload.row_ptr[ i + 1 ]; p++ ) {
+          const FloatType J = m_payload.values[ p ];
+          Q[ std::make_pair( m_variables[ i ], m_variables[ m_payload.col_idx[ p ] ] ) ] = spin ? 4 * J : J;
+        }
+      }
+      return std::make_tuple( Q, static_cast<FloatType>( offset ) );
+    }
+
+    /**
+     * @brief Convert a binary quadratic model to Ising format.
+     * BINARY models are converted on the fly without creating another model.
+     *
+     * @return A tuple including a linear bias, a quadratic bias and an offset.
+     */
+    std::tuple<Linear<IndexType, FloatType>, Quadratic<IndexType, FloatType>, FloatType> to_ising() const {
+      const size_t N = m_variables.size();
+      const bool binary = ( m_vartype == Vartype::BINARY );
+      std::vector<AccType> sums;
+      if ( binary ) {
+        sums = _quadratic_sums();
+      }
+
+      Linear<IndexType, FloatType> linear;
+      Quadratic<IndexType, FloatType> quadratic;
+      linear.reserve( N );
+      quadratic.reserve( m_payload.num_interactions );
+      AccType offset = m_offset;
+      for ( size_t i = 0; i < N; i++ ) {
+        AccType h = m_payload.linear[ i ];
+        if ( binary ) {
+          offset += 0.125 * sums[ i ] + 0.5 * h;
+          h = 0.5 * h + 0.25 * sums[ i ];
+        }
+        linear[ m_variables[ i ] ] = static_cast<FloatType>( h );
+        for ( uint64_t p = m_payload.row_ptr[ i ]; p < m_payload.row_ptr[ i + 1 ]; p++ ) {
+          const FloatType J = m_payload.values[ p ];
+          quadratic[ std::make_pair( m_variables[ i ], m_variables[ m_payload.col_idx[ p ] ] ) ] = binary ? J / 4 : J;
+        }
+      }
+      return std::make_tuple( linear, quadratic, static_cast<FloatType>( offset ) );
+    }
+  };
+} // namespace cimod
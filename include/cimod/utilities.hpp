@@ -14,14 +14,71 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "cimod/flat_hash_map.hpp"
 #include "cimod/vartypes.hpp"
 
 namespace cimod {
   /**
-   * @brief Insert or assign a element of unordered_map (for C++14 or C++11)
+   * @brief Type used to accumulate biases of FloatType (energies, offsets of the vartype conversions).
+   * float biases are accumulated in double so that the float instantiations keep the precision of the sums.
+   *
+   * @tparam FloatType
+   */
+  template<typename FloatType>
+  using AccumulateType = std::common_type_t<FloatType, double>;
+
+  /**
+   * @brief std::once_flag guarding a lazily built cache of a copyable class.
+   * const methods build the cache through call(), so concurrent readers build it only once. A copy starts with a fresh
+   * flag and builds its own cache, and reset() rearms the flag after the cached data is modified (a mutation must not
+   * run concurrently with the readers).
+   */
+  class CacheOnceFlag {
+  public:
+    CacheOnceFlag() = default;
+
+    CacheOnceFlag( const CacheOnceFlag & ) { }
+
+    CacheOnceFlag &operator=( const CacheOnceFlag & ) {
+      m_flag = std::make_unique<std::once_flag>();
+      m_called = false;
+      return *this;
+    }
+
+    /**
+     * @brief call f if it has not been called since the construction or the last reset
+     */
+    template<typename F>
+    void call( F &&f ) {
+      std::call_once( *m_flag, [ this, &f ]() {
+        f();
+        m_called = true;
+      } );
+    }
+
+    /**
+     * @brief rearm the flag; the flag is reallocated only if the cache has been built
+     */
+    void reset() {
+      if ( m_called ) {
+        m_flag = std::make_unique<std::once_flag>();
+        m_called = false;
+      }
+    }
+
+  private:
+    std::unique_ptr<std::once_flag> m_flag = std::make_unique<std::once_flag>();
+    bool m_called = false;
+  };
+
+  /**
+   * @brief Insert or assign a element of unordered_map with a single lookup
    *
    * @tparam C_key
    * @tparam C_value
@@ -32,14 +89,21 @@ namespace cimod {
 
   template<class C_key, class C_value, class Hash>
   void insert_or_assign( std::unordered_map<C_key, C_value, Hash> &um, const C_key &key, const C_value &val ) {
-    // insert
-    if ( um.count( key ) == 0 ) {
-      um.insert( { { key, val } } );
-    }
-    // assign
-    else {
-      um[ key ] = val;
-    }
+    um.insert_or_assign( key, val );
+  }
+
+  /**
+   * @brief Insert or assign a element of FlatHashMap
+   *
+   * @tparam C_key
+   * @tparam C_value
+   * @param um
+   * @param key
+   * @param val
+   */
+  template<class C_key, class C_value, class Hash, class KeyEqual>
+  void insert_or_assign( FlatHashMap<C_key, C_value, Hash, KeyEqual> &um, const C_key &key, const C_value &val ) {
+    um.insert_or_assign( key, val );
   }
 
   //! @brief Format the input key: for example, {2,1,1}-->{1,2} for BINARY variable and {2,1,1}-->{2} for SPIN variable.
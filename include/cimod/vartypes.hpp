@@ -15,6 +15,7 @@
 #pragma once
 
 #include <iostream>
+#include <stdexcept>
 
 namespace cimod {
   /**
@@ -54,4 +55,25 @@ namespace cimod {
       return false;
     }
   }
+
+  /**
+   * @brief Check that the variable has appropriate value without printing
+   *
+   * @param var
+   * @param vartype
+   * @throw std::runtime_error if var is not a value of vartype
+   */
+  inline void validate_vartype( const int32_t &var, const Vartype &vartype ) {
+    if ( vartype == Vartype::SPIN ) {
+      if ( var != 1 && var != -1 ) {
+        throw std::runtime_error( "Spin variable must be +1 or -1." );
+      }
+    } else if ( vartype == Vartype::BINARY ) {
+      if ( var != 1 && var != 0 ) {
+        throw std::runtime_error( "Binary variable must be 1 or 0." );
+      }
+    } else {
+      throw std::runtime_error( "Unknown variable type." );
+    }
+  }
 } // namespace cimod
@@ -17,16 +17,21 @@
 #include <nlohmann/json.hpp>
 
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <tuple>
 
 #include <cimod/binary_quadratic_model.hpp>
 #include <cimod/binary_polynomial_model.hpp>
 #include <cimod/binary_quadratic_model_dict.hpp>
+#include <cimod/binary_quadratic_model_packed.hpp>
+#include <cimod/flat_hash_map.hpp>
 
 #include "test_bqm.hpp"
 
@@ -39,6 +44,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseConstructionTest_Construction();
         BQMTester<Sparse>::test_DenseConstructionTest_Construction();
+        BQMTester<PackedDense>::test_DenseConstructionTest_Construction();
         BQMTester<Dict>::test_DenseConstructionTest_Construction();
     }
 
@@ -46,6 +52,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseConstructionTest_ConstructionString();
         BQMTester<Sparse>::test_DenseConstructionTest_ConstructionString();
+        BQMTester<PackedDense>::test_DenseConstructionTest_ConstructionString();
         BQMTester<Dict>::test_DenseConstructionTest_ConstructionString();
     }
 
@@ -53,18 +60,28 @@ namespace
     {
         BQMTester<Dense>::test_DenseConstructionTest_ConstructionMatrix();
         BQMTester<Sparse>::test_DenseConstructionTest_ConstructionMatrix();
+        BQMTester<PackedDense>::test_DenseConstructionTest_ConstructionMatrix();
     }
 
     TEST(DenseConstructionTest, ConstructionMatrix2)
     {
         BQMTester<Dense>::test_DenseConstructionTest_ConstructionMatrix2();
         BQMTester<Sparse>::test_DenseConstructionTest_ConstructionMatrix2();
+        BQMTester<PackedDense>::test_DenseConstructionTest_ConstructionMatrix2();
+    }
+
+    TEST(DenseConstructionTest, ConstructionCOO)
+    {
+        BQMTester<Dense>::test_DenseConstructionTest_ConstructionCOO();
+        BQMTester<Sparse>::test_DenseConstructionTest_ConstructionCOO();
+        BQMTester<PackedDense>::test_DenseConstructionTest_ConstructionCOO();
     }
 
     TEST(DenseBQMFunctionTest, add_variable)
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_add_variable();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_add_variable();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_add_variable();
         BQMTester<Dict>::test_DenseBQMFunctionTest_add_variable();
     }
 
@@ -72,6 +89,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_add_variables_from();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_add_variables_from();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_add_variables_from();
         BQMTester<Dict>::test_DenseBQMFunctionTest_add_variables_from();
     }
 
@@ -79,13 +97,22 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_add_interaction();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_add_interaction();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_add_interaction();
         BQMTester<Dict>::test_DenseBQMFunctionTest_add_interaction();
     }
 
+    TEST(DenseBQMFunctionTest, add_interaction_unordered)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_add_interaction_unordered();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_add_interaction_unordered();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_add_interaction_unordered();
+    }
+
     TEST(DenseBQMFunctionTest, add_interactions_from)
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_add_interactions_from();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_add_interactions_from();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_add_interactions_from();
         BQMTester<Dict>::test_DenseBQMFunctionTest_add_interactions_from();
     }
 
@@ -93,6 +120,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_add_offset();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_add_offset();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_add_offset();
         BQMTester<Dict>::test_DenseBQMFunctionTest_add_offset();
     }
 
@@ -100,6 +128,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_energy();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_energy();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_energy();
         BQMTester<Dict>::test_DenseBQMFunctionTest_energy();
     }
 
@@ -107,13 +136,31 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_energies();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_energies();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_energies();
         BQMTester<Dict>::test_DenseBQMFunctionTest_energies();
     }
 
+    TEST(DenseBQMFunctionTest, energies_array)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_energies_array();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_energies_array();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_energies_array();
+        BQMTester<Dict>::test_DenseBQMFunctionTest_energies_array();
+    }
+
+    TEST(DenseBQMFunctionTest, energy_evaluator)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_energy_evaluator();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_energy_evaluator();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_energy_evaluator();
+        BQMTester<Dict>::test_DenseBQMFunctionTest_energy_evaluator();
+    }
+
     TEST(DenseBQMFunctionTest, empty)
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_empty();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_empty();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_empty();
         BQMTester<Dict>::test_DenseBQMFunctionTest_empty();
     }
 
@@ -121,6 +168,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_to_qubo();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_to_qubo();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_to_qubo();
         BQMTester<Dict>::test_DenseBQMFunctionTest_to_qubo();
     }
 
@@ -128,6 +176,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_to_ising();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_to_ising();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_to_ising();
         BQMTester<Dict>::test_DenseBQMFunctionTest_to_ising();
     }
 
@@ -135,6 +184,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_from_qubo();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_from_qubo();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_from_qubo();
         BQMTester<Dict>::test_DenseBQMFunctionTest_from_qubo();
     }
 
@@ -142,6 +192,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_from_ising();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_from_ising();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_from_ising();
         BQMTester<Dict>::test_DenseBQMFunctionTest_from_ising();
     }
 
@@ -149,6 +200,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_remove_variable();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_remove_variable();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_remove_variable();
         BQMTester<Dict>::test_DenseBQMFunctionTest_remove_variable();
     }
 
@@ -156,13 +208,22 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_remove_variables_from();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_remove_variables_from();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_remove_variables_from();
         BQMTester<Dict>::test_DenseBQMFunctionTest_remove_variables_from();
     }
 
+    TEST(DenseBQMFunctionTest, remove_variables_from_batch)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_remove_variables_from_batch();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_remove_variables_from_batch();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_remove_variables_from_batch();
+    }
+
     TEST(DenseBQMFunctionTest, remove_interaction)
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_remove_interaction();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_remove_interaction();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_remove_interaction();
         BQMTester<Dict>::test_DenseBQMFunctionTest_remove_interaction();
     }
 
@@ -170,6 +231,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_scale();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_scale();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_scale();
         BQMTester<Dict>::test_DenseBQMFunctionTest_scale();
     }
 
@@ -177,6 +239,7 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_normalize();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_normalize();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_normalize();
         BQMTester<Dict>::test_DenseBQMFunctionTest_normalize();
     }
 
@@ -184,13 +247,22 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_fix_variable();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_fix_variable();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_fix_variable();
         BQMTester<Dict>::test_DenseBQMFunctionTest_fix_variable();
     }
 
+    TEST(DenseBQMFunctionTest, fix_variables)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_fix_variables();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_fix_variables();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_fix_variables();
+    }
+
     TEST(DenseBQMFunctionTest, flip_variable)
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_flip_variable();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_flip_variable();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_flip_variable();
         BQMTester<Dict>::test_DenseBQMFunctionTest_flip_variable();
     }
 
@@ -198,20 +270,107 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_flip_variable_binary();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_flip_variable_binary();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_flip_variable_binary();
         BQMTester<Dict>::test_DenseBQMFunctionTest_flip_variable_binary();
     }
 
+    TEST(DenseBQMFunctionTest, flip_variable_binary_energy)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_flip_variable_binary_energy();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_flip_variable_binary_energy();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_flip_variable_binary_energy();
+        BQMTester<Dict>::test_DenseBQMFunctionTest_flip_variable_binary_energy();
+    }
+
     TEST(DenseBQMFunctionTest, change_vartype)
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_change_vartype();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_change_vartype();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_change_vartype();
         BQMTester<Dict>::test_DenseBQMFunctionTest_change_vartype();
     }
 
+    TEST(DenseBQMFunctionTest, change_vartype_view)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_change_vartype_view();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_change_vartype_view();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_change_vartype_view();
+        BQMTester<Dict>::test_DenseBQMFunctionTest_change_vartype_view();
+    }
+
+    TEST(DenseBQMFunctionTest, label_table)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_label_table();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_label_table();
+    }
+
+    TEST(DenseBQMFunctionTest, save_load)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_save_load();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_save_load();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_save_load();
+        BQMTester<Dict>::test_DenseBQMFunctionTest_save_load();
+    }
+
+    TEST(DenseBQMFunctionTest, text_io)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_text_io();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_text_io();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_text_io();
+        BQMTester<Dict>::test_DenseBQMFunctionTest_text_io();
+    }
+
+    TEST(DenseBQMFunctionTest, mapped)
+    {
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_mapped();
+        BQMTester<Dict>::test_DenseBQMFunctionTest_mapped();
+    }
+
+    TEST(DenseBQMFunctionTest, neighbors)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_neighbors();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_neighbors();
+    }
+
+    TEST(DenseBQMFunctionTest, version)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_version();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_version();
+    }
+
+    TEST(DenseBQMFunctionTest, interaction_matrix_ref)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_interaction_matrix_ref();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_interaction_matrix_ref();
+    }
+
+    TEST(DenseBQMFunctionTest, adjacency)
+    {
+        BQMTester<Dict>::test_DenseBQMFunctionTest_adjacency();
+    }
+
+    TEST(DenseBQMFunctionTest, energy_validation)
+    {
+        BQMTester<Dict>::test_DenseBQMFunctionTest_energy_validation();
+    }
+
+    TEST(DenseBQMFunctionTest, energies_samples)
+    {
+        BQMTester<Dict>::test_DenseBQMFunctionTest_energies_samples();
+    }
+
+    TEST(DenseBQMFunctionTest, concurrent_get_variables)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_concurrent_get_variables();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_concurrent_get_variables();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_concurrent_get_variables();
+    }
+
     TEST(DenseBQMFunctionTest, to_serializable)
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_to_serializable();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_to_serializable();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_to_serializable();
         BQMTester<Dict>::test_DenseBQMFunctionTest_to_serializable();
     }
 
@@ -219,9 +378,24 @@ namespace
     {
         BQMTester<Dense>::test_DenseBQMFunctionTest_from_serializable();
         BQMTester<Sparse>::test_DenseBQMFunctionTest_from_serializable();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_from_serializable();
         BQMTester<Dict>::test_DenseBQMFunctionTest_from_serializable();
     }
 
+    TEST(DenseBQMFunctionTest, consistency_with_dense)
+    {
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_consistency_with_dense();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_consistency_with_dense();
+    }
+
+    TEST(DenseBQMFunctionTest, float_precision)
+    {
+        BQMTester<Dense>::test_DenseBQMFunctionTest_float_precision();
+        BQMTester<Sparse>::test_DenseBQMFunctionTest_float_precision();
+        BQMTester<Dict>::test_DenseBQMFunctionTest_float_precision();
+        BQMTester<PackedDense>::test_DenseBQMFunctionTest_float_precision();
+    }
+
 //google test for binary polynomial model
 bool EXPECT_CONTAIN(double val, const PolynomialValueList<double> &poly_value) {
    int count = 0;
@@ -1079,6 +1253,36 @@ TEST(EnergyBPM, BINARY) {
       
 }
 
+TEST(EnergyBPM, Float) {
+   
+   Polynomial<uint32_t, float> polynomial;
+   Polynomial<uint32_t, double> polynomial_double;
+   for (uint32_t i = 0; i < 2000; ++i) {
+      const float value = 0.1f * (i % 7) + 0.01f;
+      polynomial[{i, (i + 1) % 2000, (i + 2) % 2000}] = value;
+      polynomial_double[{i, (i + 1) % 2000, (i + 2) % 2000}] = value;
+   }
+
+   BinaryPolynomialModel<uint32_t, float> bpm(polynomial, Vartype::SPIN);
+   BinaryPolynomialModel<uint32_t, double> bpm_double(polynomial_double, Vartype::SPIN);
+   
+   Sample<uint32_t> sample;
+   for (uint32_t i = 0; i < 2000; ++i) {
+      sample[i] = (i % 3 == 0) ? -1 : +1;
+   }
+   const double energy = bpm_double.Energy(sample);
+   EXPECT_NEAR(bpm.Energy(sample), energy, 1e-6 * std::abs(energy));
+
+   bpm.ChangeVartype(Vartype::BINARY);
+   bpm_double.ChangeVartype(Vartype::BINARY);
+   for (auto &&it : sample) {
+      it.second = (it.second + 1) / 2;
+   }
+   EXPECT_NEAR(bpm.Energy(sample), energy, 1e-6 * std::abs(energy));
+   EXPECT_NEAR(bpm.Energy(sample), bpm_double.Energy(sample), 1e-6 * std::abs(energy));
+      
+}
+
 TEST(EnergiesBPM, SPIN) {
    
    Polynomial<uint32_t, double> polynomial {
@@ -1150,6 +1354,39 @@ TEST(EnergiesBPM, BINARY) {
    
 }
 
+TEST(EnergiesBPM, Array) {
+   
+   Polynomial<uint32_t, double> polynomial {
+      {{5}, 1.0}, {{1}, -2.0}, {{3, 5}, 4.0}, {{1, 3, 5}, 8.0}, {{}, 0.5}
+   };
+   
+   BinaryPolynomialModel<uint32_t, double> bpm(polynomial, Vartype::SPIN);
+   
+   // columns follow the sorted variables {1, 3, 5}
+   const std::vector<int8_t> samples_int8 {
+      +1, +1, +1,
+      -1, +1, -1,
+      +1, -1, -1
+   };
+   const std::vector<int32_t> samples_int32(samples_int8.begin(), samples_int8.end());
+   
+   std::vector<std::vector<int32_t>> samples_vec;
+   for (std::size_t k = 0; k < 3; ++k) {
+      samples_vec.emplace_back(samples_int32.begin() + 3 * k, samples_int32.begin() + 3 * (k + 1));
+   }
+   const std::vector<double> en_vec = bpm.Energies(samples_vec);
+   const std::vector<double> en_vec_int8 = bpm.Energies(samples_int8.data(), 3);
+   const std::vector<double> en_vec_int32 = bpm.Energies(samples_int32.data(), 3);
+   
+   ASSERT_EQ(en_vec_int8.size(), 3);
+   for (std::size_t k = 0; k < 3; ++k) {
+      EXPECT_DOUBLE_EQ(en_vec_int8[k], en_vec[k]);
+      EXPECT_DOUBLE_EQ(en_vec_int32[k], en_vec[k]);
+   }
+   EXPECT_DOUBLE_EQ(en_vec_int8[0], 11.5);
+   
+}
+
 TEST(ScaleBPM, all_scale) {
    
    Polynomial<uint32_t, double> polynomial = GeneratePolynomialUINT();
@@ -1301,6 +1538,104 @@ TEST(SerializableBPM, StringToINT) {
    StateTestBPMINT(bpm_from);
 }
 
+TEST(BinaryFileBPM, UINT) {
+   BinaryPolynomialModel<uint32_t, double> bpm(GeneratePolynomialUINT(), Vartype::SPIN);
+   const std::string path = testing::TempDir() + "cimod_bpm_uint.bin";
+   bpm.Save(path);
+   BinaryPolynomialModel<uint32_t, double> bpm_from = BinaryPolynomialModel<uint32_t, double>::Load(path);
+   std::remove(path.c_str());
+   StateTestBPMUINT(bpm_from);
+}
+
+TEST(BinaryFileBPM, String) {
+   BinaryPolynomialModel<std::string, double> bpm(GeneratePolynomialString(), Vartype::SPIN);
+   const std::string path = testing::TempDir() + "cimod_bpm_string.bin";
+   bpm.Save(path);
+   BinaryPolynomialModel<std::string, double> bpm_from = BinaryPolynomialModel<std::string, double>::Load(path);
+   EXPECT_THROW((BinaryQuadraticModel<std::string, double, Dense>::load(path)), std::runtime_error);
+   std::remove(path.c_str());
+   StateTestBPMString(bpm_from);
+}
+
+TEST(BinaryFile, CorruptedHeader) {
+   Linear<uint32_t, float> linear{ {0, 1.0f}, {1, -1.0f}, {2, 0.5f} };
+   Quadratic<uint32_t, float> quadratic{ {std::make_pair(0, 1), 2.0f}, {std::make_pair(1, 2), -3.0f} };
+   const std::string path = testing::TempDir() + "cimod_corrupted.bin";
+   auto save = [&]() {
+      BinaryQuadraticModel<uint32_t, float, Sparse>(linear, quadratic, 0.0f, Vartype::SPIN).save(path);
+   };
+   // num_variables and num_interactions are the uint64 fields at the bytes 32 and 40 of the header
+   auto patch = [&](std::streamoff position, uint64_t value) {
+      std::fstream fs(path, std::ios::in | std::ios::out | std::ios::binary);
+      fs.seekp(position);
+      fs.write(reinterpret_cast<const char *>(&value), sizeof(value));
+   };
+   
+   // sizeof(float) * 2^62 wraps to 0
+   save();
+   patch(40, uint64_t(1) << 62);
+   EXPECT_THROW((BinaryQuadraticModel<uint32_t, double, Sparse>::load(path)), std::runtime_error);
+   EXPECT_THROW((BinaryQuadraticModel<uint32_t, float, Dense>::load(path)), std::runtime_error);
+   save();
+   patch(32, uint64_t(1) << 62);
+   EXPECT_THROW((BinaryQuadraticModel<uint32_t, double, Sparse>::load(path)), std::runtime_error);
+   save();
+   patch(32, ~uint64_t(0));
+   EXPECT_THROW((BinaryQuadraticModel<uint32_t, double, Dense>::load(path)), std::runtime_error);
+   
+   // truncated file
+   save();
+   std::string content;
+   {
+      std::ifstream ifs(path, std::ios::binary);
+      content.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+   }
+   for (const size_t size : {content.size() - 1, content.size() / 2, size_t(40)}) {
+      std::ofstream(path, std::ios::binary | std::ios::trunc).write(content.data(), size);
+      EXPECT_THROW((BinaryQuadraticModel<uint32_t, double, Sparse>::load(path)), std::runtime_error);
+   }
+   
+   // polynomial payload: sizeof(double) * 2^61 wraps to 0
+   BinaryPolynomialModel<uint32_t, double>(GeneratePolynomialUINT(), Vartype::SPIN).Save(path);
+   patch(40, uint64_t(1) << 61);
+   EXPECT_THROW((BinaryPolynomialModel<uint32_t, double>::Load(path)), std::runtime_error);
+   std::remove(path.c_str());
+}
+
+TEST(BinaryFile, DuplicateColumn) {
+   const std::string path = testing::TempDir() + "cimod_duplicate_column.bin";
+   const std::vector<uint32_t> labels{0, 1, 2};
+   const std::vector<double> linear{1.0, -1.0, 0.5};
+   
+   // the interaction (0, 1) is stored twice in row 0
+   write_binary_csr(path, labels, linear, {{{1, 1.0}, {1, 2.0}}, {{2, 3.0}}, {}}, 0.0, Vartype::SPIN);
+   EXPECT_THROW((BinaryQuadraticModel<uint32_t, double, Sparse>::load(path)), std::runtime_error);
+   EXPECT_THROW((BinaryQuadraticModel<uint32_t, double, Dense>::load(path)), std::runtime_error);
+   EXPECT_THROW((MappedBinaryQuadraticModel<uint32_t, double>(path)), std::runtime_error);
+   
+   // unsorted columns are rejected as well
+   write_binary_csr(path, labels, linear, {{{2, 1.0}, {1, 2.0}}, {}, {}}, 0.0, Vartype::SPIN);
+   EXPECT_THROW((BinaryQuadraticModel<uint32_t, double, Sparse>::load(path)), std::runtime_error);
+   
+   write_binary_csr(path, labels, linear, {{{1, 1.0}, {2, 2.0}}, {{2, 3.0}}, {}}, 0.0, Vartype::SPIN);
+   EXPECT_DOUBLE_EQ((BinaryQuadraticModel<uint32_t, double, Sparse>::load(path).get_quadratic(0, 1)), 1.0);
+   std::remove(path.c_str());
+}
+
+TEST(TextFileBPM, COO) {
+   BinaryPolynomialModel<uint32_t, double> bpm(GeneratePolynomialUINT(), Vartype::SPIN);
+   const std::string path = testing::TempDir() + "cimod_bpm.coo";
+   io::write_coo(path, bpm);
+   BinaryPolynomialModel<uint32_t, double> bpm_from = io::read_coo_polynomial<uint32_t, double>(path).to_bpm();
+   io::TextReadOptions options;
+   options.chunk_size = 7;
+   BinaryPolynomialModel<uint32_t, double> bpm_chunked = io::read_coo_polynomial<uint32_t, double>(path, Vartype::SPIN, options).to_bpm();
+   EXPECT_THROW((io::read_coo_polynomial<uint32_t, double>(path, Vartype::BINARY)), std::runtime_error);
+   std::remove(path.c_str());
+   StateTestBPMUINT(bpm_from);
+   StateTestBPMUINT(bpm_chunked);
+}
+
 TEST(FromHubo, MapUINT) {
    auto bpm = BinaryPolynomialModel<uint32_t, double>::FromHubo(GeneratePolynomialUINT());
    EXPECT_EQ(Vartype::BINARY, bpm.GetVartype());
@@ -1543,7 +1878,117 @@ TEST(VartypeBPM, ChangeVartypeBinarySPINBinary) {
    
 }
 
+// hash with many collisions, so that clusters run into the tail of the table
+struct CollidingHash {
+   std::size_t operator()(const int64_t &key) const { return static_cast<std::size_t>(key % 7); }
+};
+
+template<typename Hash>
+void CheckFlatHashMapAgainstStd(const int64_t num_keys) {
+   FlatHashMap<int64_t, double, Hash> map;
+   std::unordered_map<int64_t, double> expected;
+   uint64_t state = 88172645463325252ULL;
+   for (int64_t step = 0; step < 20 * num_keys; ++step) {
+      state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+      const int64_t key = static_cast<int64_t>(state % num_keys);
+      switch (state / num_keys % 4) {
+         case 0:
+            map[key] += 1.0;
+            expected[key] += 1.0;
+            break;
+         case 1:
+            EXPECT_EQ(map.erase(key), expected.erase(key));
+            break;
+         case 2:
+            EXPECT_EQ(map.try_emplace(key, 0.5).second, expected.try_emplace(key, 0.5).second);
+            break;
+         default:
+            EXPECT_EQ(map.count(key), expected.count(key));
+            if (expected.count(key) != 0) {
+               EXPECT_EQ(map.at(key), expected.at(key));
+            } else {
+               EXPECT_TRUE(map.find(key) == map.end());
+               EXPECT_THROW(map.at(key), std::out_of_range);
+            }
+      }
+      EXPECT_EQ(map.size(), expected.size());
+   }
+   std::unordered_map<int64_t, double> iterated(map.begin(), map.end());
+   EXPECT_EQ(iterated, expected);
+   
+   // erase by iterator visits every entry exactly once
+   std::size_t num_visited = 0;
+   for (auto it = map.begin(); it != map.end();) {
+      num_visited++;
+      if (it->first % 2 == 0) {
+         it = map.erase(it);
+      } else {
+         ++it;
+      }
+   }
+   EXPECT_EQ(num_visited, expected.size());
+   for (auto it = expected.begin(); it != expected.end();) {
+      it = it->first % 2 == 0 ? expected.erase(it) : std::next(it);
+   }
+   const std::unordered_map<int64_t, double> remained(map.begin(), map.end());
+   EXPECT_EQ(remained, expected);
+   
+   map.clear();
+   EXPECT_TRUE(map.empty());
+   EXPECT_TRUE(map.begin() == map.end());
+}
 
+TEST(FlatHashMap, ConsistencyWithStd) {
+   CheckFlatHashMapAgainstStd<std::hash<int64_t>>(1000);
+   CheckFlatHashMapAgainstStd<CollidingHash>(200);
+}
 
+TEST(FlatHashMap, Interface) {
+   FlatHashMap<std::pair<uint32_t, uint32_t>, double, pair_hash> quadratic{ {{0, 1}, 1.0}, {{1, 2}, 2.0}, {{0, 1}, 3.0} };
+   EXPECT_EQ(quadratic.size(), 2);
+   EXPECT_DOUBLE_EQ(quadratic.at({0, 1}), 1.0);
+   
+   auto copied = quadratic;
+   EXPECT_TRUE(copied == quadratic);
+   copied.insert_or_assign({0, 1}, 3.0);
+   EXPECT_DOUBLE_EQ(copied.at({0, 1}), 3.0);
+   EXPECT_TRUE(copied != quadratic);
+   EXPECT_FALSE(copied.emplace(std::make_pair(1u, 2u), 5.0).second);
+   
+   FlatHashMap<std::vector<uint32_t>, double, vector_hash> polynomial;
+   polynomial.reserve(100);
+   const std::size_t bucket_count = polynomial.bucket_count();
+   for (uint32_t i = 0; i < 100; ++i) {
+      polynomial[{i, i + 1}] = i;
+   }
+   EXPECT_EQ(polynomial.bucket_count(), bucket_count);
+   EXPECT_DOUBLE_EQ(polynomial.at({42, 43}), 42.0);
+   EXPECT_EQ(polynomial.count({43, 42}), 0);
+   
+   FlatHashMap<std::vector<uint32_t>, double, vector_hash> moved = std::move(polynomial);
+   EXPECT_EQ(moved.size(), 100);
 }
 
+TEST(Hash, GridLabels) {
+   // no two labels or nearest-neighbor pairs of a grid share a hash value
+   std::unordered_set<std::size_t> tuple_hashes, pair_hashes, vector_hashes;
+   const int64_t L = 64;
+   for (int64_t x = 0; x < L; ++x) {
+      for (int64_t y = 0; y < L; ++y) {
+         tuple_hashes.insert(std::hash<std::tuple<int64_t, int64_t>>()(std::make_tuple(x, y)));
+         pair_hashes.insert(pair_hash()(std::make_pair(x * L + y, x * L + y + 1)));
+         pair_hashes.insert(pair_hash()(std::make_pair(x * L + y, x * L + y + L)));
+         vector_hashes.insert(vector_hash()(std::vector<int64_t>{x, y, x + y}));
+      }
+   }
+   EXPECT_EQ(tuple_hashes.size(), L * L);
+   EXPECT_EQ(pair_hashes.size(), 2 * L * L);
+   EXPECT_EQ(vector_hashes.size(), L * L);
+   
+   // the order of the elements matters
+   EXPECT_NE(pair_hash()(std::make_pair(1, 2)), pair_hash()(std::make_pair(2, 1)));
+   EXPECT_NE(vector_hash()(std::vector<int64_t>{1, 2}), vector_hash()(std::vector<int64_t>{2, 1}));
+   EXPECT_NE(vector_hash()(std::vector<int64_t>{}), vector_hash()(std::vector<int64_t>{0}));
+}
+
+}
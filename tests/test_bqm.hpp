@@ -21,12 +21,21 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <thread>
+#include <fstream>
 #include <iostream>
 #include <tuple>
+#include <limits>
 
 #include <nlohmann/json.hpp>
 
 #include <cimod/binary_quadratic_model.hpp>
+#include <cimod/binary_quadratic_model_packed.hpp>
+#include <cimod/energy_evaluator.hpp>
+#include <cimod/mapped_binary_quadratic_model.hpp>
+#include <cimod/io/bqpjson.hpp>
+#include <cimod/io/coo.hpp>
+#include <cimod/io/qubo.hpp>
 
 using json = nlohmann::json;
 using namespace cimod;
@@ -266,6 +275,39 @@ struct BQMTester{
         EXPECT_DOUBLE_EQ(bqm.get_linear("e"), 36);
     }
 
+    static void test_DenseConstructionTest_ConstructionCOO()
+    {
+        std::vector<std::string> row{"a", "b", "a", "c", "b", "a", "d", "c"};
+        std::vector<std::string> col{"b", "a", "a", "d", "c", "b", "d", "a"};
+        std::vector<double> bias{1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
+        double offset = 0.5;
+        Vartype vartype = Vartype::BINARY;
+
+        BQM<std::string, double, DataType> bqm = BQM<std::string, double, DataType>::from_coo(row, col, bias, offset, vartype);
+
+        Linear<std::string, double> linear{ {"a", 3.0}, {"d", 7.0} };
+        Quadratic<std::string, double> quadratic
+        {
+            {std::make_pair("a", "b"), 9.0}, {std::make_pair("c", "d"), 4.0},
+            {std::make_pair("b", "c"), 5.0}, {std::make_pair("a", "c"), 8.0}
+        };
+        BQM<std::string, double, DataType> bqm_ref(linear, quadratic, offset, vartype);
+
+        // check variables, offset and vartype
+        EXPECT_EQ(bqm.get_variables(), bqm_ref.get_variables());
+        EXPECT_EQ(bqm.get_offset(), offset);
+        EXPECT_EQ(bqm.get_vartype(), vartype);
+
+        // check interaction matrix
+        typename BQM<std::string, double, DataType>::DenseMatrix mat = bqm.interaction_matrix();
+        typename BQM<std::string, double, DataType>::DenseMatrix mat_ref = bqm_ref.interaction_matrix();
+        EXPECT_DOUBLE_EQ((mat - mat_ref).norm(), 0.0);
+
+        // size mismatch
+        bias.pop_back();
+        EXPECT_THROW((BQM<std::string, double, DataType>::from_coo(row, col, bias, offset, vartype)), std::runtime_error);
+    }
+
     static void test_DenseBQMFunctionTest_add_variable()
     {
         Linear<uint32_t, double> linear{ {0, 0.0}, {2, 1.0} };
@@ -350,6 +392,55 @@ struct BQMTester{
         EXPECT_EQ(bqm.interaction_matrix().cols(), bqm.get_num_variables() + 1);
     }
 
+    static void test_DenseBQMFunctionTest_add_interaction_unordered()
+    {
+        Linear<uint32_t, double> linear;
+        Quadratic<uint32_t, double> quadratic;
+        double offset = 0.5;
+        Vartype vartype = Vartype::SPIN;
+
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, offset, vartype);
+
+        // add variables in descending order to make the labels unsorted
+        for(uint32_t i = 20; i > 0; i--)
+        {
+            bqm.add_interaction(i, (i * 7) % 20 + 1, 0.1 * i);
+            bqm.add_variable(i, -0.2 * i);
+        }
+        bqm.remove_variable(10);
+        linear = bqm.get_linear();
+        quadratic = bqm.get_quadratic();
+
+        BQM<uint32_t, double, DataType> bqm_ref(linear, quadratic, offset, vartype);
+
+        // check variables
+        EXPECT_EQ(bqm.get_variables(), bqm_ref.get_variables());
+        EXPECT_TRUE(std::is_sorted(bqm.get_variables().begin(), bqm.get_variables().end()));
+
+        // check interaction matrix
+        typename BQM<uint32_t, double, DataType>::DenseMatrix mat = bqm.interaction_matrix();
+        typename BQM<uint32_t, double, DataType>::DenseMatrix mat_ref = bqm_ref.interaction_matrix();
+        EXPECT_EQ(mat.rows(), 20);
+        EXPECT_DOUBLE_EQ((mat - mat_ref).norm(), 0.0);
+
+        // check energy
+        Sample<uint32_t> sample;
+        for(uint32_t i : bqm.get_variables())
+        {
+            sample[i] = (i % 3 == 0) ? -1 : +1;
+        }
+        EXPECT_DOUBLE_EQ(bqm.energy(sample), bqm_ref.energy(sample));
+
+        // check serialization
+        EXPECT_EQ(bqm.to_serializable(), bqm_ref.to_serializable());
+
+        // keys of quadratic are ordered by labels
+        for(const auto &it : bqm.get_quadratic())
+        {
+            EXPECT_LT(it.first.first, it.first.second);
+        }
+    }
+
     static void test_DenseBQMFunctionTest_add_interactions_from()
     {
         Linear<uint32_t, double> linear;
@@ -432,6 +523,84 @@ struct BQMTester{
         EXPECT_DOUBLE_EQ(en_vec[1], 3.5);
     }
 
+    static void test_DenseBQMFunctionTest_energies_array()
+    {
+        Linear<uint32_t, double> linear{ {5, 1.0}, {1, -2.0}, {3, 3.0} };
+        Quadratic<uint32_t, double> quadratic{ {std::make_pair(5, 1), 1.5}, {std::make_pair(3, 5), -0.5} };
+        double offset = 0.5;
+        Vartype vartype = Vartype::SPIN;
+
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, offset, vartype);
+        // variables added out of order
+        bqm.add_interaction(4, 0, 2.0);
+        bqm.add_variable(2, -1.0);
+
+        const std::vector<uint32_t> &variables = bqm.get_variables();
+        const size_t num_samples = 1000;
+        std::vector<int8_t> samples_array(num_samples * variables.size());
+        std::vector<Sample<uint32_t>> samples(num_samples);
+        for(size_t k = 0; k < num_samples; k++)
+        {
+            for(size_t i = 0; i < variables.size(); i++)
+            {
+                int8_t s = ((k >> i) & 1) ? +1 : -1;
+                samples_array[k * variables.size() + i] = s;
+                samples[k][variables[i]] = s;
+            }
+        }
+
+        std::vector<double> en_vec = bqm.energies(samples);
+        std::vector<double> en_vec_array = bqm.energies(samples_array.data(), num_samples);
+        ASSERT_EQ(en_vec.size(), num_samples);
+        ASSERT_EQ(en_vec_array.size(), num_samples);
+        for(size_t k = 0; k < num_samples; k++)
+        {
+            EXPECT_DOUBLE_EQ(en_vec[k], bqm.energy(samples[k]));
+            EXPECT_DOUBLE_EQ(en_vec_array[k], bqm.energy(samples[k]));
+        }
+
+        // unknown variable (the Dict class ignores variables not in the model)
+        if constexpr (!std::is_same_v<DataType, Dict>)
+        {
+            samples[num_samples - 1][100] = 1;
+            EXPECT_THROW(bqm.energies(samples), std::out_of_range);
+        }
+    }
+
+    static void test_DenseBQMFunctionTest_energy_evaluator()
+    {
+        Linear<uint32_t, double> linear{ {1, 1.0}, {2, -2.0}, {3, 3.0}, {4, 4.0}, {5, 0.5} };
+        Quadratic<uint32_t, double> quadratic
+        {
+            {std::make_pair(1, 2), 12.0}, {std::make_pair(1, 3), -13.0}, {std::make_pair(1, 4), 14.0},
+            {std::make_pair(2, 3), 23.0}, {std::make_pair(2, 4), -24.0}, {std::make_pair(4, 5), 45.0}
+        };
+        double offset = 0.5;
+
+        for(Vartype vartype : {Vartype::SPIN, Vartype::BINARY})
+        {
+            BQM<uint32_t, double, DataType> bqm(linear, quadratic, offset, vartype);
+            int32_t lo = (vartype == Vartype::SPIN) ? -1 : 0;
+            Sample<uint32_t> sample{ {1, +1}, {2, lo}, {3, +1}, {4, lo}, {5, +1} };
+
+            EnergyEvaluator<uint32_t, double, DataType> evaluator(bqm, sample);
+            EXPECT_DOUBLE_EQ(evaluator.energy(), bqm.energy(sample));
+
+            for(uint32_t v : {1, 4, 2, 4, 5, 3, 1})
+            {
+                double delta = evaluator.delta_energy(v);
+                double before = evaluator.energy();
+                evaluator.flip(v);
+                sample[v] = (vartype == Vartype::SPIN) ? -sample[v] : 1 - sample[v];
+
+                EXPECT_EQ(evaluator.get_state(v), sample[v]);
+                EXPECT_DOUBLE_EQ(evaluator.energy(), bqm.energy(sample));
+                EXPECT_DOUBLE_EQ(evaluator.energy() - before, delta);
+            }
+            EXPECT_EQ(evaluator.get_sample(), sample);
+        }
+    }
+
     static void test_DenseBQMFunctionTest_empty()
     {
         Linear<uint32_t, double> linear{ {1, 1.0}, {2, 1.0} };
@@ -602,6 +771,45 @@ struct BQMTester{
         EXPECT_EQ(bqm.interaction_matrix().cols(), bqm.get_num_variables() + 1);
     }
 
+    static void test_DenseBQMFunctionTest_remove_variables_from_batch()
+    {
+        Linear<uint32_t, double> linear;
+        Quadratic<uint32_t, double> quadratic;
+        for(uint32_t i = 0; i < 30; i++)
+        {
+            linear[i] = 0.1 * i;
+            quadratic[std::make_pair(i, (i * 7 + 3) % 30)] = 0.5 * i - 3.0;
+        }
+        double offset = 0.5;
+        Vartype vartype = Vartype::SPIN;
+
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, offset, vartype);
+        bqm.add_interaction(40, 2, 1.0);
+
+        std::vector<uint32_t> variables{ 29, 0, 13, 14, 40, 7, 100 };
+        bqm.remove_variables_from(variables);
+
+        for(const auto &v : variables)
+        {
+            linear.erase(v);
+            EXPECT_EQ(bqm.contains(v), false);
+        }
+        for(auto it = quadratic.begin(); it != quadratic.end();)
+        {
+            if(std::find(variables.begin(), variables.end(), it->first.first) != variables.end()
+               || std::find(variables.begin(), variables.end(), it->first.second) != variables.end())
+                it = quadratic.erase(it);
+            else
+                ++it;
+        }
+        BQM<uint32_t, double, DataType> bqm_ref(linear, quadratic, offset, vartype);
+
+        EXPECT_EQ(bqm.get_variables(), bqm_ref.get_variables());
+        typename BQM<uint32_t, double, DataType>::DenseMatrix mat = bqm.interaction_matrix();
+        typename BQM<uint32_t, double, DataType>::DenseMatrix mat_ref = bqm_ref.interaction_matrix();
+        EXPECT_DOUBLE_EQ((mat - mat_ref).norm(), 0.0);
+    }
+
     static void test_DenseBQMFunctionTest_remove_interaction()
     {
         Linear<std::string, double> linear{ {"c", 2} };
@@ -678,6 +886,10 @@ struct BQMTester{
         // check maximum biases
         EXPECT_DOUBLE_EQ(lin_max->second, -1.0);
         EXPECT_DOUBLE_EQ(quad_max->second, -0.5);
+
+        // check energy is scaled by the same factor
+        Sample<std::string> sample{ {"a", 1}, {"b", 1} };
+        EXPECT_DOUBLE_EQ(bqm.energy(sample), -0.25);
     }
 
     static void test_DenseBQMFunctionTest_fix_variable()
@@ -699,6 +911,40 @@ struct BQMTester{
         EXPECT_EQ(bqm.contains("a"), false);
     }
 
+    static void test_DenseBQMFunctionTest_fix_variables()
+    {
+        Linear<uint32_t, double> linear{ {1, 1.0}, {2, -2.0}, {3, 3.0}, {4, 4.0}, {5, 0.5}, {6, 0.0} };
+        Quadratic<uint32_t, double> quadratic
+        {
+            {std::make_pair(1, 2), 12.0}, {std::make_pair(1, 3), -13.0}, {std::make_pair(1, 4), 14.0},
+            {std::make_pair(2, 3), 23.0}, {std::make_pair(2, 4), -24.0}, {std::make_pair(4, 5), 45.0},
+            {std::make_pair(3, 6), 1.5}
+        };
+        double offset = 0.5;
+        Vartype vartype = Vartype::BINARY;
+
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, offset, vartype);
+        Sample<uint32_t> sample{ {1, 1}, {2, 0}, {3, 0}, {4, 1}, {5, 1}, {6, 1} };
+        double en = bqm.energy(sample);
+
+        bqm.fix_variables({ {4, 1}, {1, 1}, {3, 0} });
+        sample.erase(1);
+        sample.erase(3);
+        sample.erase(4);
+
+        // 6 is left without any interaction and linear bias
+        EXPECT_EQ(bqm.contains(6), false);
+        sample.erase(6);
+
+        EXPECT_EQ(bqm.get_num_variables(), 2);
+        EXPECT_DOUBLE_EQ(bqm.energy(sample), en);
+        EXPECT_DOUBLE_EQ(bqm.get_linear(2), -2.0 + 12.0 - 24.0);
+        EXPECT_DOUBLE_EQ(bqm.get_linear(5), 0.5 + 45.0);
+
+        EXPECT_THROW(bqm.fix_variables({ {2, 1}, {2, 1} }), std::runtime_error);
+        EXPECT_THROW(bqm.fix_variable(1, 1), std::out_of_range);
+    }
+
     static void test_DenseBQMFunctionTest_flip_variable()
     {
         Linear<uint32_t, double> linear{{1, 1.0}, {2, 2.0} };
@@ -738,6 +984,41 @@ struct BQMTester{
         EXPECT_DOUBLE_EQ(bqm.get_offset(), 1.5);
     }
 
+    static void test_DenseBQMFunctionTest_flip_variable_binary_energy()
+    {
+        // the linear bias of 6 is zero, so it is not stored in a sparse matrix until 3 is flipped
+        Linear<uint32_t, double> linear{ {1, 1.0}, {2, -2.0}, {3, 3.0}, {4, 4.0}, {5, 0.5}, {6, 0.0} };
+        Quadratic<uint32_t, double> quadratic
+        {
+            {std::make_pair(1, 2), 12.0}, {std::make_pair(1, 3), -13.0}, {std::make_pair(1, 4), 14.0},
+            {std::make_pair(2, 3), 23.0}, {std::make_pair(2, 4), -24.0}, {std::make_pair(4, 5), 45.0},
+            {std::make_pair(3, 6), 36.0}
+        };
+        double offset = 0.5;
+        Vartype vartype = Vartype::BINARY;
+
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, offset, vartype);
+        Sample<uint32_t> sample{ {1, 1}, {2, 0}, {3, 1}, {4, 0}, {5, 1}, {6, 1} };
+        double en = bqm.energy(sample);
+
+        // E'(x) = E(x with v flipped)
+        for(uint32_t v : {3, 1, 4, 5, 2, 6, 3})
+        {
+            bqm.flip_variable(v);
+            sample[v] = 1 - sample[v];
+            EXPECT_DOUBLE_EQ(bqm.energy(sample), en);
+            if constexpr (std::is_same_v<DataType, Dense> || std::is_same_v<DataType, Sparse>)
+            {
+                // the column index of the sparse matrix follows the flips
+                for(const auto &[u, bias] : bqm.neighbors(v))
+                {
+                    EXPECT_DOUBLE_EQ(bias, bqm.get_quadratic(u, v));
+                }
+            }
+        }
+        EXPECT_EQ(bqm.get_vartype(), Vartype::BINARY);
+    }
+
     // currently disabled
     //static void test_DenseBQMFunctionTest_contract_variables()
     //{
@@ -799,6 +1080,89 @@ struct BQMTester{
 
     }
 
+    static void test_DenseBQMFunctionTest_change_vartype_view()
+    {
+        // variable 3 has no linear bias
+        Linear<uint32_t, double> linear{{0, 1.0}, {1, -1.0}, {2, 0.5} };
+        Quadratic<uint32_t, double> quadratic{ {std::make_pair(0, 1), 0.5}, {std::make_pair(1, 2), 1.5}, {std::make_pair(2, 3), -2.0} };
+        double offset = 1.4;
+        Vartype vartype = Vartype::SPIN;
+
+        BQM<uint32_t, double, DataType> bqm(linear, Quadratic<uint32_t, double>{}, offset, vartype);
+        bqm.add_interactions_from(quadratic);
+        auto view = bqm.change_vartype_view(Vartype::BINARY);
+        auto bqm_binary = bqm.change_vartype(Vartype::BINARY, false);
+        EXPECT_EQ(view.get_vartype(), Vartype::BINARY);
+        EXPECT_EQ(bqm.get_vartype(), Vartype::SPIN);
+
+        std::vector<Sample<uint32_t>> samples;
+        for(int32_t k = 0; k < 16; k++)
+        {
+            samples.push_back({ {0, k & 1}, {1, (k >> 1) & 1}, {2, (k >> 2) & 1}, {3, (k >> 3) & 1} });
+        }
+        std::vector<double> en_view = view.energies(samples);
+        for(size_t k = 0; k < samples.size(); k++)
+        {
+            EXPECT_NEAR(view.energy(samples[k]), bqm_binary.energy(samples[k]), 1e-10);
+            EXPECT_NEAR(en_view[k], bqm_binary.energy(samples[k]), 1e-10);
+        }
+
+        // in-place conversion and back restores the model
+        bqm.change_vartype(Vartype::BINARY);
+        EXPECT_NEAR(bqm.get_linear().at(3), 4.0, 1e-10);
+        bqm.change_vartype(Vartype::SPIN);
+        auto lin = bqm.get_linear();
+        auto quad = bqm.get_quadratic();
+        EXPECT_NEAR(lin[0], 1.0, 1e-10);
+        EXPECT_NEAR(lin[1], -1.0, 1e-10);
+        EXPECT_NEAR(lin[2], 0.5, 1e-10);
+        EXPECT_NEAR(lin[3], 0.0, 1e-10);
+        EXPECT_NEAR(quad[std::make_pair(2, 3)], -2.0, 1e-10);
+        EXPECT_NEAR(bqm.get_offset(), 1.4, 1e-10);
+    }
+
+    static void test_DenseBQMFunctionTest_label_table()
+    {
+        LabelTable<std::string> table(std::vector<std::string>{"c", "a", "b"});
+        EXPECT_EQ(table.intern("a"), 1u);
+        EXPECT_EQ(table.intern("d"), 3u);
+        EXPECT_EQ(table.label(0), "c");
+        EXPECT_EQ(table.size(), 4u);
+
+        // two models sharing the ids of the table
+        BQM<std::string, double, DataType> bqm(table, Vartype::SPIN);
+        BQM<std::string, double, DataType> bqm2(table, Vartype::SPIN);
+        for(const auto &label : table.labels())
+        {
+            EXPECT_EQ(bqm.get_id(label), table.id(label));
+            EXPECT_EQ(bqm2.get_id(label), table.id(label));
+        }
+        EXPECT_EQ(bqm.get_variables(), (std::vector<std::string>{"a", "b", "c", "d"}));
+
+        bqm.add_variable_id(table.id("a"), -1.0);
+        bqm.add_variable_id(table.id("d"), 0.5);
+        bqm.add_interaction_id(table.id("b"), table.id("c"), 2.0);
+        bqm.add_interaction_id(table.id("d"), table.id("a"), -1.5);
+        bqm.add_offset(0.25);
+
+        EXPECT_DOUBLE_EQ(bqm.get_linear("a"), -1.0);
+        EXPECT_DOUBLE_EQ(bqm.get_linear_id(table.id("d")), 0.5);
+        EXPECT_DOUBLE_EQ(bqm.get_quadratic("c", "b"), 2.0);
+        EXPECT_DOUBLE_EQ(bqm.get_quadratic_id(table.id("a"), table.id("d")), -1.5);
+        EXPECT_EQ(bqm.get_label(table.id("b")), "b");
+
+        std::vector<int32_t> state{1, -1, 1, -1};
+        Sample<std::string> sample;
+        for(LabelId id = 0; id < state.size(); id++)
+        {
+            sample[table.label(id)] = state[id];
+        }
+        EXPECT_DOUBLE_EQ(bqm.energy_ids(state), bqm.energy(sample));
+        EXPECT_DOUBLE_EQ(bqm.energy_ids(state), 0.25 + 1.0 - 0.5 + 2.0 - 1.5);
+        EXPECT_THROW(bqm.get_linear_id(4), std::out_of_range);
+        EXPECT_THROW(bqm.energy_ids({1, 1}), std::runtime_error);
+    }
+
     static void test_DenseBQMFunctionTest_to_serializable()
     {
         Linear<std::string, double> linear{ {"c", -1.0}, {"d", 1.0} };
@@ -833,5 +1197,650 @@ struct BQMTester{
         EXPECT_EQ(bqm2.get_offset(), bqm.get_offset());
         EXPECT_EQ(bqm_linear["c"], linear["c"]);
         EXPECT_EQ(bqm_quadratic[std::make_pair("b", "e")], quadratic[std::make_pair("b", "e")]);
+
+        if constexpr (std::is_same_v<DataType, Sparse>)
+        {
+            // interactions not in (head, tail) order
+            std::reverse(j["quadratic_head"].begin(), j["quadratic_head"].end());
+            std::reverse(j["quadratic_tail"].begin(), j["quadratic_tail"].end());
+            std::reverse(j["quadratic_biases"].begin(), j["quadratic_biases"].end());
+            std::swap(j["quadratic_head"][0], j["quadratic_tail"][0]);
+            BQM<std::string, double, DataType> bqm3 = BQM<std::string, double, DataType>::from_serializable(j);
+            EXPECT_EQ(bqm3.get_quadratic(), bqm.get_quadratic());
+            EXPECT_EQ(bqm3.get_linear(), bqm.get_linear());
+        }
+
+        if constexpr (std::is_same_v<DataType, Sparse> || std::is_same_v<DataType, PackedDense>)
+        {
+            // malformed documents raise exceptions, also from the parallel conversion
+            json malformed = bqm.to_serializable();
+            malformed["quadratic_head"][1] = "a";
+            EXPECT_THROW((BQM<std::string, double, DataType>::from_serializable(malformed)), json::exception);
+            malformed = bqm.to_serializable();
+            malformed["quadratic_tail"][0] = 100;
+            EXPECT_THROW((BQM<std::string, double, DataType>::from_serializable(malformed)), std::runtime_error);
+            malformed = bqm.to_serializable();
+            malformed["quadratic_tail"][0] = malformed["quadratic_head"][0];
+            EXPECT_THROW((BQM<std::string, double, DataType>::from_serializable(malformed)), std::runtime_error);
+        }
+    }
+
+    static void test_DenseBQMFunctionTest_save_load()
+    {
+        Linear<std::string, double> linear{ {"c", -1.0}, {"a", 0.5}, {"e", 0.0} };
+        Quadratic<std::string, double> quadratic{ {std::make_pair("a", "d"), 2.0}, {std::make_pair("e", "b"), 5.0}, {std::make_pair("c", "a"), -3.0} };
+        double offset = 1.5;
+        Vartype vartype = Vartype::BINARY;
+
+        BQM<std::string, double, DataType> bqm(linear, quadratic, offset, vartype);
+        // out-of-order insertion
+        bqm.add_variable("0", 0.25);
+        bqm.add_interaction("0", "e", -1.0);
+
+        const std::string path = testing::TempDir() + "cimod_save_load.bin";
+        bqm.save(path);
+
+        auto check = [&](const auto &loaded)
+        {
+            EXPECT_EQ(loaded.get_variables(), bqm.get_variables());
+            EXPECT_EQ(loaded.get_vartype(), bqm.get_vartype());
+            EXPECT_DOUBLE_EQ(loaded.get_offset(), bqm.get_offset());
+            for(const auto &it : bqm.get_linear())
+            {
+                EXPECT_DOUBLE_EQ(loaded.get_linear(it.first), it.second);
+            }
+            for(const auto &it : bqm.get_quadratic())
+            {
+                EXPECT_DOUBLE_EQ(loaded.get_quadratic(it.first.first, it.first.second), it.second);
+            }
+            EXPECT_EQ(loaded.get_quadratic().size(), bqm.get_quadratic().size());
+        };
+        check(BQM<std::string, double, DataType>::load(path));
+        // payloads are interchangeable between the data types
+        check(BQM<std::string, double, Dense>::load(path));
+        check(BQM<std::string, double, Sparse>::load(path));
+        check(BQM<std::string, double, PackedDense>::load(path));
+        check(BQM<std::string, double, Dict>::load(path));
+
+        // the bias type of the file is converted
+        auto loaded_f = BQM<std::string, float, DataType>::load(path);
+        EXPECT_FLOAT_EQ(loaded_f.get_linear("a"), 0.5f);
+        EXPECT_FLOAT_EQ(loaded_f.get_quadratic("b", "e"), 5.0f);
+
+        // labels of another type are rejected
+        EXPECT_THROW((BQM<uint32_t, double, DataType>::load(path)), std::runtime_error);
+        std::remove(path.c_str());
+        EXPECT_THROW((BQM<std::string, double, DataType>::load(path)), std::runtime_error);
+    }
+
+    static void test_DenseBQMFunctionTest_text_io()
+    {
+        const std::string path = testing::TempDir() + "cimod_text_io.txt";
+        auto write_file = [&](const std::string &content)
+        {
+            std::ofstream ofs(path, std::ios::binary);
+            ofs << content;
+        };
+
+        // qbsolv format with comments, CRLF and unordered entries
+        write_file("c test problem\r\np qubo 0 6 3 2\r\n0 0 -1.5\n5 5 +2\n3 3 0.25\nc couplers\n0 5 1e-1\n  5 3 -3\nc offset = 0.5\n");
+        const auto triplets = io::read_qubo<uint32_t, double>(path);
+        BQM<uint32_t, double, DataType> bqm = triplets.template to_bqm<DataType>();
+        EXPECT_EQ(bqm.get_vartype(), Vartype::BINARY);
+        EXPECT_EQ(bqm.get_variables(), (std::vector<uint32_t>{0, 3, 5}));
+        EXPECT_DOUBLE_EQ(bqm.get_offset(), 0.5);
+        EXPECT_DOUBLE_EQ(bqm.get_linear(5), 2.0);
+        EXPECT_DOUBLE_EQ(bqm.get_quadratic(0, 5), 0.1);
+        EXPECT_DOUBLE_EQ(bqm.get_quadratic(3, 5), -3.0);
+
+        // the result does not depend on the chunk size
+        io::TextReadOptions options;
+        options.chunk_size = 5;
+        const auto chunked = io::read_qubo<uint32_t, double>(path, options);
+        EXPECT_EQ(chunked.row, triplets.row);
+        EXPECT_EQ(chunked.col, triplets.col);
+        EXPECT_EQ(chunked.bias, triplets.bias);
+
+        write_file("p qubo 0 6 3 2\n0 0 -1.5\n0 5 1.0\n");
+        EXPECT_THROW((io::read_qubo<uint32_t, double>(path)), std::runtime_error);
+        write_file("p qubo 0 6 1 0\n0 0 -1.5 x\n");
+        EXPECT_THROW((io::read_qubo<uint32_t, double>(path)), std::runtime_error);
+
+        // round trips of a SPIN model
+        Linear<uint32_t, double> linear{ {3, -1.0}, {0, 0.5}, {5, 0.0}, {1, 2.0} };
+        Quadratic<uint32_t, double> quadratic{ {std::make_pair(0, 3), 2.0}, {std::make_pair(5, 1), 5.0}, {std::make_pair(3, 1), -3.0} };
+        BQM<uint32_t, double, DataType> spin_bqm(linear, quadratic, 0.5, Vartype::SPIN);
+
+        io::write_qubo(path, spin_bqm);
+        BQM<uint32_t, double, DataType> qubo_bqm = io::read_qubo<uint32_t, double>(path).template to_bqm<DataType>();
+        EXPECT_EQ(qubo_bqm.get_vartype(), Vartype::BINARY);
+        for(int32_t k = 0; k < 16; k++)
+        {
+            Sample<uint32_t> spins, binaries;
+            for(size_t i = 0; i < spin_bqm.get_variables().size(); i++)
+            {
+                binaries[spin_bqm.get_variables()[i]] = (k >> i) & 1;
+                spins[spin_bqm.get_variables()[i]] = 2 * ((k >> i) & 1) - 1;
+            }
+            EXPECT_NEAR(qubo_bqm.energy(binaries), spin_bqm.energy(spins), 1e-10);
+        }
+
+        auto check = [&](BQM<uint32_t, double, DataType> loaded)
+        {
+            EXPECT_EQ(loaded.get_vartype(), Vartype::SPIN);
+            EXPECT_EQ(loaded.get_variables(), spin_bqm.get_variables());
+            EXPECT_DOUBLE_EQ(loaded.get_offset(), 0.5);
+            for(const auto &it : linear)
+            {
+                EXPECT_DOUBLE_EQ(loaded.get_linear(it.first), it.second);
+            }
+            for(const auto &it : quadratic)
+            {
+                EXPECT_DOUBLE_EQ(loaded.get_quadratic(it.first.first, it.first.second), it.second);
+            }
+        };
+        io::write_coo(path, spin_bqm);
+        check(io::read_coo<uint32_t, double>(path).template to_bqm<DataType>());
+        EXPECT_THROW((io::read_coo<uint32_t, double>(path, Vartype::BINARY)), std::runtime_error);
+        io::write_bqpjson(path, spin_bqm);
+        check(io::read_bqpjson<uint32_t, double>(path).template to_bqm<DataType>());
+
+        // non-finite values are not valid JSON, so they are not written
+        for(const double value : {std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity()})
+        {
+            BQM<uint32_t, double, DataType> bad_offset(linear, quadratic, value, Vartype::SPIN);
+            EXPECT_THROW(io::write_bqpjson(path, bad_offset), std::runtime_error);
+            BQM<uint32_t, double, DataType> bad_linear(linear, quadratic, 0.5, Vartype::SPIN);
+            bad_linear.add_variable(3, value);
+            EXPECT_THROW(io::write_bqpjson(path, bad_linear), std::runtime_error);
+            BQM<uint32_t, double, DataType> bad_quadratic(linear, quadratic, 0.5, Vartype::SPIN);
+            bad_quadratic.add_interaction(0, 1, -value);
+            EXPECT_THROW(io::write_bqpjson(path, bad_quadratic), std::runtime_error);
+        }
+        check(io::read_bqpjson<uint32_t, double>(path).template to_bqm<DataType>());
+
+        std::remove(path.c_str());
+        EXPECT_THROW((io::read_coo<uint32_t, double>(path)), std::runtime_error);
+    }
+
+    static void test_DenseBQMFunctionTest_mapped()
+    {
+        Linear<uint32_t, double> linear{ {3, -1.0}, {0, 0.5}, {5, 0.0}, {1, 2.0} };
+        Quadratic<uint32_t, double> quadratic{ {std::make_pair(0, 3), 2.0}, {std::make_pair(5, 1), 5.0}, {std::make_pair(3, 1), -3.0}, {std::make_pair(0, 5), 1.5} };
+
+        for(Vartype vartype : {Vartype::SPIN, Vartype::BINARY})
+        {
+            BQM<uint32_t, double, DataType> bqm(linear, quadratic, 0.5, vartype);
+            const std::string path = testing::TempDir() + "cimod_mapped.bin";
+            bqm.save(path);
+
+            const MappedBinaryQuadraticModel<uint32_t, double> mapped(path);
+            EXPECT_EQ(mapped.get_variables(), bqm.get_variables());
+            EXPECT_EQ(mapped.get_num_interactions(), quadratic.size());
+            EXPECT_EQ(mapped.get_vartype(), vartype);
+            EXPECT_DOUBLE_EQ(mapped.get_offset(), 0.5);
+            EXPECT_EQ(mapped.get_linear().size(), bqm.get_variables().size());
+            for(const auto &it : bqm.get_linear())
+            {
+                EXPECT_DOUBLE_EQ(mapped.get_linear(it.first), it.second);
+            }
+            EXPECT_EQ(mapped.get_quadratic(), bqm.get_quadratic());
+            EXPECT_DOUBLE_EQ(mapped.get_quadratic(1, 5), 5.0);
+            EXPECT_DOUBLE_EQ(mapped.get_quadratic(3, 5), 0.0);
+            EXPECT_THROW(mapped.get_linear(2), std::out_of_range);
+
+            std::vector<std::pair<uint32_t, double>> neighbors;
+            mapped.for_each_neighbor(5, [&](uint32_t u, double bias) { neighbors.emplace_back(u, bias); });
+            std::vector<std::pair<uint32_t, double>> expected{ {0, 1.5}, {1, 5.0} };
+            EXPECT_EQ(neighbors, expected);
+            EXPECT_EQ(mapped.degree(3), 2);
+
+            std::vector<Sample<uint32_t>> samples;
+            std::vector<int32_t> flat;
+            for(int32_t k = 0; k < 16; k++)
+            {
+                Sample<uint32_t> sample;
+                for(size_t i = 0; i < bqm.get_variables().size(); i++)
+                {
+                    int32_t s = ((k >> i) & 1) ? 1 : (vartype == Vartype::SPIN ? -1 : 0);
+                    sample[bqm.get_variables()[i]] = s;
+                    flat.push_back(s);
+                }
+                samples.push_back(sample);
+            }
+            const std::vector<double> en = bqm.energies(samples);
+            const std::vector<double> en_mapped = mapped.energies(samples);
+            const std::vector<double> en_flat = mapped.energies(flat.data(), samples.size());
+            for(size_t k = 0; k < samples.size(); k++)
+            {
+                EXPECT_DOUBLE_EQ(mapped.energy(samples[k]), en[k]);
+                EXPECT_DOUBLE_EQ(en_mapped[k], en[k]);
+                EXPECT_DOUBLE_EQ(en_flat[k], en[k]);
+            }
+
+            const auto qubo = bqm.to_qubo();
+            const auto qubo_mapped = mapped.to_qubo();
+            EXPECT_DOUBLE_EQ(std::get<1>(qubo_mapped), std::get<1>(qubo));
+            for(const auto &it : std::get<0>(qubo))
+            {
+                EXPECT_DOUBLE_EQ(std::get<0>(qubo_mapped).at(it.first), it.second);
+            }
+            const auto ising = bqm.to_ising();
+            const auto ising_mapped = mapped.to_ising();
+            EXPECT_DOUBLE_EQ(std::get<2>(ising_mapped), std::get<2>(ising));
+            for(const auto &it : std::get<0>(ising))
+            {
+                EXPECT_DOUBLE_EQ(std::get<0>(ising_mapped).at(it.first), it.second);
+            }
+            for(const auto &it : std::get<1>(ising))
+            {
+                EXPECT_DOUBLE_EQ(std::get<1>(ising_mapped).at(it.first), it.second);
+            }
+            std::remove(path.c_str());
+        }
+    }
+
+    static void test_DenseBQMFunctionTest_consistency_with_dense()
+    {
+        Linear<uint32_t, double> linear;
+        Quadratic<uint32_t, double> quadratic;
+        for(uint32_t i = 0; i < 40; i++)
+        {
+            linear[(i * 13) % 40] = 0.1 * i - 1.5;
+            quadratic[std::make_pair(i, (i * 7 + 3) % 40)] = 0.5 * i - 3.0;
+            quadratic[std::make_pair((i * 11 + 5) % 40, i)] = 0.25 * i - 2.0;
+        }
+        double offset = 0.5;
+        Vartype vartype = Vartype::SPIN;
+
+        BQM<uint32_t, double, DataType> bqm(Linear<uint32_t, double>{}, Quadratic<uint32_t, double>{}, offset, vartype);
+        BQM<uint32_t, double, Dense> bqm_ref(Linear<uint32_t, double>{}, Quadratic<uint32_t, double>{}, offset, vartype);
+        // insert in descending order so that the labels are not sorted
+        for(uint32_t i = 40; i > 0; i--)
+        {
+            bqm.add_variable(i - 1, linear[i - 1]);
+            bqm_ref.add_variable(i - 1, linear[i - 1]);
+        }
+        bqm.add_interactions_from(quadratic);
+        bqm_ref.add_interactions_from(quadratic);
+
+        auto check = [&]()
+        {
+            EXPECT_EQ(bqm.get_variables(), bqm_ref.get_variables());
+            typename BQM<uint32_t, double, DataType>::DenseMatrix mat = bqm.interaction_matrix();
+            typename BQM<uint32_t, double, Dense>::DenseMatrix mat_ref = bqm_ref.interaction_matrix();
+            EXPECT_NEAR((mat - mat_ref).norm(), 0.0, 1e-10);
+            EXPECT_NEAR(bqm.get_offset(), bqm_ref.get_offset(), 1e-10);
+
+            Sample<uint32_t> sample;
+            for(uint32_t v : bqm.get_variables())
+            {
+                sample[v] = (v % 3 == 0) ? (vartype == Vartype::SPIN ? -1 : 0) : 1;
+            }
+            EXPECT_NEAR(bqm.energy(sample), bqm_ref.energy(sample), 1e-10);
+        };
+        check();
+
+        bqm.flip_variable(7);
+        bqm_ref.flip_variable(7);
+        check();
+
+        vartype = Vartype::BINARY;
+        bqm.change_vartype(vartype);
+        bqm_ref.change_vartype(vartype);
+        check();
+
+        bqm.flip_variable(11);
+        bqm_ref.flip_variable(11);
+        check();
+
+        std::vector<std::pair<uint32_t, int32_t>> fixed{ {3, 1}, {30, 0}, {17, 1} };
+        bqm.fix_variables(fixed);
+        bqm_ref.fix_variables(fixed);
+        check();
+
+        bqm.remove_variables_from({ 0, 39, 21 });
+        bqm_ref.remove_variables_from({ 0, 39, 21 });
+        check();
+
+        bqm.normalize(std::make_pair(-1.0, 1.0));
+        bqm_ref.normalize(std::make_pair(-1.0, 1.0));
+        check();
+
+        // round trip through the serializable object
+        BQM<uint32_t, double, DataType> bqm2 = BQM<uint32_t, double, DataType>::from_serializable(bqm.to_serializable());
+        typename BQM<uint32_t, double, DataType>::DenseMatrix mat2 = bqm2.interaction_matrix();
+        typename BQM<uint32_t, double, Dense>::DenseMatrix mat_ref = bqm_ref.interaction_matrix();
+        EXPECT_NEAR((mat2 - mat_ref).norm(), 0.0, 1e-10);
+    }
+
+    static void test_DenseBQMFunctionTest_float_precision()
+    {
+        Linear<uint32_t, double> linear;
+        Quadratic<uint32_t, double> quadratic;
+        Linear<uint32_t, float> linear_f;
+        Quadratic<uint32_t, float> quadratic_f;
+        const uint32_t num_variables = 3000;
+        for(uint32_t i = 0; i < num_variables; i++)
+        {
+            float h = 0.1f * (i % 7) - 0.3f;
+            float J = 0.01f * (i % 11) + 0.1f;
+            linear[i] = h;
+            linear_f[i] = h;
+            quadratic[std::make_pair(i, (i + 1) % num_variables)] = J;
+            quadratic_f[std::make_pair(i, (i + 1) % num_variables)] = J;
+        }
+
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, 0.5, Vartype::SPIN);
+        BQM<uint32_t, float, DataType> bqm_f(linear_f, quadratic_f, 0.5f, Vartype::SPIN);
+
+        Sample<uint32_t> sample;
+        for(uint32_t i = 0; i < num_variables; i++)
+        {
+            sample[i] = (i % 3 == 0) ? -1 : +1;
+        }
+        double en = bqm.energy(sample);
+        EXPECT_NEAR(bqm_f.energy(sample), en, 1e-6 * std::abs(en));
+        EXPECT_NEAR(bqm_f.energies({ sample })[0], en, 1e-6 * std::abs(en));
+
+        // conversions
+        bqm.change_vartype(Vartype::BINARY);
+        bqm_f.change_vartype(Vartype::BINARY);
+        EXPECT_NEAR(bqm_f.get_offset(), bqm.get_offset(), 1e-6 * std::abs(bqm.get_offset()));
+        for(uint32_t i = 0; i < num_variables; i++)
+        {
+            sample[i] = (sample[i] + 1) / 2;
+        }
+        en = bqm.energy(sample);
+        EXPECT_NEAR(bqm_f.energy(sample), en, 1e-6 * std::abs(en));
+
+        json j = bqm_f.to_serializable();
+        EXPECT_EQ(j["bias_type"], "float32");
+    }
+
+    static void test_DenseBQMFunctionTest_neighbors()
+    {
+        Linear<uint32_t, double> linear{ {0, 1.0}, {1, -1.0}, {2, 0.5}, {3, 0.0}, {4, 2.0} };
+        Quadratic<uint32_t, double> quadratic{ {std::make_pair(0, 2), 2.0}, {std::make_pair(4, 2), -3.0}, {std::make_pair(1, 2), 1.5}, {std::make_pair(3, 0), 0.5} };
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, 0.0, Vartype::SPIN);
+
+        auto check = [&bqm]()
+        {
+            Adjacency<uint32_t, double> expected;
+            for(const auto &v : bqm.get_variables())
+            {
+                expected[v];
+            }
+            for(const auto &it : bqm.get_quadratic())
+            {
+                if(it.second != 0)
+                {
+                    expected[it.first.first][it.first.second] = it.second;
+                    expected[it.first.second][it.first.first] = it.second;
+                }
+            }
+            EXPECT_EQ(bqm.get_adjacency(), expected);
+            for(const auto &v : bqm.get_variables())
+            {
+                std::unordered_map<uint32_t, double> adjacent;
+                for(const auto &[u, bias] : bqm.neighbors(v))
+                {
+                    EXPECT_TRUE(adjacent.emplace(u, bias).second);
+                }
+                EXPECT_EQ(adjacent, expected[v]);
+                EXPECT_EQ(bqm.degree(v), expected[v].size());
+            }
+        };
+
+        check();
+        EXPECT_EQ(bqm.degree(2), 3);
+        EXPECT_EQ(bqm.degree(3), 1);
+
+        // the column index of the sparse matrix follows the changes of the model
+        bqm.add_interaction(3, 4, 1.0);
+        bqm.add_interaction(5, 1, -2.0);
+        check();
+        bqm.remove_interaction(0, 3);
+        check();
+        EXPECT_EQ(bqm.degree(0), 1);
+        bqm.scale(2.0);
+        check();
+        bqm.flip_variable(2);
+        check();
+        bqm.change_vartype(Vartype::BINARY);
+        check();
+        bqm.flip_variable(4);
+        check();
+        bqm.fix_variable(2, 1);
+        check();
+        EXPECT_THROW(bqm.neighbors(2), std::out_of_range);
+
+        // concurrent const calls build the column index once; a copy builds its own index
+        bqm.add_interaction(0, 5, 0.5);
+        const BQM<uint32_t, double, DataType> copied = bqm;
+        std::vector<size_t> degrees(8);
+        std::vector<std::thread> threads;
+        for(size_t t = 0; t < degrees.size(); t++)
+        {
+            threads.emplace_back([&copied, &degrees, t]() { degrees[t] = copied.degree(5); });
+        }
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+        EXPECT_EQ(degrees, std::vector<size_t>(degrees.size(), 2));
+        EXPECT_EQ(bqm.degree(5), 2);
+    }
+
+    static void test_DenseBQMFunctionTest_version()
+    {
+        BQM<uint32_t, double, DataType> bqm(Linear<uint32_t, double>{ {0, 1.0}, {1, -1.0} }, Quadratic<uint32_t, double>{ {std::make_pair(0, 1), 2.0} }, 0.0, Vartype::SPIN);
+
+        uint64_t version = bqm.get_version();
+        auto expect_changed = [&bqm, &version](bool changed)
+        {
+            EXPECT_EQ(bqm.get_version() != version, changed);
+            version = bqm.get_version();
+        };
+
+        bqm.get_linear();
+        bqm.get_quadratic();
+        bqm.energy({ {0, 1}, {1, -1} });
+        expect_changed(false);
+        bqm.add_variable(2, 0.5);
+        expect_changed(true);
+        bqm.add_interaction(1, 2, 1.0);
+        expect_changed(true);
+        bqm.add_offset(1.0);
+        expect_changed(true);
+        bqm.scale(2.0);
+        expect_changed(true);
+        bqm.flip_variable(0);
+        expect_changed(true);
+        bqm.change_vartype(Vartype::BINARY);
+        expect_changed(true);
+        bqm.fix_variable(2, 1);
+        expect_changed(true);
+        bqm.remove_interaction(0, 1);
+        expect_changed(true);
+        bqm.remove_variable(1);
+        expect_changed(true);
+    }
+
+    static void test_DenseBQMFunctionTest_interaction_matrix_ref()
+    {
+        BQM<uint32_t, double, DataType> bqm(Linear<uint32_t, double>{}, Quadratic<uint32_t, double>{}, 0.5, Vartype::SPIN);
+        for(uint32_t i = 20; i > 0; i--)
+        {
+            bqm.add_interaction(i, (i * 7) % 20 + 1, 0.1 * i);
+            bqm.add_variable(i, -0.2 * i);
+        }
+        const typename BQM<uint32_t, double, DataType>::DenseMatrix mat = bqm.interaction_matrix();
+        const auto linear = bqm.get_linear();
+        const auto quadratic = bqm.get_quadratic();
+
+        // the model is rearranged into the form of interaction_matrix() without changing the biases
+        const auto &ref = bqm.interaction_matrix_ref();
+        EXPECT_EQ(ref.rows(), 21);
+        EXPECT_DOUBLE_EQ((typename BQM<uint32_t, double, DataType>::DenseMatrix(ref) - mat).norm(), 0.0);
+        EXPECT_EQ(bqm.get_linear(), linear);
+        EXPECT_EQ(bqm.get_quadratic(), quadratic);
+        for(uint32_t i = 1; i <= 20; i++)
+        {
+            EXPECT_EQ(bqm.get_id(i), i - 1);
+        }
+
+        // the reference aliases the storage of the model
+        EXPECT_EQ(&bqm.interaction_matrix_ref(), &ref);
+        bqm.add_interaction(1, 2, 1.0);
+        EXPECT_DOUBLE_EQ(bqm.interaction_matrix_ref().coeff(0, 1), mat(0, 1) + 1.0);
+    }
+    static void test_DenseBQMFunctionTest_adjacency()
+    {
+        Linear<uint32_t, double> linear{ {0, 1.0}, {1, -1.0}, {2, 0.5}, {3, 0.0}, {4, 2.0}, {6, 0.0} };
+        Quadratic<uint32_t, double> quadratic{ {std::make_pair(0, 2), 2.0}, {std::make_pair(4, 2), -3.0}, {std::make_pair(1, 2), 1.5}, {std::make_pair(3, 0), 0.5}, {std::make_pair(5, 6), 1.0} };
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, 0.0, Vartype::SPIN);
+
+        // the adjacency list follows every change of the quadratic biases
+        auto check = [&bqm]()
+        {
+            Adjacency<uint32_t, double> expected;
+            for(const auto &it : bqm.get_quadratic())
+            {
+                expected[it.first.first][it.first.second] = it.second;
+                expected[it.first.second][it.first.first] = it.second;
+            }
+            EXPECT_EQ(bqm.get_adjacency(), expected);
+            for(const auto &v : bqm.get_variables())
+            {
+                EXPECT_EQ(bqm.degree(v), expected[v].size());
+            }
+        };
+
+        check();
+        EXPECT_EQ(bqm.degree(2), 3);
+        bqm.add_interaction(3, 4, 1.0);
+        check();
+        bqm.scale(2.0);
+        check();
+        bqm.flip_variable(2);
+        check();
+        bqm.contract_variables(0, 4);
+        check();
+        EXPECT_FALSE(bqm.contains(4));
+        EXPECT_DOUBLE_EQ(bqm.get_quadratic(0, 2), 2.0 * (-2.0 + 3.0));
+
+        // removing the only interaction of 5 and 6 removes both variables, since their linear biases are zero
+        bqm.remove_interaction(5, 6);
+        check();
+        EXPECT_FALSE(bqm.contains(5));
+        EXPECT_FALSE(bqm.contains(6));
+        bqm.change_vartype(Vartype::BINARY);
+        check();
+        bqm.flip_variable(0);
+        check();
+        bqm.fix_variable(2, 1);
+        check();
+        EXPECT_EQ(bqm.degree(2), 0);
+        bqm.remove_variable(0);
+        check();
+        EXPECT_TRUE(bqm.get_adjacency().empty());
+    }
+
+    static void test_DenseBQMFunctionTest_energy_validation()
+    {
+        Linear<uint32_t, double> linear{ {0, 1.0}, {1, -1.0}, {2, 0.5} };
+        Quadratic<uint32_t, double> quadratic{ {std::make_pair(0, 1), 2.0}, {std::make_pair(1, 2), -1.5} };
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, 0.25, Vartype::SPIN);
+
+        // repeated interactions are accumulated with a single lookup
+        bqm.add_interaction(1, 0, 0.5);
+        bqm.add_interaction(2, 3, 1.0);
+        bqm.add_variable(3, -0.5);
+        EXPECT_DOUBLE_EQ(bqm.get_quadratic(0, 1), 2.5);
+        EXPECT_DOUBLE_EQ(bqm.get_linear(3), -0.5);
+
+        Sample<uint32_t> sample{ {0, 1}, {1, -1}, {2, -1}, {3, 1} };
+        const double expected = 0.25 + 1.0 + 1.0 - 0.5 - 0.5 - 2.5 - 1.5 - 1.0;
+        EXPECT_DOUBLE_EQ(bqm.energy(sample), expected);
+        EXPECT_DOUBLE_EQ(bqm.energy(sample, false), expected);
+        EXPECT_EQ(bqm.energies({sample, sample}, false), std::vector<double>({expected, expected}));
+
+        // invalid values and missing variables are rejected before the accumulation
+        Sample<uint32_t> invalid = sample;
+        invalid[2] = 0;
+        EXPECT_THROW(bqm.energy(invalid), std::runtime_error);
+        EXPECT_THROW(bqm.energies({sample, invalid}), std::runtime_error);
+        invalid.erase(2);
+        EXPECT_THROW(bqm.energy(invalid), std::out_of_range);
+    }
+
+    static void test_DenseBQMFunctionTest_energies_samples()
+    {
+        Linear<uint32_t, double> linear{ {0, 1.0}, {1, -1.0}, {2, 0.5}, {3, 0.0}, {4, 2.0} };
+        Quadratic<uint32_t, double> quadratic{ {std::make_pair(0, 2), 2.0}, {std::make_pair(2, 4), -3.0}, {std::make_pair(1, 3), 1.5}, {std::make_pair(0, 4), 0.0} };
+        BQM<uint32_t, double, DataType> bqm(linear, quadratic, -0.5, Vartype::BINARY);
+
+        // every binary sample, as samples and as a contiguous array in the order of get_variables()
+        std::vector<Sample<uint32_t>> samples;
+        std::vector<int8_t> array;
+        for(uint32_t bits = 0; bits < 32; bits++)
+        {
+            Sample<uint32_t> sample;
+            for(const auto &v : bqm.get_variables())
+            {
+                sample[v] = (bits >> v) & 1;
+                array.push_back((bits >> v) & 1);
+            }
+            samples.push_back(sample);
+        }
+
+        const std::vector<double> en_vec = bqm.energies(samples);
+        const std::vector<double> en_array = bqm.energies(array.data(), samples.size());
+        ASSERT_EQ(en_vec.size(), samples.size());
+        for(size_t k = 0; k < samples.size(); k++)
+        {
+            EXPECT_DOUBLE_EQ(en_vec[k], bqm.energy(samples[k]));
+            EXPECT_DOUBLE_EQ(en_array[k], bqm.energy(samples[k]));
+        }
+        EXPECT_EQ(bqm.energies(samples, false), en_vec);
+        EXPECT_TRUE(bqm.energies(std::vector<Sample<uint32_t>>()).empty());
+
+        // the error of the first invalid sample is rethrown after the parallel loop
+        samples[20][1] = -1;
+        samples[10].erase(3);
+        EXPECT_THROW(bqm.energies(samples), std::out_of_range);
+        samples[10][3] = 1;
+        EXPECT_THROW(bqm.energies(samples), std::runtime_error);
+        EXPECT_NO_THROW(bqm.energies(samples, false));
+    }
+
+    static void test_DenseBQMFunctionTest_concurrent_get_variables()
+    {
+        BQM<uint32_t, double, DataType> bqm(Linear<uint32_t, double>{ {5, 1.0}, {7, -1.0} }, Quadratic<uint32_t, double>{ {std::make_pair(5, 7), 2.0} }, 0.0, Vartype::SPIN);
+        // out-of-order insertion, so that the sorted labels are generated lazily
+        bqm.add_variable(1, 0.5);
+        bqm.add_interaction(3, 7, 1.0);
+        const std::vector<uint32_t> expected{1, 3, 5, 7};
+
+        // concurrent const calls generate the sorted labels once
+        std::vector<std::vector<uint32_t>> variables(8);
+        std::vector<std::thread> threads;
+        for(size_t t = 0; t < variables.size(); t++)
+        {
+            threads.emplace_back([&bqm, &variables, t]() { variables[t] = bqm.get_variables(); });
+        }
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+        for(const auto &it : variables)
+        {
+            EXPECT_EQ(it, expected);
+        }
+
+        // the cache is regenerated after the labels change
+        bqm.add_variable(2, 1.0);
+        EXPECT_EQ(bqm.get_variables(), (std::vector<uint32_t>{1, 2, 3, 5, 7}));
     }
 };
@@ -298,6 +298,77 @@ class ModelTest(unittest.TestCase):
             bqm.change_vartype("SPIN", inplace=False)
             self.assertEqual(bqm.vartype, cimod.BINARY)
 
+    def test_bqm_views(self):
+        for sparse in [True, False]:
+            bqm = cimod.model.BinaryQuadraticModel(
+                self.h, self.J, "SPIN", sparse=sparse
+            )
+            self.assertEqual(bqm.linear, bqm.get_linear())
+            self.assertEqual(bqm.quadratic, bqm.get_quadratic())
+            self.assertEqual(bqm.linear[1], -2)
+            self.assertEqual(bqm.quadratic[(1, 2)], -3)
+            self.assertEqual(bqm.quadratic[(2, 1)], -3)
+            self.assertNotIn(3, bqm.linear)
+            self.assertNotIn((0, 2), bqm.quadratic)
+            self.assertNotIn((0, 0), bqm.quadratic)
+            self.assertNotIn((0, 5), bqm.quadratic)
+            with self.assertRaises(KeyError):
+                bqm.quadratic[(0, 3)]
+
+            # the snapshots are reused until the model changes
+            version = bqm.get_version()
+            self.assertIs(bqm._snapshot("quadratic"), bqm._snapshot("quadratic"))
+            bqm.add_interaction(0, 3, 2.0)
+            self.assertGreater(bqm.get_version(), version)
+            self.assertEqual(bqm.quadratic[(3, 0)], 2.0)
+            self.assertEqual(len(bqm.quadratic), 4)
+            self.assertEqual(bqm.quadratic, bqm.get_quadratic())
+            bqm.add_variable(3, 1.5)
+            self.assertEqual(dict(bqm.linear), {0: 1, 1: -2, 3: 1.5})
+            bqm.change_vartype("BINARY")
+            self.assertEqual(bqm.linear, bqm.get_linear())
+            self.assertEqual(bqm.quadratic, bqm.get_quadratic())
+
+    def test_interaction_matrix_view(self):
+        for sparse, mat_type in [(True, csr_matrix), (False, np.ndarray)]:
+            bqm = cimod.model.BinaryQuadraticModel(
+                self.h, self.J, "SPIN", sparse=sparse
+            )
+            bqm.add_interaction(-1, 3, 2.0)
+            expected = bqm.interaction_matrix()
+            view = bqm.interaction_matrix_view()
+            self.assertIsInstance(view, mat_type)
+            if sparse:
+                self.assertFalse(view.data.flags.writeable)
+                np.testing.assert_array_equal(view.toarray(), expected.toarray())
+            else:
+                self.assertFalse(view.flags.writeable)
+                np.testing.assert_array_equal(view, expected)
+            self.assertEqual(bqm.get_id(-1), 0)
+
+            # a change of the model may reallocate the matrix, so the view refuses to be read
+            bqm.add_variable(100, 1.0)
+            with self.assertRaises(RuntimeError):
+                view.toarray() if sparse else view[0, 0]
+            view = bqm.interaction_matrix_view()
+            self.assertEqual(view.shape[0], len(bqm.variables) + 1)
+
+    def test_bqm_energies_array(self):
+        for sparse in [True, False]:
+            bqm = cimod.model.BinaryQuadraticModel(
+                self.h, self.J, "SPIN", sparse=sparse
+            )
+            samples = [[random.choice([-1, 1]) for _ in bqm.variables] for _ in range(5)]
+            expected = [
+                calculate_ising_energy(self.h, self.J, dict(zip(bqm.variables, s)))
+                for s in samples
+            ]
+            np.testing.assert_allclose(bqm.energies(samples), expected)
+            for dtype in [np.int8, np.int32, np.int64]:
+                energies = bqm.energies(np.array(samples, dtype=dtype))
+                self.assertEqual(type(energies), np.ndarray)
+                np.testing.assert_allclose(energies, expected)
+
     def test_serializable(self):
         for sparse, mat_type in [(True, csr_matrix), (False, np.ndarray)]:
             bqm = cimod.model.BinaryQuadraticModel(
@@ -1288,6 +1359,14 @@ class PolynomialModelTest(unittest.TestCase):
             calculate_bpm_energy(self.poly_tuple4, self.binaries_tuple4),
         )
 
+    def test_energies_array_bpm(self):
+        bpm = cimod.BinaryPolynomialModel(self.poly, cimod.SPIN)
+        row = [self.spins[v] for v in sorted(bpm.get_variables())]
+        expected = calculate_bpm_energy(self.poly, self.spins)
+        for dtype in [np.int8, np.int32]:
+            energies = bpm.energies(np.array([row, row], dtype=dtype))
+            np.testing.assert_allclose(energies, [expected, expected])
+
     def test_energies_bpm(self):
         # Spin
         spins_list = [self.spins, self.spins, self.spins, self.spins]